@@ -0,0 +1,69 @@
+#include <cstdlib>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+#include <oglplayground/animationsampler.h>
+
+using OglPlayground::AnimationSampler;
+using OglPlayground::SimdLevel;
+using OglPlayground::TransformHierarchy;
+
+namespace
+{
+
+const size_t nodeCount = 4096;
+const size_t keyCount = 32;
+
+// One position, rotation and scale track per node
+struct AnimatedScene
+{
+  AnimatedScene() {
+    srand(42);
+    auto random = [](float range) { return (float(rand()) / float(RAND_MAX) - 0.5f) * range; };
+    std::vector<float> times;
+    for(size_t k = 0; k < keyCount; ++k) times.push_back(float(k) / 30.f);
+    for(size_t i = 0; i < nodeCount; ++i) {
+      const auto node = hierarchy.create();
+      std::vector<glm::vec3> vectors;
+      std::vector<glm::quat> rotations;
+      for(size_t k = 0; k < keyCount; ++k) {
+        vectors.push_back(glm::vec3(random(10.f), random(10.f), random(10.f)));
+        rotations.push_back(glm::normalize(glm::quat(random(2.f), random(2.f), random(2.f), random(2.f))));
+      }
+      sampler.addPositionTrack(node, times.data(), vectors.data(), keyCount);
+      sampler.addRotationTrack(node, times.data(), rotations.data(), keyCount);
+      sampler.addScaleTrack(node, times.data(), vectors.data(), keyCount);
+    }
+  }
+
+  TransformHierarchy hierarchy;
+  AnimationSampler sampler;
+};
+
+AnimatedScene& scene_()
+{
+  static AnimatedScene scene;
+  return scene;
+}
+
+} // anonymous namespace
+
+// Playing forward at 60 fps, argument is the SimdLevel
+static void BM_AnimationSample(benchmark::State& state)
+{
+  AnimatedScene& s = scene_();
+  const SimdLevel level = SimdLevel(state.range(0));
+  if(OglPlayground::supportedSimdLevel(level) != level) {
+    state.SkipWithError("Simd level not supported");
+    return;
+  }
+  float time = 0.f;
+  for(auto _ : state) {
+    time += 1.f / 60.f;
+    if(time > s.sampler.duration()) time = 0.f;
+    s.sampler.sample(time, s.hierarchy, level);
+    benchmark::DoNotOptimize(s.hierarchy.localPositions());
+  }
+  state.SetItemsProcessed(state.iterations() * s.sampler.trackCount());
+}
+BENCHMARK(BM_AnimationSample)->Arg(int(SimdLevel::Scalar))->Arg(int(SimdLevel::SSE2))->Arg(int(SimdLevel::AVX2));
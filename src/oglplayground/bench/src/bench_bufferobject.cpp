@@ -0,0 +1,129 @@
+#include <cstring>
+#include <memory>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+#include <oglplayground/bufferobject.h>
+#include <oglplayground/ringbuffer.h>
+
+#include "glcontext.h"
+
+using OglPlayground::BufferMapping;
+using OglPlayground::BufferObject;
+using OglPlayground::RingBuffer;
+
+namespace
+{
+
+// Ways to refill the pixel unpack buffer every frame, as GameOfLifeBehavior does
+enum class Strategy_
+{
+  SubData, // BufferObject::upload, copies the data and may wait on the previous upload
+  Orphan, // glBufferData(nullptr) then map, the driver swaps in new storage
+  Invalidate, // Map with GL_MAP_INVALIDATE_BUFFER_BIT
+  Unsynchronized, // Map a region unsynchronized, fences protect regions in flight
+  Persistent // RingBuffer, mapped once
+};
+
+const GLsizei textureSize_ = 512;
+const size_t frameSize_ = textureSize_*textureSize_*4;
+const uint32_t regionCount_ = 3;
+
+void waitFence_(GLsync& fence)
+{
+  if(!fence) return;
+  while(glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000) == GL_TIMEOUT_EXPIRED) {}
+  glDeleteSync(fence);
+  fence = nullptr;
+}
+
+} // anonymous namespace
+
+// Argument is the Strategy_. One texture sized frame written then unpacked
+// to a texture per iteration.
+static void BM_PixelBufferStreaming(benchmark::State& state)
+{
+  if(!OglPlayground::makeHiddenGLContextCurrent()) {
+    state.SkipWithError("No opengl context");
+    return;
+  }
+  const Strategy_ strategy = Strategy_(state.range(0));
+  std::vector<uint8_t> frame(frameSize_, 128);
+
+  GLuint texture = 0;
+  glGenTextures(1, &texture);
+  glBindTexture(GL_TEXTURE_2D, texture);
+  glTexStorage2D(GL_TEXTURE_2D, 1, GL_RGBA8, textureSize_, textureSize_);
+
+  const size_t bufferSize = strategy == Strategy_::Unsynchronized ? frameSize_*regionCount_ : frameSize_;
+  std::unique_ptr<BufferObject> pbo;
+  std::unique_ptr<RingBuffer> ring;
+  if(strategy == Strategy_::Persistent) {
+    ring.reset(new RingBuffer(GL_PIXEL_UNPACK_BUFFER, frameSize_, regionCount_));
+  } else {
+    pbo.reset(new BufferObject(GL_PIXEL_UNPACK_BUFFER, bufferSize, nullptr, GL_STREAM_DRAW));
+  }
+  GLsync fences[regionCount_] = {};
+  uint32_t region = 0;
+
+  for(auto _ : state) {
+    size_t offset = 0;
+    switch(strategy) {
+    case Strategy_::SubData:
+      pbo->upload(0, frameSize_, frame.data());
+      break;
+    case Strategy_::Orphan: {
+      pbo->orphan();
+      BufferMapping mapping(*pbo, GL_MAP_WRITE_BIT);
+      std::memcpy(mapping.data(), frame.data(), frameSize_);
+      break;
+    }
+    case Strategy_::Invalidate: {
+      BufferMapping mapping(*pbo, GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT);
+      std::memcpy(mapping.data(), frame.data(), frameSize_);
+      break;
+    }
+    case Strategy_::Unsynchronized: {
+      region = (region+1) % regionCount_;
+      waitFence_(fences[region]);
+      offset = region*frameSize_;
+      BufferMapping mapping(
+          *pbo, offset, frameSize_,
+          GL_MAP_WRITE_BIT | GL_MAP_UNSYNCHRONIZED_BIT | GL_MAP_INVALIDATE_RANGE_BIT);
+      std::memcpy(mapping.data(), frame.data(), frameSize_);
+      break;
+    }
+    case Strategy_::Persistent:
+      ring->beginFrame();
+      std::memcpy(ring->allocate(frameSize_, 4, offset), frame.data(), frameSize_);
+      break;
+    }
+
+    if(ring) {
+      ring->bind();
+    } else {
+      pbo->bind();
+    }
+    glTexSubImage2D(
+        GL_TEXTURE_2D, 0, 0, 0, textureSize_, textureSize_,
+        GL_RGBA, GL_UNSIGNED_BYTE, reinterpret_cast<const void*>(offset));
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    if(strategy == Strategy_::Unsynchronized) {
+      fences[region] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    }
+    if(ring) ring->endFrame();
+    glFlush();
+  }
+  glFinish();
+  state.SetBytesProcessed(int64_t(state.iterations()) * frameSize_);
+
+  for(GLsync& fence : fences) {
+    if(fence) glDeleteSync(fence);
+  }
+  glBindTexture(GL_TEXTURE_2D, 0);
+  glDeleteTextures(1, &texture);
+}
+BENCHMARK(BM_PixelBufferStreaming)
+    ->DenseRange(int(Strategy_::SubData), int(Strategy_::Persistent))
+    ->Unit(benchmark::kMicrosecond)
+    ->UseRealTime();
@@ -0,0 +1,57 @@
+#include <benchmark/benchmark.h>
+#include <oglplayground/camera.h>
+
+#include "benchstatistics.h"
+
+using OglPlayground::CallTail;
+using OglPlayground::Camera;
+using OglPlayground::withStatistics;
+
+static void BM_CameraProjectionCached(benchmark::State& state)
+{
+  Camera camera;
+  CallTail tail(state);
+  for(auto _ : state) {
+    benchmark::DoNotOptimize(camera.projection());
+    tail.tick();
+  }
+}
+BENCHMARK(BM_CameraProjectionCached)->Apply(withStatistics);
+
+// Projection rebuilt on every call
+static void BM_CameraProjection(benchmark::State& state)
+{
+  Camera camera;
+  float fov = 45.f;
+  CallTail tail(state);
+  for(auto _ : state) {
+    fov = fov > 90.f ? 45.f : fov+1.f;
+    camera.setFov(fov);
+    benchmark::DoNotOptimize(camera.projection());
+    tail.tick();
+  }
+}
+BENCHMARK(BM_CameraProjection)->Apply(withStatistics);
+
+static void BM_CameraViewProjectionCached(benchmark::State& state)
+{
+  Camera camera;
+  CallTail tail(state);
+  for(auto _ : state) {
+    benchmark::DoNotOptimize(camera.viewProjection());
+    tail.tick();
+  }
+}
+BENCHMARK(BM_CameraViewProjectionCached)->Apply(withStatistics);
+
+// What each behavior did by hand every frame
+static void BM_CameraViewProjectionByHand(benchmark::State& state)
+{
+  Camera camera;
+  CallTail tail(state);
+  for(auto _ : state) {
+    benchmark::DoNotOptimize(glm::mat4(camera.projection() * camera.transform().worldToLocalMatrix()));
+    tail.tick();
+  }
+}
+BENCHMARK(BM_CameraViewProjectionByHand)->Apply(withStatistics);
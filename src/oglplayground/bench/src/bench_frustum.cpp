@@ -0,0 +1,89 @@
+#include <cmath>
+#include <cstdlib>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+#include <glm/gtc/matrix_transform.hpp>
+#include <oglplayground/frustum.h>
+
+using OglPlayground::SimdLevel;
+
+namespace
+{
+
+const size_t boxCount = 1000000;
+
+// Random boxes around a camera looking along +z, about a tenth are visible
+struct BoxSet
+{
+  BoxSet() {
+    srand(42);
+    auto random = [](float range) { return (float(rand()) / float(RAND_MAX) - 0.5f) * range; };
+    for(auto* v : {&cx, &cy, &cz, &ex, &ey, &ez}) v->resize(boxCount);
+    for(size_t i = 0; i < boxCount; ++i) {
+      cx[i] = random(400.f);
+      cy[i] = random(400.f);
+      cz[i] = random(400.f);
+      ex[i] = 0.5f + std::abs(random(4.f));
+      ey[i] = 0.5f + std::abs(random(4.f));
+      ez[i] = 0.5f + std::abs(random(4.f));
+    }
+    visible.resize(boxCount);
+    frustum = OglPlayground::frustumFromMatrix(glm::perspective(glm::radians(60.f), 16.f/9.f, 0.1f, 200.f));
+  }
+
+  std::vector<float> cx, cy, cz, ex, ey, ez;
+  std::vector<uint32_t> visible;
+  OglPlayground::Frustum frustum;
+};
+
+BoxSet& boxes_()
+{
+  static BoxSet boxes;
+  return boxes;
+}
+
+} // anonymous namespace
+
+// Argument is the SimdLevel
+static void BM_CullBoxes(benchmark::State& state)
+{
+  BoxSet& b = boxes_();
+  const SimdLevel level = SimdLevel(state.range(0));
+  if(OglPlayground::supportedSimdLevel(level) != level) {
+    state.SkipWithError("Simd level not supported");
+    return;
+  }
+  const OglPlayground::BoxArrays arrays = {b.cx.data(), b.cy.data(), b.cz.data(), b.ex.data(), b.ey.data(), b.ez.data()};
+  size_t visible = 0;
+  for(auto _ : state) {
+    visible = OglPlayground::cullBoxes(b.frustum, arrays, boxCount, b.visible.data(), level);
+    benchmark::DoNotOptimize(b.visible.data());
+  }
+  state.counters["visible"] = double(visible);
+  state.SetItemsProcessed(state.iterations() * boxCount);
+}
+BENCHMARK(BM_CullBoxes)
+  ->Unit(benchmark::kMicrosecond)
+  ->Arg(int(SimdLevel::Scalar))->Arg(int(SimdLevel::SSE2))->Arg(int(SimdLevel::AVX2));
+
+static void BM_CullSpheres(benchmark::State& state)
+{
+  BoxSet& b = boxes_();
+  const SimdLevel level = SimdLevel(state.range(0));
+  if(OglPlayground::supportedSimdLevel(level) != level) {
+    state.SkipWithError("Simd level not supported");
+    return;
+  }
+  const OglPlayground::SphereArrays arrays = {b.cx.data(), b.cy.data(), b.cz.data(), b.ex.data()};
+  size_t visible = 0;
+  for(auto _ : state) {
+    visible = OglPlayground::cullSpheres(b.frustum, arrays, boxCount, b.visible.data(), level);
+    benchmark::DoNotOptimize(b.visible.data());
+  }
+  state.counters["visible"] = double(visible);
+  state.SetItemsProcessed(state.iterations() * boxCount);
+}
+BENCHMARK(BM_CullSpheres)
+  ->Unit(benchmark::kMicrosecond)
+  ->Arg(int(SimdLevel::Scalar))->Arg(int(SimdLevel::SSE2))->Arg(int(SimdLevel::AVX2));
@@ -0,0 +1,55 @@
+#include <benchmark/benchmark.h>
+#include <oglplayground/directstateaccess.h>
+#include <oglplayground/geometry.h>
+
+#include "benchstatistics.h"
+#include "glcontext.h"
+
+using OglPlayground::AttributeUsage;
+using OglPlayground::CallTail;
+using OglPlayground::VertexDesc;
+using OglPlayground::withStatistics;
+
+static void BM_StrideFromVertexDesc(benchmark::State& state)
+{
+  const VertexDesc desc = {{AttributeUsage::Position, 3}, {AttributeUsage::UV0, 2}};
+  CallTail tail(state);
+  for(auto _ : state) {
+    benchmark::DoNotOptimize(OglPlayground::strideFromVertexDesc(desc));
+    tail.tick();
+  }
+}
+BENCHMARK(BM_StrideFromVertexDesc)->Apply(withStatistics);
+
+// Argument 1 uses direct state access, 0 the bind based path
+static void BM_GeometryCreate(benchmark::State& state)
+{
+  if(!OglPlayground::makeHiddenGLContextCurrent()) {
+    state.SkipWithError("No opengl context");
+    return;
+  }
+  const bool dsa = OglPlayground::directStateAccess();
+  OglPlayground::setDirectStateAccess(state.range(0) != 0);
+  if(OglPlayground::directStateAccess() != (state.range(0) != 0)) {
+    OglPlayground::setDirectStateAccess(dsa);
+    state.SkipWithError("No direct state access");
+    return;
+  }
+
+  const VertexDesc desc = {{AttributeUsage::Position, 3}, {AttributeUsage::UV0, 2}};
+  const float vertices[] = {
+    0.f, 0.f, 0.f, 0.f, 0.f,
+    1.f, 0.f, 0.f, 1.f, 0.f,
+    0.f, 1.f, 0.f, 0.f, 1.f,
+  };
+  const uint32_t indices[] = {0, 1, 2};
+  const OglPlayground::AttributeBindDesc bindDesc = {{AttributeUsage::Position, 0}, {AttributeUsage::UV0, 1}};
+  for(auto _ : state) {
+    OglPlayground::Geometry geometry(vertices, 3, indices, 3, desc);
+    OglPlayground::GeometryBinder binder(geometry, bindDesc);
+    benchmark::ClobberMemory();
+  }
+  glFinish();
+  OglPlayground::setDirectStateAccess(dsa);
+}
+BENCHMARK(BM_GeometryCreate)->DenseRange(0, 1)->Unit(benchmark::kMicrosecond);
@@ -0,0 +1,79 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <thread>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+#include <oglplayground/lightgrid.h>
+#include <oglplayground/threadpool.h>
+
+using OglPlayground::ClusterLight;
+
+namespace
+{
+
+const size_t lightCount = 4096;
+
+// Point and spot lights filling the view of a camera looking along +z
+struct LightScene
+{
+  LightScene() {
+    srand(42);
+    auto random = [](float range) { return (float(rand()) / float(RAND_MAX) - 0.5f) * range; };
+    lights.resize(lightCount);
+    for(size_t i = 0; i < lightCount; ++i) {
+      ClusterLight& light = lights[i];
+      light.position = glm::vec3(random(160.f), random(60.f), 100.f + random(200.f));
+      light.radius = 1.f + std::abs(random(10.f));
+      if(i % 4 == 0) {
+        light.direction = glm::normalize(glm::vec3(random(1.f), -1.f, random(1.f)));
+        light.spotAngle = glm::radians(30.f);
+      }
+    }
+    camera.setFov(glm::radians(60.f));
+    camera.setAspect(16.f/9.f);
+    camera.setClippingPlanes(0.1f, 200.f);
+  }
+
+  std::vector<ClusterLight> lights;
+  OglPlayground::Camera camera;
+};
+
+LightScene& scene_()
+{
+  static LightScene scene;
+  return scene;
+}
+
+} // anonymous namespace
+
+static void BM_LightGridBuild(benchmark::State& state)
+{
+  LightScene& s = scene_();
+  OglPlayground::LightGrid grid;
+  for(auto _ : state) {
+    grid.build(s.camera, s.lights.data(), lightCount);
+    benchmark::DoNotOptimize(grid.lightIndices().data());
+  }
+  state.counters["indices"] = double(grid.lightIndices().size());
+  state.SetItemsProcessed(state.iterations() * lightCount);
+}
+BENCHMARK(BM_LightGridBuild)->Unit(benchmark::kMicrosecond);
+
+// Argument is the pool size, from 1 to the number of cores
+static void BM_LightGridParallelBuild(benchmark::State& state)
+{
+  LightScene& s = scene_();
+  OglPlayground::ThreadPool pool(state.range(0));
+  OglPlayground::LightGrid grid;
+  for(auto _ : state) {
+    grid.build(pool, s.camera, s.lights.data(), lightCount);
+    benchmark::DoNotOptimize(grid.lightIndices().data());
+  }
+  state.SetItemsProcessed(state.iterations() * lightCount);
+}
+BENCHMARK(BM_LightGridParallelBuild)
+  ->Unit(benchmark::kMicrosecond)
+  ->UseRealTime()
+  ->DenseRange(1, std::max(1u, std::thread::hardware_concurrency()));
@@ -0,0 +1,91 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+#include <oglplayground/meshoptimizer.h>
+#include <oglplayground/threadpool.h>
+
+using OglPlayground::AttributeUsage;
+using OglPlayground::MeshData;
+
+namespace
+{
+
+// Sphere of position and uv vertices with shuffled triangles, 2*rings*segments triangles
+MeshData sphere_(uint32_t rings, uint32_t segments)
+{
+  MeshData mesh;
+  mesh.desc = {{AttributeUsage::Position, 3}, {AttributeUsage::UV0, 2}};
+  std::vector<float> vertices;
+  for(uint32_t r = 0; r <= rings; ++r) {
+    const float theta = 3.14159265f * float(r) / float(rings);
+    for(uint32_t s = 0; s <= segments; ++s) {
+      const float phi = 6.2831853f * float(s) / float(segments);
+      vertices.insert(
+          vertices.end(),
+          {std::sin(theta)*std::cos(phi), std::cos(theta), std::sin(theta)*std::sin(phi),
+           float(s) / float(segments), float(r) / float(rings)});
+    }
+  }
+  mesh.vertices.resize(vertices.size()*sizeof(float));
+  std::memcpy(mesh.vertices.data(), vertices.data(), mesh.vertices.size());
+
+  srand(42);
+  std::vector<uint32_t> triangles;
+  for(uint32_t r = 0; r < rings; ++r) {
+    for(uint32_t s = 0; s < segments; ++s) {
+      const uint32_t a = r*(segments+1) + s;
+      const uint32_t b = a + segments+1;
+      triangles.insert(triangles.end(), {a, a+1, b, a+1, b+1, b});
+    }
+  }
+  for(size_t i = triangles.size()/3-1; i > 0; --i) {
+    const size_t j = size_t(rand()) % (i+1);
+    for(size_t k = 0; k < 3; ++k) std::swap(triangles[i*3+k], triangles[j*3+k]);
+  }
+  mesh.indices = std::move(triangles);
+  return mesh;
+}
+
+} // anonymous namespace
+
+// 131k triangles
+static void BM_OptimizeVertexCache(benchmark::State& state)
+{
+  const MeshData mesh = sphere_(256, 256);
+  std::vector<uint32_t> optimized(mesh.indices.size());
+  for(auto _ : state) {
+    OglPlayground::optimizeVertexCache(
+        optimized.data(), mesh.indices.data(), mesh.indices.size(), mesh.verticesCount());
+    benchmark::DoNotOptimize(optimized.data());
+  }
+  state.counters["acmr"] = OglPlayground::analyzeVertexCache(
+      optimized.data(), optimized.size(), mesh.verticesCount()).acmr;
+  state.SetItemsProcessed(state.iterations() * mesh.indices.size()/3);
+}
+BENCHMARK(BM_OptimizeVertexCache)->Unit(benchmark::kMillisecond);
+
+// Whole pipeline on 64 meshes of 8k triangles, argument is the pool size
+static void BM_OptimizeMeshes(benchmark::State& state)
+{
+  const std::vector<MeshData> meshes(64, sphere_(64, 64));
+  OglPlayground::ThreadPool pool(state.range(0));
+  OglPlayground::MeshOptimizeStats stats;
+  for(auto _ : state) {
+    state.PauseTiming();
+    std::vector<MeshData> copy = meshes;
+    state.ResumeTiming();
+    stats = OglPlayground::optimizeMeshes(pool, copy).front();
+  }
+  state.counters["acmrBefore"] = stats.before.acmr;
+  state.counters["acmrAfter"] = stats.after.acmr;
+  state.SetItemsProcessed(state.iterations() * meshes.size());
+}
+BENCHMARK(BM_OptimizeMeshes)
+  ->Unit(benchmark::kMillisecond)
+  ->UseRealTime()
+  ->DenseRange(1, std::max(1u, std::thread::hardware_concurrency()));
@@ -0,0 +1,127 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <thread>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+#include <glm/gtc/matrix_transform.hpp>
+#include <oglplayground/frustum.h>
+#include <oglplayground/occlusionculler.h>
+#include <oglplayground/threadpool.h>
+
+using OglPlayground::SimdLevel;
+
+namespace
+{
+
+const size_t occluderCount = 64;
+const size_t boxCount = 100000;
+
+// Walls scattered in front of a camera looking along +z, and boxes behind them
+struct OcclusionScene
+{
+  OcclusionScene() {
+    srand(42);
+    auto random = [](float range) { return (float(rand()) / float(RAND_MAX) - 0.5f) * range; };
+    const float vertices[] = {
+      -1.f, -1.f, 0.f,
+      1.f, -1.f, 0.f,
+      1.f, 1.f, 0.f,
+      -1.f, 1.f, 0.f};
+    const uint32_t indices[] = {0, 1, 2, 0, 2, 3};
+    const OglPlayground::VertexDesc desc = {{OglPlayground::AttributeUsage::Position, 3}};
+    wall = OglPlayground::occluderFromVertices(vertices, 4, indices, 6, desc);
+    for(size_t i = 0; i < occluderCount; ++i) {
+      const glm::vec3 position(random(80.f), random(30.f), 20.f + std::abs(random(60.f)));
+      models.push_back(glm::scale(glm::translate(glm::mat4(1.f), position), glm::vec3(4.f, 3.f, 1.f)));
+    }
+
+    for(auto* v : {&cx, &cy, &cz, &ex, &ey, &ez}) v->resize(boxCount);
+    for(size_t i = 0; i < boxCount; ++i) {
+      cx[i] = random(100.f);
+      cy[i] = random(40.f);
+      cz[i] = 5.f + std::abs(random(180.f));
+      ex[i] = ey[i] = ez[i] = 0.5f + std::abs(random(2.f));
+      allIndices.push_back(uint32_t(i));
+    }
+    visible.resize(boxCount);
+    viewProjection = glm::perspective(glm::radians(60.f), 2.f, 0.1f, 200.f);
+  }
+
+  void addOccluders(OglPlayground::OcclusionCuller& culler) const {
+    culler.begin(viewProjection);
+    for(const auto& model : models) culler.addOccluder(wall, model);
+  }
+
+  OglPlayground::OccluderMesh wall;
+  std::vector<glm::mat4> models;
+  std::vector<float> cx, cy, cz, ex, ey, ez;
+  std::vector<uint32_t> allIndices;
+  std::vector<uint32_t> visible;
+  glm::mat4 viewProjection;
+};
+
+OcclusionScene& scene_()
+{
+  static OcclusionScene scene;
+  return scene;
+}
+
+} // anonymous namespace
+
+// Argument is the SimdLevel
+static void BM_OcclusionRasterize(benchmark::State& state)
+{
+  OcclusionScene& s = scene_();
+  const SimdLevel level = SimdLevel(state.range(0));
+  if(OglPlayground::supportedSimdLevel(level) != level) {
+    state.SkipWithError("Simd level not supported");
+    return;
+  }
+  OglPlayground::OcclusionCuller culler;
+  for(auto _ : state) {
+    s.addOccluders(culler);
+    culler.rasterize(level);
+    benchmark::DoNotOptimize(culler.depth(0, 0));
+  }
+  state.SetItemsProcessed(state.iterations() * occluderCount);
+}
+BENCHMARK(BM_OcclusionRasterize)
+  ->Unit(benchmark::kMicrosecond)
+  ->Arg(int(SimdLevel::Scalar))->Arg(int(SimdLevel::SSE2))->Arg(int(SimdLevel::AVX2));
+
+// Argument is the pool size, from 1 to the number of cores
+static void BM_OcclusionParallelRasterize(benchmark::State& state)
+{
+  OcclusionScene& s = scene_();
+  OglPlayground::ThreadPool pool(state.range(0));
+  OglPlayground::OcclusionCuller culler;
+  for(auto _ : state) {
+    s.addOccluders(culler);
+    culler.rasterize(pool);
+    benchmark::DoNotOptimize(culler.depth(0, 0));
+  }
+  state.SetItemsProcessed(state.iterations() * occluderCount);
+}
+BENCHMARK(BM_OcclusionParallelRasterize)
+  ->Unit(benchmark::kMicrosecond)
+  ->UseRealTime()
+  ->DenseRange(1, std::max(1u, std::thread::hardware_concurrency()));
+
+static void BM_OcclusionTestBoxes(benchmark::State& state)
+{
+  OcclusionScene& s = scene_();
+  OglPlayground::OcclusionCuller culler;
+  s.addOccluders(culler);
+  culler.rasterize();
+  const OglPlayground::BoxArrays arrays = {s.cx.data(), s.cy.data(), s.cz.data(), s.ex.data(), s.ey.data(), s.ez.data()};
+  size_t visible = 0;
+  for(auto _ : state) {
+    visible = culler.testBoxes(arrays, s.allIndices.data(), boxCount, s.visible.data());
+    benchmark::DoNotOptimize(s.visible.data());
+  }
+  state.counters["visible"] = double(visible);
+  state.SetItemsProcessed(state.iterations() * boxCount);
+}
+BENCHMARK(BM_OcclusionTestBoxes)->Unit(benchmark::kMicrosecond);
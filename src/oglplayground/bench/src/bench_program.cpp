@@ -0,0 +1,64 @@
+#include <string>
+
+#include <benchmark/benchmark.h>
+#include <oglplayground/program.h>
+
+#include "benchstatistics.h"
+#include "glcontext.h"
+
+using OglPlayground::CallTail;
+using OglPlayground::Program;
+using OglPlayground::withStatistics;
+
+namespace
+{
+
+// Enough active uniforms for the sorted lookup to take a few steps
+const char* vsSource_ = R"(
+#version 440
+uniform mat4 transform;
+uniform mat4 model;
+uniform mat4 view;
+uniform vec4 tint;
+uniform float time;
+uniform float scale;
+in vec3 position;
+void main() {
+  gl_Position = transform * model * view * vec4(position * scale + time, 1.0) + tint;
+}
+)";
+
+const char* psSource_ = R"(
+#version 440
+uniform vec4 color;
+uniform float alpha;
+out vec4 fragColor;
+void main() {
+  fragColor = vec4(color.rgb, alpha);
+}
+)";
+
+} // anonymous namespace
+
+// Argument selects the uniform looked up, the last one does not exist
+static void BM_ProgramDesc(benchmark::State& state)
+{
+  if(!OglPlayground::makeHiddenGLContextCurrent()) {
+    state.SkipWithError("No opengl context");
+    return;
+  }
+  Program program(vsSource_, psSource_);
+  if(!program.isValid()) {
+    state.SkipWithError("Program failed to build");
+    return;
+  }
+
+  const char* names[] = {"alpha", "time", "view", "missing"};
+  const char* name = names[state.range(0)];
+  CallTail tail(state);
+  for(auto _ : state) {
+    benchmark::DoNotOptimize(program.desc(name));
+    tail.tick();
+  }
+}
+BENCHMARK(BM_ProgramDesc)->DenseRange(0, 3)->Apply(withStatistics);
@@ -0,0 +1,146 @@
+#include <cmath>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+#include <oglplayground/shadowcascades.h>
+
+using OglPlayground::SimdLevel;
+
+namespace
+{
+
+const size_t casterCount = 1000000;
+
+// Random casters around a camera looking along +z, 4 cascades up to 200
+struct CasterSet
+{
+  CasterSet() {
+    srand(42);
+    auto random = [](float range) { return (float(rand()) / float(RAND_MAX) - 0.5f) * range; };
+    for(auto* v : {&cx, &cy, &cz, &ex, &ey, &ez}) v->resize(casterCount);
+    for(size_t i = 0; i < casterCount; ++i) {
+      cx[i] = random(800.f);
+      cy[i] = random(40.f);
+      cz[i] = random(800.f);
+      ex[i] = 0.5f + std::abs(random(4.f));
+      ey[i] = 0.5f + std::abs(random(4.f));
+      ez[i] = 0.5f + std::abs(random(4.f));
+    }
+    casters.resize(casterCount);
+    masks.resize(casterCount);
+
+    OglPlayground::Camera camera;
+    camera.setFov(glm::radians(60.f));
+    camera.setAspect(16.f/9.f);
+    camera.setClippingPlanes(0.1f, 1000.f);
+    cascades.setShadowDistance(200.f);
+    cascades.update(camera, glm::vec3(0.3f, -1.f, 0.5f));
+  }
+
+  OglPlayground::BoxArrays arrays() const { return {cx.data(), cy.data(), cz.data(), ex.data(), ey.data(), ez.data()}; }
+
+  std::vector<float> cx, cy, cz, ex, ey, ez;
+  std::vector<uint32_t> casters;
+  std::vector<uint8_t> masks;
+  OglPlayground::ShadowCascades cascades;
+};
+
+CasterSet& casters_()
+{
+  static CasterSet casters;
+  return casters;
+}
+
+} // anonymous namespace
+
+static void BM_ShadowCascadesUpdate(benchmark::State& state)
+{
+  OglPlayground::Camera camera;
+  camera.setClippingPlanes(0.1f, 1000.f);
+  OglPlayground::ShadowCascades cascades;
+  for(auto _ : state) {
+    camera.transform().translate(glm::vec3(0.01f, 0.f, 0.f), OglPlayground::Space::World);
+    cascades.update(camera, glm::vec3(0.3f, -1.f, 0.5f));
+    benchmark::DoNotOptimize(cascades.cascade(3));
+  }
+}
+BENCHMARK(BM_ShadowCascadesUpdate);
+
+// All cascades in one pass, argument is the SimdLevel. Counters give the
+// casters drawn in each cascade.
+static void BM_CullCastersBatched(benchmark::State& state)
+{
+  CasterSet& c = casters_();
+  const SimdLevel level = SimdLevel(state.range(0));
+  if(OglPlayground::supportedSimdLevel(level) != level) {
+    state.SkipWithError("Simd level not supported");
+    return;
+  }
+  size_t count = 0;
+  for(auto _ : state) {
+    count = c.cascades.cullCasters(c.arrays(), casterCount, c.casters.data(), c.masks.data(), level);
+    benchmark::DoNotOptimize(c.masks.data());
+  }
+  size_t perCascade[OglPlayground::ShadowCascades::maxCascades] = {};
+  for(size_t i = 0; i < count; ++i) {
+    for(uint32_t k = 0; k < c.cascades.count(); ++k) perCascade[k] += (c.masks[i] >> k) & 1;
+  }
+  for(uint32_t k = 0; k < c.cascades.count(); ++k) {
+    state.counters["cascade" + std::to_string(k)] = double(perCascade[k]);
+  }
+  state.counters["casters"] = double(count);
+  state.SetItemsProcessed(state.iterations() * casterCount);
+}
+BENCHMARK(BM_CullCastersBatched)
+  ->Unit(benchmark::kMicrosecond)
+  ->Arg(int(SimdLevel::Scalar))->Arg(int(SimdLevel::SSE2))->Arg(int(SimdLevel::AVX2));
+
+// Same pass with the frustum planes of every cascade
+static void BM_CullCastersPlanes(benchmark::State& state)
+{
+  CasterSet& c = casters_();
+  const SimdLevel level = SimdLevel(state.range(0));
+  if(OglPlayground::supportedSimdLevel(level) != level) {
+    state.SkipWithError("Simd level not supported");
+    return;
+  }
+  std::vector<OglPlayground::Frustum> frustums;
+  for(uint32_t k = 0; k < c.cascades.count(); ++k) frustums.push_back(c.cascades.frustum(k));
+  size_t count = 0;
+  for(auto _ : state) {
+    count = OglPlayground::cullBoxesMulti(
+        frustums.data(), frustums.size(), c.arrays(), casterCount, c.casters.data(), c.masks.data(), level);
+    benchmark::DoNotOptimize(c.masks.data());
+  }
+  state.counters["casters"] = double(count);
+  state.SetItemsProcessed(state.iterations() * casterCount);
+}
+BENCHMARK(BM_CullCastersPlanes)
+  ->Unit(benchmark::kMicrosecond)
+  ->Arg(int(SimdLevel::Scalar))->Arg(int(SimdLevel::SSE2))->Arg(int(SimdLevel::AVX2));
+
+// Baseline, one cullBoxes call per cascade
+static void BM_CullCastersPerCascade(benchmark::State& state)
+{
+  CasterSet& c = casters_();
+  const SimdLevel level = SimdLevel(state.range(0));
+  if(OglPlayground::supportedSimdLevel(level) != level) {
+    state.SkipWithError("Simd level not supported");
+    return;
+  }
+  size_t draws = 0;
+  for(auto _ : state) {
+    draws = 0;
+    for(uint32_t k = 0; k < c.cascades.count(); ++k) {
+      draws += OglPlayground::cullBoxes(c.cascades.frustum(k), c.arrays(), casterCount, c.casters.data(), level);
+      benchmark::DoNotOptimize(c.casters.data());
+    }
+  }
+  state.counters["draws"] = double(draws);
+  state.SetItemsProcessed(state.iterations() * casterCount);
+}
+BENCHMARK(BM_CullCastersPerCascade)
+  ->Unit(benchmark::kMicrosecond)
+  ->Arg(int(SimdLevel::Scalar))->Arg(int(SimdLevel::SSE2))->Arg(int(SimdLevel::AVX2));
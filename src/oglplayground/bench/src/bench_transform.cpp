@@ -0,0 +1,242 @@
+#include <cstdlib>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+#include <glm/gtc/matrix_inverse.hpp>
+#include <oglplayground/transform.h>
+
+#include "benchstatistics.h"
+
+using OglPlayground::CallTail;
+using OglPlayground::SimdLevel;
+using OglPlayground::Space;
+using OglPlayground::Transform;
+using OglPlayground::withStatistics;
+
+namespace
+{
+
+const size_t batchSize = 4096;
+
+struct TRSBatch
+{
+  TRSBatch() {
+    srand(42);
+    auto random = [](float range) { return (float(rand()) / float(RAND_MAX) - 0.5f) * range; };
+    for(size_t i = 0; i < batchSize; ++i) {
+      positions.push_back(glm::vec3(random(100.f), random(100.f), random(100.f)));
+      rotations.push_back(glm::normalize(glm::quat(random(2.f), random(2.f), random(2.f), random(2.f))));
+      scales.push_back(glm::vec3(1.f) + glm::abs(glm::vec3(random(4.f), random(4.f), random(4.f))));
+      matrices.push_back(OglPlayground::matrixFromTRS(positions.back(), rotations.back(), scales.back()));
+    }
+    results.resize(batchSize);
+  }
+
+  std::vector<glm::vec3> positions;
+  std::vector<glm::quat> rotations;
+  std::vector<glm::vec3> scales;
+  std::vector<glm::mat4> matrices;
+  std::vector<glm::mat4> results;
+};
+
+TRSBatch& batch_()
+{
+  static TRSBatch batch;
+  return batch;
+}
+
+Transform transform_()
+{
+  Transform transform;
+  transform.translate(glm::vec3(1.f, 2.f, 3.f), Space::World);
+  transform.rotate(glm::vec3(10.f, 20.f, 30.f), Space::Local);
+  transform.scale(glm::vec3(2.f, 1.f, 0.5f));
+  return transform;
+}
+
+} // anonymous namespace
+
+// Inverse of an already built TRS matrix with the general glm inverse
+static void BM_InverseGlm(benchmark::State& state)
+{
+  TRSBatch& b = batch_();
+  for(auto _ : state) {
+    for(size_t i = 0; i < batchSize; ++i) b.results[i] = glm::inverse(b.matrices[i]);
+    benchmark::DoNotOptimize(b.results.data());
+  }
+  state.SetItemsProcessed(state.iterations() * batchSize);
+}
+BENCHMARK(BM_InverseGlm);
+
+static void BM_InverseGlmAffine(benchmark::State& state)
+{
+  TRSBatch& b = batch_();
+  for(auto _ : state) {
+    for(size_t i = 0; i < batchSize; ++i) b.results[i] = glm::affineInverse(b.matrices[i]);
+    benchmark::DoNotOptimize(b.results.data());
+  }
+  state.SetItemsProcessed(state.iterations() * batchSize);
+}
+BENCHMARK(BM_InverseGlmAffine);
+
+// What worldToLocalMatrix() used to cost: build the matrix then invert it
+static void BM_InverseGlmFromTRS(benchmark::State& state)
+{
+  TRSBatch& b = batch_();
+  for(auto _ : state) {
+    for(size_t i = 0; i < batchSize; ++i) {
+      b.results[i] = glm::inverse(OglPlayground::matrixFromTRS(b.positions[i], b.rotations[i], b.scales[i]));
+    }
+    benchmark::DoNotOptimize(b.results.data());
+  }
+  state.SetItemsProcessed(state.iterations() * batchSize);
+}
+BENCHMARK(BM_InverseGlmFromTRS);
+
+static void BM_InverseMatrixFromTRS(benchmark::State& state)
+{
+  TRSBatch& b = batch_();
+  for(auto _ : state) {
+    for(size_t i = 0; i < batchSize; ++i) {
+      b.results[i] = OglPlayground::inverseMatrixFromTRS(b.positions[i], b.rotations[i], b.scales[i]);
+    }
+    benchmark::DoNotOptimize(b.results.data());
+  }
+  state.SetItemsProcessed(state.iterations() * batchSize);
+}
+BENCHMARK(BM_InverseMatrixFromTRS);
+
+// Argument is the SimdLevel
+static void BM_ComposeInverseMatrices(benchmark::State& state)
+{
+  TRSBatch& b = batch_();
+  const SimdLevel level = SimdLevel(state.range(0));
+  if(OglPlayground::supportedSimdLevel(level) != level) {
+    state.SkipWithError("Simd level not supported");
+    return;
+  }
+  for(auto _ : state) {
+    OglPlayground::composeInverseMatrices(
+        b.positions.data(), b.rotations.data(), b.scales.data(), b.results.data(), batchSize, level);
+    benchmark::DoNotOptimize(b.results.data());
+  }
+  state.SetItemsProcessed(state.iterations() * batchSize);
+}
+BENCHMARK(BM_ComposeInverseMatrices)->Arg(int(SimdLevel::Scalar))->Arg(int(SimdLevel::SSE2))->Arg(int(SimdLevel::AVX2));
+
+static void BM_ComposeMatrices(benchmark::State& state)
+{
+  TRSBatch& b = batch_();
+  const SimdLevel level = SimdLevel(state.range(0));
+  if(OglPlayground::supportedSimdLevel(level) != level) {
+    state.SkipWithError("Simd level not supported");
+    return;
+  }
+  for(auto _ : state) {
+    OglPlayground::composeMatrices(
+        b.positions.data(), b.rotations.data(), b.scales.data(), b.results.data(), batchSize, level);
+    benchmark::DoNotOptimize(b.results.data());
+  }
+  state.SetItemsProcessed(state.iterations() * batchSize);
+}
+BENCHMARK(BM_ComposeMatrices)->Arg(int(SimdLevel::Scalar))->Arg(int(SimdLevel::SSE2))->Arg(int(SimdLevel::AVX2));
+
+// Single calls on a detached Transform, the cached variants read the matrix
+// computed on the previous call, the others invalidate it first
+
+static void BM_TransformLocalToWorldCached(benchmark::State& state)
+{
+  Transform transform = transform_();
+  CallTail tail(state);
+  for(auto _ : state) {
+    benchmark::DoNotOptimize(transform.localToWorldMatrix());
+    tail.tick();
+  }
+}
+BENCHMARK(BM_TransformLocalToWorldCached)->Apply(withStatistics);
+
+static void BM_TransformLocalToWorld(benchmark::State& state)
+{
+  Transform transform = transform_();
+  glm::vec3 position(0.f);
+  CallTail tail(state);
+  for(auto _ : state) {
+    position.x += 1.f;
+    transform.setLocalPosition(position);
+    benchmark::DoNotOptimize(transform.localToWorldMatrix());
+    tail.tick();
+  }
+}
+BENCHMARK(BM_TransformLocalToWorld)->Apply(withStatistics);
+
+static void BM_TransformWorldToLocalCached(benchmark::State& state)
+{
+  Transform transform = transform_();
+  CallTail tail(state);
+  for(auto _ : state) {
+    benchmark::DoNotOptimize(transform.worldToLocalMatrix());
+    tail.tick();
+  }
+}
+BENCHMARK(BM_TransformWorldToLocalCached)->Apply(withStatistics);
+
+static void BM_TransformWorldToLocal(benchmark::State& state)
+{
+  Transform transform = transform_();
+  glm::vec3 position(0.f);
+  CallTail tail(state);
+  for(auto _ : state) {
+    position.x += 1.f;
+    transform.setLocalPosition(position);
+    benchmark::DoNotOptimize(transform.worldToLocalMatrix());
+    tail.tick();
+  }
+}
+BENCHMARK(BM_TransformWorldToLocal)->Apply(withStatistics);
+
+static void BM_TransformLookAt(benchmark::State& state)
+{
+  Transform transform = transform_();
+  glm::vec3 target(10.f, 5.f, 0.f);
+  CallTail tail(state);
+  for(auto _ : state) {
+    target.z += 1.f;
+    transform.lookAt(target, Transform::worldUp);
+    benchmark::DoNotOptimize(transform.localRotation());
+    tail.tick();
+  }
+}
+BENCHMARK(BM_TransformLookAt)->Apply(withStatistics);
+
+static void BM_TransformForward(benchmark::State& state)
+{
+  Transform transform = transform_();
+  CallTail tail(state);
+  for(auto _ : state) {
+    benchmark::DoNotOptimize(transform.forward());
+    tail.tick();
+  }
+}
+BENCHMARK(BM_TransformForward)->Apply(withStatistics);
+
+static void BM_TransformUp(benchmark::State& state)
+{
+  Transform transform = transform_();
+  CallTail tail(state);
+  for(auto _ : state) {
+    benchmark::DoNotOptimize(transform.up());
+    tail.tick();
+  }
+}
+BENCHMARK(BM_TransformUp)->Apply(withStatistics);
+
+static void BM_TransformRight(benchmark::State& state)
+{
+  Transform transform = transform_();
+  CallTail tail(state);
+  for(auto _ : state) {
+    benchmark::DoNotOptimize(transform.right());
+    tail.tick();
+  }
+}
+BENCHMARK(BM_TransformRight)->Apply(withStatistics);
@@ -0,0 +1,98 @@
+#include <algorithm>
+#include <cstdlib>
+#include <thread>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+#include <oglplayground/threadpool.h>
+#include <oglplayground/transformhierarchy.h>
+
+using OglPlayground::TransformHierarchy;
+
+namespace
+{
+
+const size_t hierarchySize = 1 << 18;
+const size_t rootCount = 64;
+
+// Forest of rootCount trees with random parents, about a dozen levels deep
+struct Scene
+{
+  Scene() {
+    srand(42);
+    hierarchy.reserve(hierarchySize);
+    for(size_t i = 0; i < hierarchySize; ++i) {
+      const auto parent = i < rootCount ? TransformHierarchy::invalidNode : nodes[i/2 + rand() % (i/2)];
+      nodes.push_back(hierarchy.create(parent));
+      hierarchy.setLocalPosition(nodes.back(), glm::vec3(float(rand() % 10), 0.f, float(rand() % 10)));
+    }
+  }
+
+  // Moving every root makes the whole forest outdated
+  void moveRoots() {
+    for(size_t i = 0; i < rootCount; ++i) {
+      hierarchy.setLocalPosition(nodes[i], hierarchy.localPosition(nodes[i]) + glm::vec3(0.f, 1.f, 0.f));
+    }
+  }
+
+  TransformHierarchy hierarchy;
+  std::vector<TransformHierarchy::NodeId> nodes;
+};
+
+Scene& scene_()
+{
+  static Scene scene;
+  return scene;
+}
+
+} // anonymous namespace
+
+static void BM_HierarchyUpdate(benchmark::State& state)
+{
+  Scene& s = scene_();
+  for(auto _ : state) {
+    s.moveRoots();
+    s.hierarchy.update();
+    benchmark::DoNotOptimize(s.hierarchy.worldMatrices());
+  }
+  state.SetItemsProcessed(state.iterations() * hierarchySize);
+}
+BENCHMARK(BM_HierarchyUpdate)->Unit(benchmark::kMicrosecond);
+
+// Argument is the pool size, from 1 to the number of cores
+static void BM_HierarchyParallelUpdate(benchmark::State& state)
+{
+  Scene& s = scene_();
+  OglPlayground::ThreadPool pool(state.range(0));
+  for(auto _ : state) {
+    s.moveRoots();
+    s.hierarchy.update(pool);
+    benchmark::DoNotOptimize(s.hierarchy.worldMatrices());
+  }
+  state.SetItemsProcessed(state.iterations() * hierarchySize);
+}
+BENCHMARK(BM_HierarchyParallelUpdate)
+  ->Unit(benchmark::kMicrosecond)
+  ->UseRealTime()
+  ->DenseRange(1, std::max(1u, std::thread::hardware_concurrency()));
+
+// Frame where 5% of the nodes move, with their descendants. Measures update
+// plus the range collection an incremental upload starts with, argument is
+// the gap merged between ranges.
+static void BM_HierarchyChangedRanges(benchmark::State& state)
+{
+  Scene& s = scene_();
+  std::vector<OglPlayground::IndexRange> ranges;
+  const uint32_t maxGap = uint32_t(state.range(0));
+  for(auto _ : state) {
+    for(size_t i = hierarchySize/2; i < hierarchySize; i += 10) {
+      s.hierarchy.setLocalScale(s.nodes[i], s.hierarchy.localScale(s.nodes[i]));
+    }
+    s.hierarchy.update();
+    s.hierarchy.changedRanges(ranges, maxGap);
+    benchmark::DoNotOptimize(ranges.data());
+  }
+  state.counters["ranges"] = double(ranges.size());
+  state.SetItemsProcessed(state.iterations() * hierarchySize);
+}
+BENCHMARK(BM_HierarchyChangedRanges)->Unit(benchmark::kMicrosecond)->Arg(0)->Arg(16);
@@ -0,0 +1,65 @@
+#include <cstdlib>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+#include <oglplayground/vertexformat.h>
+
+using OglPlayground::SimdLevel;
+
+namespace
+{
+
+// A million vertices worth of normals
+const size_t valueCount = 3000000;
+
+const std::vector<float>& values_()
+{
+  static std::vector<float> values = [] {
+    srand(42);
+    std::vector<float> v(valueCount);
+    for(float& f : v) f = (float(rand()) / float(RAND_MAX) - 0.5f) * 2.2f;
+    return v;
+  }();
+  return values;
+}
+
+} // anonymous namespace
+
+// Argument is the SimdLevel
+static void BM_PackHalf(benchmark::State& state)
+{
+  const SimdLevel level = SimdLevel(state.range(0));
+  if(OglPlayground::supportedSimdLevel(level) != level) {
+    state.SkipWithError("Simd level not supported");
+    return;
+  }
+  const std::vector<float>& values = values_();
+  std::vector<uint16_t> packed(valueCount);
+  for(auto _ : state) {
+    OglPlayground::packHalf(values.data(), packed.data(), valueCount, level);
+    benchmark::DoNotOptimize(packed.data());
+  }
+  state.SetItemsProcessed(state.iterations() * valueCount);
+}
+BENCHMARK(BM_PackHalf)
+  ->Unit(benchmark::kMicrosecond)
+  ->Arg(int(SimdLevel::Scalar))->Arg(int(SimdLevel::SSE2))->Arg(int(SimdLevel::AVX2));
+
+static void BM_PackSnorm8(benchmark::State& state)
+{
+  const SimdLevel level = SimdLevel(state.range(0));
+  if(OglPlayground::supportedSimdLevel(level) != level) {
+    state.SkipWithError("Simd level not supported");
+    return;
+  }
+  const std::vector<float>& values = values_();
+  std::vector<int8_t> packed(valueCount);
+  for(auto _ : state) {
+    OglPlayground::packSnorm8(values.data(), packed.data(), valueCount, level);
+    benchmark::DoNotOptimize(packed.data());
+  }
+  state.SetItemsProcessed(state.iterations() * valueCount);
+}
+BENCHMARK(BM_PackSnorm8)
+  ->Unit(benchmark::kMicrosecond)
+  ->Arg(int(SimdLevel::Scalar))->Arg(int(SimdLevel::SSE2))->Arg(int(SimdLevel::AVX2));
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+namespace OglPlayground
+{
+
+//! Tail latency of a single call benchmark. A clock read every batchSize
+//! calls times batches, so the clock barely shows in the mean, and the 99th
+//! percentile of the batch means in ns per call is reported as the p99
+//! counter. Call tick() once per iteration.
+class CallTail
+{
+public:
+  explicit CallTail(benchmark::State& state, size_t batchSize = 64)
+      : state_(state)
+      , batchSize_(batchSize)
+  {
+    // No reallocation inside the timed loop
+    batches_.reserve(size_t(state.max_iterations) / batchSize + 1);
+  }
+
+  ~CallTail()
+  {
+    if(batches_.empty()) return;
+    const auto p99 = batches_.begin() + (batches_.size()-1) * 99 / 100;
+    std::nth_element(batches_.begin(), p99, batches_.end());
+    state_.counters["p99"] = *p99;
+  }
+
+  void tick()
+  {
+    // The first call only starts the clock, the loop setup is not a call
+    if(!started_) {
+      started_ = true;
+      start_ = Clock::now();
+      return;
+    }
+    if(++calls_ < batchSize_) return;
+    const Clock::time_point now = Clock::now();
+    batches_.push_back(std::chrono::duration<double, std::nano>(now - start_).count() / double(batchSize_));
+    start_ = now;
+    calls_ = 0;
+  }
+
+private:
+  typedef std::chrono::steady_clock Clock;
+
+  benchmark::State& state_;
+  size_t batchSize_;
+  size_t calls_ = 0;
+  bool started_ = false;
+  Clock::time_point start_;
+  std::vector<double> batches_;
+};
+
+//! Run a benchmark several times and only report mean, median and stddev
+//! over the repetitions, in ns per operation. Use with Benchmark::Apply, and
+//! a CallTail in the benchmark for the p99.
+inline void withStatistics(benchmark::internal::Benchmark* b)
+{
+  b->Unit(benchmark::kNanosecond)
+      ->Repetitions(20)
+      ->ReportAggregatesOnly(true);
+}
+
+} // namespace OglPlayground
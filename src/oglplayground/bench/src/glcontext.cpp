@@ -0,0 +1,69 @@
+#include "glcontext.h"
+
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+#include <oglplayground/directstateaccess.h>
+
+namespace OglPlayground
+{
+namespace
+{
+
+struct HiddenWindow_
+{
+  HiddenWindow_() {
+    if(!glfwInit()) return;
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 4);
+    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+    glfwWindowHint(GLFW_VISIBLE, GL_FALSE);
+    window = glfwCreateWindow(16, 16, "OglPlayground", NULL, NULL);
+    if(!window) return;
+    glfwMakeContextCurrent(window);
+    valid = gladLoadGLLoader((GLADloadproc) glfwGetProcAddress) != 0;
+    if(valid) loadDirectStateAccess((GLADloadproc) glfwGetProcAddress);
+    // Windows are created on the main thread only, the shared one too
+    if(valid) shared = glfwCreateWindow(16, 16, "OglPlayground loader", NULL, window);
+  }
+
+  ~HiddenWindow_() {
+    if(shared) glfwDestroyWindow(shared);
+    if(window) glfwDestroyWindow(window);
+    glfwTerminate();
+  }
+
+  GLFWwindow* window = nullptr;
+  GLFWwindow* shared = nullptr;
+  bool valid = false;
+};
+
+HiddenWindow_& hiddenWindow_()
+{
+  static HiddenWindow_ hiddenWindow;
+  return hiddenWindow;
+}
+
+} // anonymous namespace
+
+bool makeHiddenGLContextCurrent()
+{
+  HiddenWindow_& hiddenWindow = hiddenWindow_();
+  if(!hiddenWindow.valid) return false;
+  glfwMakeContextCurrent(hiddenWindow.window);
+  return true;
+}
+
+bool makeSharedGLContextCurrent()
+{
+  HiddenWindow_& hiddenWindow = hiddenWindow_();
+  if(!hiddenWindow.shared) return false;
+  glfwMakeContextCurrent(hiddenWindow.shared);
+  return true;
+}
+
+void doneGLContextCurrent()
+{
+  glfwMakeContextCurrent(NULL);
+}
+
+} // namespace OglPlayground
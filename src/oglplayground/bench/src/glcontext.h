@@ -0,0 +1,17 @@
+#pragma once
+
+namespace OglPlayground
+{
+
+// Make a hidden window's opengl context current and load the entry points.
+// Created once, returns false if no context is available (headless machine).
+bool makeHiddenGLContextCurrent();
+
+// Second hidden context sharing objects with the first one, to make current
+// on another thread, e.g. a ResourceLoader's. Call makeHiddenGLContextCurrent
+// first, from the main thread.
+bool makeSharedGLContextCurrent();
+// Release the context current on the calling thread
+void doneGLContextCurrent();
+
+} // namespace OglPlayground
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <inttypes.h>
+#include <vector>
+
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+
+#include "noncopyable.h"
+#include "simd.h"
+#include "transformhierarchy.h"
+
+namespace OglPlayground
+{
+
+//! Keyframe tracks driving the local TRS of TransformHierarchy nodes.
+//! Keys of every track live in contiguous per channel arrays and sample()
+//! interpolates all the tracks of a channel in one vectorized batch before
+//! writing them to the hierarchy.
+class AnimationSampler : public noncopyable
+{
+public:
+  typedef TransformHierarchy::NodeId NodeId;
+
+  AnimationSampler() = default;
+
+  // Keys are copied, times must be increasing. A track holds at least one key.
+  void addPositionTrack(NodeId node, const float* times, const glm::vec3* positions, size_t count);
+  void addRotationTrack(NodeId node, const float* times, const glm::quat* rotations, size_t count);
+  void addScaleTrack(NodeId node, const float* times, const glm::vec3* scales, size_t count);
+
+  size_t trackCount() const;
+  // Time of the last key over all tracks
+  float duration() const;
+
+  // Interpolate every track at time, clamped to the track keys, and set the
+  // result on the hierarchy nodes. Positions and scales are linearly
+  // interpolated, rotations use a normalized lerp.
+  void sample(float time, TransformHierarchy& hierarchy, SimdLevel level = maxSimdLevel());
+
+private:
+  template<typename T>
+  struct Channel
+  {
+    std::vector<NodeId> nodes;
+    std::vector<uint32_t> firstKeys;
+    std::vector<uint32_t> keyCounts;
+    std::vector<uint32_t> cursors; // Last key found per track, playing forward starts from there
+    std::vector<float> times;
+    std::vector<T> values;
+
+    // sample() scratch
+    std::vector<T> from;
+    std::vector<T> to;
+    std::vector<float> alphas;
+    std::vector<T> results;
+  };
+
+  template<typename T>
+  void addTrack(Channel<T>& channel, NodeId node, const float* times, const T* values, size_t count);
+  template<typename T>
+  void gatherKeys(Channel<T>& channel, float time, size_t alphaStride);
+
+  Channel<glm::vec3> positions_;
+  Channel<glm::quat> rotations_;
+  Channel<glm::vec3> scales_;
+  float duration_ = 0.f;
+};
+
+} // namespace OglPlayground
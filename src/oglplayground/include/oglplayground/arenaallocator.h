@@ -0,0 +1,90 @@
+#pragma once
+
+#include <inttypes.h>
+#include <vector>
+
+namespace OglPlayground
+{
+
+//! Two level segregated fit (TLSF) allocator of ranges in [0, capacity),
+//! in any unit. Allocation and free are constant time, free neighbours are
+//! merged right away. It only tracks offsets, the memory lives elsewhere
+//! (see BufferArena).
+class ArenaAllocator
+{
+public:
+  // Handle staying valid until freed, defragmentation included
+  typedef uint32_t Allocation;
+  static const Allocation invalid = UINT32_MAX;
+
+  //! Move of an allocation done by defragment
+  struct Move
+  {
+    uint32_t from;
+    uint32_t to;
+    uint32_t size;
+  };
+
+  struct Stats
+  {
+    uint32_t capacity;
+    uint32_t used;
+    uint32_t largestFree;
+    uint32_t allocations;
+    uint32_t freeBlocks;
+  };
+
+  explicit ArenaAllocator(uint32_t capacity);
+
+  uint32_t capacity() const;
+
+  // Return invalid when no free block is large enough
+  Allocation allocate(uint32_t size);
+  void free(Allocation allocation);
+
+  uint32_t offset(Allocation allocation) const;
+  uint32_t size(Allocation allocation) const;
+
+  // Pack the allocations at the start, keeping their order, and leave a
+  // single free block at the end. moves receives what to copy, always
+  // toward lower offsets.
+  void defragment(std::vector<Move>& moves);
+
+  Stats stats() const;
+
+private:
+  // Size classes: sizes below 16 are exact, then 16 classes per power of two
+  static const uint32_t secondLevelLog2 = 4;
+  static const uint32_t secondLevelCount = 1 << secondLevelLog2;
+  static const uint32_t firstLevelCount = 32 - secondLevelLog2 + 1;
+
+  struct Block
+  {
+    uint32_t offset;
+    uint32_t size;
+    uint32_t prevPhysical; // Neighbours in offset order
+    uint32_t nextPhysical;
+    uint32_t prevFree; // Free list of the size class, or of unused blocks
+    uint32_t nextFree;
+    bool free;
+  };
+
+  static void mapping(uint32_t size, uint32_t& firstLevel, uint32_t& secondLevel);
+  uint32_t newBlock();
+  void insertFree(uint32_t block);
+  void removeFree(uint32_t block);
+  uint32_t findFree(uint32_t size) const;
+
+  uint32_t capacity_;
+  uint32_t used_ = 0;
+  uint32_t allocations_ = 0;
+  std::vector<Block> blocks_;
+  uint32_t unusedBlocks_ = invalid; // Recycled Block entries
+  uint32_t firstBlock_ = invalid; // Block at offset 0
+
+  uint32_t firstLevelBitmap_ = 0;
+  uint32_t secondLevelBitmaps_[firstLevelCount] = {};
+  uint32_t freeHeads_[firstLevelCount][secondLevelCount];
+};
+
+} // namespace OglPlayground
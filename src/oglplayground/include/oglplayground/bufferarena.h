@@ -0,0 +1,69 @@
+#pragma once
+
+#include <inttypes.h>
+#include <vector>
+
+#include <glad/glad.h>
+
+#include "arenaallocator.h"
+#include "bufferobject.h"
+#include "geometry.h"
+#include "noncopyable.h"
+
+namespace OglPlayground
+{
+
+//! One large vertex buffer and one large index buffer shared by many
+//! Geometries of the same vertex format. Ranges are handed out by an
+//! ArenaAllocator, in vertices and indices, so every geometry of the arena
+//! draws with the same vertex array and a base vertex.
+class BufferArena : public noncopyable
+{
+public:
+  typedef ArenaAllocator::Allocation Allocation;
+
+  // Geometries index their own vertices, with a base vertex, so a 16 bit
+  // arena holds any geometry of up to 65536 vertices
+  BufferArena(
+      const VertexDesc& desc,
+      uint32_t vertexCapacity,
+      uint32_t indexCapacity,
+      IndexType indexType = IndexType::UInt32);
+
+  const VertexDesc& desc() const;
+  IndexType indexType() const;
+  const BufferObject& vertexBuffer() const;
+  const BufferObject& indexBuffer() const;
+
+  // Copy the data in a new range, return ArenaAllocator::invalid when full
+  Allocation allocateVertices(const void* vertices, uint32_t count);
+  Allocation allocateIndices(const uint32_t* indices, uint32_t count);
+  void freeVertices(Allocation allocation);
+  void freeIndices(Allocation allocation);
+
+  // Offsets in vertices and indices, they change on defragment
+  uint32_t vertexOffset(Allocation allocation) const;
+  uint32_t indexOffset(Allocation allocation) const;
+
+  // Pack both buffers on the GPU. Allocations keep their handle, the buffers
+  // their name, so vertex arrays stay valid.
+  void defragment();
+
+  ArenaAllocator::Stats vertexStats() const;
+  ArenaAllocator::Stats indexStats() const;
+
+private:
+  void compact(const BufferObject& buffer, ArenaAllocator& allocator, size_t unitSize);
+
+  VertexDesc desc_;
+  size_t stride_;
+  IndexType indexType_;
+  BufferObject vertices_;
+  BufferObject indices_;
+  ArenaAllocator vertexAllocator_;
+  ArenaAllocator indexAllocator_;
+  std::vector<ArenaAllocator::Move> moves_;
+  std::vector<uint8_t> narrowed_; // Scratch of allocateIndices
+};
+
+} // namespace OglPlayground
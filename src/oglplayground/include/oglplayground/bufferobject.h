@@ -9,22 +9,80 @@
 namespace OglPlayground
 {
 
+//! GL buffer. With direct state access (see loadDirectStateAccess) the
+//! storage is immutable and every operation but bind works by name,
+//! otherwise the buffer must be bound to its target to map it. Moving
+//! transfers the name, leaving an empty buffer of name 0 behind.
 class BufferObject : public noncopyable
 {
 public:
+  // Empty, name 0
+  BufferObject() = default;
   BufferObject(GLenum target, size_t size, const void* data, GLenum usage);
+  BufferObject(BufferObject&& other) noexcept;
+  BufferObject& operator=(BufferObject&& other) noexcept;
   ~BufferObject();
 
   GLuint name() const;
+  GLenum target() const;
+  size_t size() const;
+  bool directStateAccess() const;
   void bind() const;
   void unbind() const;
   void* map(GLenum usage) const;
+  // Map [offset, offset+length). access combines
+  // GL_MAP_READ_BIT/GL_MAP_WRITE_BIT with GL_MAP_INVALIDATE_RANGE_BIT,
+  // GL_MAP_INVALIDATE_BUFFER_BIT, GL_MAP_UNSYNCHRONIZED_BIT or
+  // GL_MAP_FLUSH_EXPLICIT_BIT. Return nullptr on failure.
+  void* mapRange(size_t offset, size_t length, GLbitfield access) const;
+  // With GL_MAP_FLUSH_EXPLICIT_BIT, make written bytes visible. offset is
+  // relative to the start of the mapped range.
+  void flushRange(size_t offset, size_t length) const;
   void unmap() const;
+  // None of the following needs the buffer bound. The bind based path goes
+  // through the copy targets, so the element buffer of the bound vertex
+  // array is left alone.
+
+  // Reallocate the storage with the same size and usage, the driver gives
+  // new memory instead of waiting on the old one. Invalidates the data
+  // with direct state access, the storage being immutable.
+  void orphan() const;
+  void upload(size_t offset, size_t size, const void* data) const;
+  void copyFrom(const BufferObject& source, size_t sourceOffset, size_t offset, size_t size) const;
 
 private:
   GLenum target_ = 0;
   size_t size_ = 0;
+  GLenum usage_ = 0;
   GLuint buffer_ = 0;
+  bool dsa_ = false;
+};
+
+//! Mapped range of a BufferObject, unmapped on destruction. Without direct
+//! state access the buffer is bound while the mapping lives.
+class BufferMapping : public noncopyable
+{
+public:
+  BufferMapping(const BufferObject& buffer, size_t offset, size_t length, GLbitfield access);
+  // Whole buffer
+  BufferMapping(const BufferObject& buffer, GLbitfield access);
+  ~BufferMapping();
+
+  bool isValid() const;
+  void* data() const;
+  template<typename T>
+  T* as() const
+  {
+    return static_cast<T*>(data_);
+  }
+  size_t length() const;
+  // Offset relative to the start of the mapping
+  void flush(size_t offset, size_t length) const;
+
+private:
+  const BufferObject& buffer_;
+  size_t length_;
+  void* data_;
 };
   
 } // namespace OglPlayground
@@ -1,7 +1,10 @@
 #pragma once
 
+#include <inttypes.h>
+
 #include <glm/glm.hpp>
 
+#include "frustum.h"
 #include "transform.h"
 
 namespace OglPlayground
@@ -26,12 +29,35 @@ public:
   float farPlane() const;
 
   const glm::mat4& projection() const;
+  // Cached until the projection parameters or the transform change
+  const glm::mat4& view() const;
+  const glm::mat4& viewProjection() const;
+  const glm::mat4& inverseViewProjection() const;
+  // World space frustum, for culling
+  const Frustum& frustum() const;
+
+  // Changes when the projection parameters or the transform change. Sum of
+  // both counters, it can repeat once transform() is assigned another
+  // Transform, the caches compare both counters instead.
+  uint64_t version() const;
   
   Transform& transform();
 
 private:
+  // Cache key, valid while both counters match
+  struct Versions
+  {
+    uint64_t transform;
+    uint64_t projection;
+
+    bool operator!=(const Versions& other) const
+    {
+      return transform != other.transform || projection != other.projection;
+    }
+  };
 
   void flagDirty();
+  Versions versions() const;
   
   Transform transform_;
   float fov_ = 45.f;
@@ -41,6 +67,17 @@ private:
 
   mutable bool cacheDirty_ = true;
   mutable glm::mat4 projection_;
+  uint64_t projectionVersion_ = 0;
+
+  // Caches are valid while their versions match the transform and camera ones
+  mutable uint64_t viewVersion_ = UINT64_MAX;
+  mutable Versions viewProjectionVersions_ = {UINT64_MAX, UINT64_MAX};
+  mutable Versions inverseViewProjectionVersions_ = {UINT64_MAX, UINT64_MAX};
+  mutable Versions frustumVersions_ = {UINT64_MAX, UINT64_MAX};
+  mutable glm::mat4 view_;
+  mutable glm::mat4 viewProjection_;
+  mutable glm::mat4 inverseViewProjection_;
+  mutable Frustum frustum_;
 };
   
 } // namespace OglPlayground
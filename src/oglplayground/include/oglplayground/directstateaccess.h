@@ -0,0 +1,20 @@
+#pragma once
+
+#include <glad/glad.h>
+
+namespace OglPlayground
+{
+
+// Load the ARB_direct_state_access entry points, after gladLoadGLLoader
+// succeeded. BufferObject and GeometryBinder created afterwards edit their
+// objects by name instead of binding them. Return false, keeping the bind
+// based path, when the context has neither GL 4.5 nor the extension.
+bool loadDirectStateAccess(GLADloadproc load);
+
+// Whether objects created from now on use direct state access
+bool directStateAccess();
+// Switch path for objects created from now on, to compare them. Enabling
+// does nothing if loading failed.
+void setDirectStateAccess(bool enabled);
+
+} // namespace OglPlayground
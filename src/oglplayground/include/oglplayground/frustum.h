@@ -0,0 +1,71 @@
+#pragma once
+
+#include <inttypes.h>
+
+#include <glm/glm.hpp>
+
+#include "simd.h"
+
+namespace OglPlayground
+{
+
+//! Six normalized planes (normal, distance) with normals pointing inside,
+//! a point p is inside a plane when dot(normal, p) + distance >= 0.
+struct Frustum
+{
+  enum Plane { Left, Right, Bottom, Top, Near, Far, PlaneCount };
+  glm::vec4 planes[PlaneCount];
+};
+
+// Planes of a projection * view matrix with a [-1, 1] clip depth
+Frustum frustumFromMatrix(const glm::mat4& viewProjection);
+
+//! Axis aligned boxes as structure of arrays, center and half extents
+struct BoxArrays
+{
+  const float* centerX;
+  const float* centerY;
+  const float* centerZ;
+  const float* extentX;
+  const float* extentY;
+  const float* extentZ;
+};
+
+//! Bounding spheres as structure of arrays
+struct SphereArrays
+{
+  const float* centerX;
+  const float* centerY;
+  const float* centerZ;
+  const float* radius;
+};
+
+// Test 4 (SSE2) or 8 (AVX2) volumes at once against the frustum and write
+// the indices of the ones not fully outside to visible, which must hold
+// count indices. Return the number of visible volumes.
+size_t cullBoxes(
+    const Frustum& frustum,
+    const BoxArrays& boxes,
+    size_t count,
+    uint32_t* visible,
+    SimdLevel level = maxSimdLevel());
+size_t cullSpheres(
+    const Frustum& frustum,
+    const SphereArrays& spheres,
+    size_t count,
+    uint32_t* visible,
+    SimdLevel level = maxSimdLevel());
+
+// Test boxes against up to 8 frustums in one pass, loading each box once.
+// Write the indices of the boxes inside any frustum to visible and, at the
+// same position in masks, the bits of the frustums containing them.
+size_t cullBoxesMulti(
+    const Frustum* frustums,
+    size_t frustumCount,
+    const BoxArrays& boxes,
+    size_t count,
+    uint32_t* visible,
+    uint8_t* masks,
+    SimdLevel level = maxSimdLevel());
+
+} // namespace OglPlayground
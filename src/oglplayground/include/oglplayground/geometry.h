@@ -11,35 +11,135 @@
 namespace OglPlayground
 {
 
+class BufferArena;
+class UploadQueue;
+
 enum class AttributeUsage
 {
   Position,
-  UV0
+  UV0,
+  Normal,
+  Tangent,
+  Color,
+  UV1,
+  Joints,
+  Weights
+};
+
+// Storage of each component. Int2101010 packs 4 components in 32 bits, see
+// packSnorm2101010 in vertexformat.h.
+enum class AttributeType
+{
+  Float,
+  Half,
+  Int8,
+  UInt8,
+  Int16,
+  UInt16,
+  Int32,
+  UInt32,
+  Int2101010
+};
+
+// How the shader sees the components: Float converts integers to float as
+// is, Normalized maps them to [-1, 1] or [0, 1], Integer keeps them as ivec
+// or uvec. Integer only applies to integer types.
+enum class AttributeMode
+{
+  Float,
+  Normalized,
+  Integer
 };
 
 struct VertexAttribute
 {
   AttributeUsage usage;
-  size_t nbComponents; // nb floats used for this Attribute
+  size_t nbComponents; // nb components used for this Attribute
+  AttributeType type = AttributeType::Float;
+  AttributeMode mode = AttributeMode::Float;
 };
 typedef std::vector<VertexAttribute> VertexDesc;
+GLenum attributeGLType(AttributeType type);
+// Bytes of the attribute in a vertex, padded to 4 so every attribute stays
+// aligned
+size_t attributeSize(const VertexAttribute& attribute);
 size_t strideFromVertexDesc(const VertexDesc& desc);
+// Byte offset of the attribute in a vertex, or the stride if not in desc
+size_t offsetFromVertexDesc(const VertexDesc& desc, AttributeUsage usage);
+// The attribute of that usage, or nullptr if not in desc
+const VertexAttribute* findAttribute(const VertexDesc& desc, AttributeUsage usage);
+
+// Index buffer storage. 8 bit indices are valid opengl but several GPUs
+// convert them on the fly, so they are opt in.
+enum class IndexType
+{
+  UInt8,
+  UInt16,
+  UInt32
+};
+GLenum indexGLType(IndexType type);
+size_t indexSize(IndexType type);
+// Smallest type indexing verticesCount vertices, not below smallest
+IndexType indexTypeFromVertexCount(size_t verticesCount, IndexType smallest = IndexType::UInt16);
+// Copy indices to the narrower type, every index must fit it
+void narrowIndices(const uint32_t* src, size_t count, IndexType type, void* dst);
 
 class Geometry : public noncopyable
 {
 public:
   friend class GeometryBinder;
   
+  // Indices are stored in the smallest type for verticesCount, see
+  // indexTypeFromVertexCount
   Geometry(
-      const float* vertices,
+      const void* vertices,
       size_t verticesCount,
       const uint32_t* indices,
       size_t indicesCount,
-      const VertexDesc& desc);
+      const VertexDesc& desc,
+      IndexType smallestIndexType = IndexType::UInt16);
+  // Buffers created empty, the data goes through the queue. Draw once it
+  // flushed it.
+  Geometry(
+      UploadQueue& queue,
+      const void* vertices,
+      size_t verticesCount,
+      const uint32_t* indices,
+      size_t indicesCount,
+      const VertexDesc& desc,
+      IndexType smallestIndexType = IndexType::UInt16);
+  // Vertices and indices in ranges of the arena, in its vertex and index
+  // format. The arena must outlive the geometry. When the arena is full the
+  // geometry is not valid and draws nothing.
+  Geometry(
+      BufferArena& arena,
+      const void* vertices,
+      size_t verticesCount,
+      const uint32_t* indices,
+      size_t indicesCount);
+  // Transfer the buffers or the arena ranges, the moved from geometry is
+  // left empty. Binders of a moved geometry can draw(geometry) its new place.
+  Geometry(Geometry&& other) noexcept;
+  Geometry& operator=(Geometry&& other) noexcept;
+  ~Geometry();
+
+  // False when the arena had no room for it
+  bool isValid() const;
+  BufferArena* arena() const;
+  IndexType indexType() const;
 
 private:
-  BufferObject vertices_; 
+  const BufferObject& vertexBuffer() const;
+  const BufferObject& indexBuffer() const;
+  void release();
+
+  IndexType indexType_;
+  // Own buffers, or empty with ranges of arena_
+  BufferObject vertices_;
   BufferObject indices_;
+  BufferArena* arena_ = nullptr;
+  uint32_t vertexAllocation_ = 0;
+  uint32_t indexAllocation_ = 0;
   size_t verticesCount_;
   size_t indicesCount_;
   VertexDesc desc_;
@@ -52,17 +152,26 @@ struct AttributeBind
 };
 typedef std::vector<AttributeBind> AttributeBindDesc;
 
+//! Vertex array of a geometry. Moving transfers the vertex array. The binder
+//! does not keep the geometry, draw() takes it, so geometries can move, for
+//! instance in a growing vector.
 class GeometryBinder : public noncopyable
 {
 public:
-  GeometryBinder(const Geometry* geometry, AttributeBindDesc desc);
+  // Attributes of the geometry missing from desc are left unbound
+  GeometryBinder(const Geometry& geometry, AttributeBindDesc desc);
+  GeometryBinder(GeometryBinder&& other) noexcept;
+  GeometryBinder& operator=(GeometryBinder&& other) noexcept;
+  ~GeometryBinder();
   void bind() const;
-  void draw() const;
+  // The geometry of the binder, or another geometry of the same arena so a
+  // whole arena draws with a single vertex array bind
+  void draw(const Geometry& geometry) const;
   void unbind() const;
 
 private:
   GLuint vao_ = 0;
-  const Geometry* geometry_ = nullptr;
+  GLuint vertexBuffer_ = 0; // To check draw(geometry) is for this vertex array
 };
 
 } // namespace OglPlayground
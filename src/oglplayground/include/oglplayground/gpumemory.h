@@ -0,0 +1,61 @@
+#pragma once
+
+#include <inttypes.h>
+
+#include <glad/glad.h>
+
+namespace OglPlayground
+{
+
+//! Kinds of GL objects the memory registry counts
+enum class GpuResource
+{
+  VertexBuffer,
+  IndexBuffer,
+  PixelUnpackBuffer,
+  UniformBuffer,
+  StorageBuffer,
+  OtherBuffer, // Copy, staging and any other target
+  Texture,
+  VertexArray, // Counted, no bytes
+  Count
+};
+
+struct GpuResourceStats
+{
+  int64_t objects;
+  int64_t bytes;
+  int64_t peakBytes; // Since start or resetGpuMemoryPeaks
+};
+
+//! Registry state at the end of a frame
+struct GpuMemorySnapshot
+{
+  uint64_t frame;
+  GpuResourceStats resources[size_t(GpuResource::Count)];
+  int64_t bytes;
+  int64_t peakBytes;
+  // During the frame
+  int64_t allocatedBytes;
+  int64_t freedBytes;
+};
+
+// Library objects (BufferObject, RingBuffer, GeometryBinder) track
+// themselves, raw GL objects like textures are tracked by their owner.
+// Thread safe, objects may be created on a loader thread.
+void trackGpuAllocation(GpuResource resource, size_t bytes);
+void trackGpuFree(GpuResource resource, size_t bytes);
+
+GpuResource gpuResourceFromTarget(GLenum target);
+// Bytes of a 2D texture to track, with or without its full mipmap chain
+size_t texture2DBytes(size_t width, size_t height, size_t bytesPerPixel, bool mipmaps);
+const char* gpuResourceName(GpuResource resource);
+
+GpuResourceStats gpuResourceStats(GpuResource resource);
+// Current state, allocatedBytes and freedBytes since the last frame end
+GpuMemorySnapshot gpuMemorySnapshot();
+// Snapshot then start the next frame, to call once per frame
+GpuMemorySnapshot endGpuMemoryFrame();
+void resetGpuMemoryPeaks();
+
+} // namespace OglPlayground
@@ -0,0 +1,104 @@
+#pragma once
+
+#include <inttypes.h>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "camera.h"
+#include "noncopyable.h"
+
+namespace OglPlayground
+{
+
+class ThreadPool;
+
+//! Light volume assigned to clusters. A point light keeps the default spot
+//! angle, a spot light is a cone of half angle spotAngle (radians) from
+//! position along direction.
+struct ClusterLight
+{
+  glm::vec3 position;
+  float radius;
+  glm::vec3 direction = glm::vec3(0.f, 0.f, 1.f);
+  float spotAngle = 3.14159265f;
+};
+
+//! Lights of a cluster, lightIndices()[offset] to lightIndices()[offset+count-1].
+//! Uploaded as is, read in glsl as an uvec2.
+struct ClusterRange
+{
+  uint32_t offset;
+  uint32_t count;
+};
+static_assert(sizeof(ClusterRange) == 8, "ClusterRange must match the glsl layout");
+
+// Glsl declaring the cluster and light index storage buffers and
+// lightCluster(vec2 screenUv, float viewDepth) returning the uvec2 range of
+// a fragment, to insert after the #version line. Bindings default to 2 and
+// 3, define LIGHT_CLUSTER_BINDING and LIGHT_INDEX_BINDING before to change
+// them. Expects the uniforms lightGridSize (tilesX, tilesY, slices) and
+// lightGridDepth (LightGrid::depthScaleBias()).
+extern const char* const lightGridGlsl;
+
+//! Clustered light assignment for forward+ shading. The camera frustum is
+//! split in screen tiles and exponential depth slices, and every cluster
+//! gets the list of lights touching it, packed in two flat arrays.
+class LightGrid : public noncopyable
+{
+public:
+  explicit LightGrid(uint32_t tilesX = 16, uint32_t tilesY = 9, uint32_t slices = 24);
+  ~LightGrid();
+
+  uint32_t tilesX() const;
+  uint32_t tilesY() const;
+  uint32_t slices() const;
+  uint32_t clusterCount() const;
+
+  // Assign world space lights to the clusters of the camera, whose near
+  // plane must be positive. Lights keep their relative order in a cluster.
+  void build(const Camera& camera, const ClusterLight* lights, size_t count);
+  void build(ThreadPool& pool, const Camera& camera, const ClusterLight* lights, size_t count);
+
+  // Clusters ordered by slice, then row, then column, see clusterIndex
+  const std::vector<ClusterRange>& clusters() const;
+  const std::vector<uint32_t>& lightIndices() const;
+
+  uint32_t clusterIndex(uint32_t x, uint32_t y, uint32_t slice) const;
+  // Slice of a view space depth, log(depth) * scale + bias clamped to the slices
+  uint32_t sliceFromDepth(float viewDepth) const;
+  glm::vec2 depthScaleBias() const;
+
+private:
+  struct LightBounds;
+
+  void setup(const Camera& camera, size_t lightCount);
+  void boundLights(const ClusterLight* lights, size_t first, size_t last);
+  void binLights();
+  void assignRows(uint32_t firstRow, uint32_t lastRow);
+  void offsetRows();
+  void packRows(uint32_t firstRow, uint32_t lastRow);
+
+  uint32_t tilesX_;
+  uint32_t tilesY_;
+  uint32_t slices_;
+
+  // Camera parameters of the last build
+  glm::mat4 view_;
+  glm::vec2 projectionScale_; // projection[0][0] and projection[1][1]
+  float near_ = 0.f;
+  float far_ = 0.f;
+  float depthScale_ = 0.f;
+  float depthBias_ = 0.f;
+
+  std::vector<LightBounds> bounds_;
+  // A row is the tilesX clusters of one tile row in one slice, filled by one task
+  std::vector<std::vector<uint32_t>> rowLights_; // Lights whose bounds touch the row
+  std::vector<std::vector<uint32_t>> rowIndices_;
+  std::vector<uint32_t> rowOffsets_;
+
+  std::vector<ClusterRange> clusters_;
+  std::vector<uint32_t> lightIndices_;
+};
+
+} // namespace OglPlayground
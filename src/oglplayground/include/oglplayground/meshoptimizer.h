@@ -0,0 +1,90 @@
+#pragma once
+
+#include <inttypes.h>
+#include <vector>
+
+#include "geometry.h"
+
+namespace OglPlayground
+{
+
+class ThreadPool;
+
+// Post transform cache behaviour of a triangle list, simulated with a FIFO
+// cache of cacheSize vertices
+struct VertexCacheStats
+{
+  size_t transformed = 0; // Vertex shader invocations
+  float acmr = 0.f; // Average cache miss ratio, transformed per triangle, 0.5 at best, 3 at worst
+  float atvr = 0.f; // Average transformed vertex ratio, transformed per vertex, 1 at best
+};
+VertexCacheStats analyzeVertexCache(
+    const uint32_t* indices,
+    size_t indicesCount,
+    size_t verticesCount,
+    size_t cacheSize = 16);
+
+// Reorder the triangles for the post transform cache with Tipsify (Sander,
+// Nehab, Barczak 2007), linear in the number of triangles. dst must not be
+// indices.
+void optimizeVertexCache(
+    uint32_t* dst,
+    const uint32_t* indices,
+    size_t indicesCount,
+    size_t verticesCount,
+    size_t cacheSize = 16);
+
+// Tipsify, then clusters of triangles sorted so the ones facing away from
+// the center of the mesh draw first, which hides the inner ones behind them
+// and cuts overdraw from most view directions. Clusters split where the
+// running ACMR drops below threshold times the ACMR of the whole mesh, so
+// threshold bounds what overdraw costs in vertex cache. Triangles wind
+// counter clockwise seen from outside, positions are the Float or Half
+// Position of desc. Without one the triangles keep the Tipsify order.
+void optimizeOverdraw(
+    uint32_t* dst,
+    const uint32_t* indices,
+    size_t indicesCount,
+    const void* vertices,
+    size_t verticesCount,
+    const VertexDesc& desc,
+    float threshold = 1.05f,
+    size_t cacheSize = 16);
+
+// Reorder the vertices in the order indices first use them, and remap
+// indices in place. Unused vertices are dropped, returns the number of
+// vertices written to dst, which has room for verticesCount.
+size_t optimizeVertexFetch(
+    void* dst,
+    uint32_t* indices,
+    size_t indicesCount,
+    const void* vertices,
+    size_t verticesCount,
+    size_t stride);
+
+//! Vertex and index arrays in the form a Geometry takes them
+struct MeshData
+{
+  std::vector<uint8_t> vertices;
+  std::vector<uint32_t> indices;
+  VertexDesc desc;
+
+  size_t verticesCount() const;
+};
+
+struct MeshOptimizeStats
+{
+  VertexCacheStats before;
+  VertexCacheStats after;
+};
+
+// The whole pipeline in place: vertex cache and overdraw, then vertex fetch
+MeshOptimizeStats optimizeMesh(MeshData& mesh, float overdrawThreshold = 1.05f, size_t cacheSize = 16);
+// Meshes in parallel, one task each, stats in the order of meshes
+std::vector<MeshOptimizeStats> optimizeMeshes(
+    ThreadPool& pool,
+    std::vector<MeshData>& meshes,
+    float overdrawThreshold = 1.05f,
+    size_t cacheSize = 16);
+
+} // namespace OglPlayground
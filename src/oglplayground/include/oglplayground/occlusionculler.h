@@ -0,0 +1,88 @@
+#pragma once
+
+#include <inttypes.h>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "frustum.h"
+#include "geometry.h"
+#include "noncopyable.h"
+#include "simd.h"
+
+namespace OglPlayground
+{
+
+class ThreadPool;
+namespace detail { struct OccluderTriangle; }
+
+//! CPU copy of the triangles of an occluder
+struct OccluderMesh
+{
+  std::vector<glm::vec3> positions;
+  std::vector<uint32_t> indices;
+};
+
+// Extract the positions from the vertices given to a Geometry
+OccluderMesh occluderFromVertices(
+    const float* vertices,
+    size_t verticesCount,
+    const uint32_t* indices,
+    size_t indicesCount,
+    const VertexDesc& desc);
+
+//! Software occlusion culling. Occluders are rasterized on the CPU into a
+//! small depth buffer, screen tiles in parallel, then a max depth pyramid
+//! answers conservative visibility queries on bounding boxes.
+class OcclusionCuller : public noncopyable
+{
+public:
+  // Screen tile rasterized by one task, the width is a multiple of every lane width
+  static const uint32_t tileWidth = 64;
+  static const uint32_t tileHeight = 16;
+
+  explicit OcclusionCuller(uint32_t width = 256, uint32_t height = 128);
+  ~OcclusionCuller();
+
+  uint32_t width() const;
+  uint32_t height() const;
+
+  // Start a frame, drop the previous occluders and clear the depth
+  void begin(const glm::mat4& viewProjection);
+  void addOccluder(const OccluderMesh& mesh, const glm::mat4& model);
+
+  // Rasterize the occluders then build the depth pyramid
+  void rasterize(SimdLevel level = maxSimdLevel());
+  void rasterize(ThreadPool& pool, SimdLevel level = maxSimdLevel());
+
+  // Occluder depth in [0, 1] at a pixel, 1 where nothing was drawn
+  float depth(uint32_t x, uint32_t y) const;
+
+  // False only when the world space box is hidden by the occluders or out
+  // of the screen. Boxes crossing the near plane are always visible.
+  bool isVisible(const glm::vec3& center, const glm::vec3& extent) const;
+  // Test boxes[indices[i]], typically the frustum culling output, and write
+  // the visible indices. visible may be indices.
+  size_t testBoxes(const BoxArrays& boxes, const uint32_t* indices, size_t count, uint32_t* visible) const;
+
+private:
+  void rasterizeTiles(uint32_t firstTile, uint32_t lastTile, SimdLevel level);
+  void buildPyramid();
+
+  uint32_t width_;
+  uint32_t height_;
+  uint32_t stride_; // width_ rounded up to tileWidth
+  uint32_t tilesX_;
+  uint32_t tilesY_;
+  glm::mat4 viewProjection_;
+
+  std::vector<detail::OccluderTriangle> triangles_;
+  std::vector<std::vector<uint32_t>> bins_; // Triangles overlapping each tile
+  std::vector<float> depth_;
+
+  // Level 0 is depth_, every texel of the next levels keeps the farthest of its 4 children
+  std::vector<std::vector<float>> pyramid_;
+  std::vector<glm::uvec2> pyramidSizes_;
+};
+
+} // namespace OglPlayground
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+
+namespace OglPlayground
+{
+
+//! 40 bytes transform for shader storage buffers, instead of a 64 bytes mat4.
+//! Read in glsl as 10 floats, see packedTransformGlsl.
+struct PackedTransform
+{
+  glm::vec4 rotation; // Quaternion as x, y, z, w
+  glm::vec3 position;
+  glm::vec3 scale;
+};
+static_assert(sizeof(PackedTransform) == 40, "PackedTransform must match the glsl layout");
+
+//! 32 bytes variant for uniform scales, read in glsl as two vec4.
+struct PackedUniformTransform
+{
+  glm::vec4 rotation; // Quaternion as x, y, z, w
+  glm::vec4 positionScale; // Position in xyz, scale in w
+};
+static_assert(sizeof(PackedUniformTransform) == 32, "PackedUniformTransform must match the glsl layout");
+
+// Glsl declaring the storage buffer and packedTransformMatrix(uint index),
+// to insert after the #version line. Binding defaults to 0, define
+// PACKED_TRANSFORM_BINDING before to change it.
+extern const char* const packedTransformGlsl;
+// Same for PackedUniformTransform, packedUniformTransformMatrix(uint index)
+// and PACKED_UNIFORM_TRANSFORM_BINDING defaulting to 1.
+extern const char* const packedUniformTransformGlsl;
+
+void packTransforms(
+    const glm::vec3* positions,
+    const glm::quat* rotations,
+    const glm::vec3* scales,
+    PackedTransform* packed,
+    size_t count);
+// Scale taken from the x axis
+void packTransforms(
+    const glm::vec3* positions,
+    const glm::quat* rotations,
+    const glm::vec3* scales,
+    PackedUniformTransform* packed,
+    size_t count);
+
+// Decompose affine matrices without shear, like TransformHierarchy::worldMatrices()
+void packTransforms(const glm::mat4* matrices, PackedTransform* packed, size_t count);
+void packTransforms(const glm::mat4* matrices, PackedUniformTransform* packed, size_t count);
+
+// Matrix rebuilt the way the shaders do
+glm::mat4 matrixFromPacked(const PackedTransform& packed);
+glm::mat4 matrixFromPacked(const PackedUniformTransform& packed);
+
+} // namespace OglPlayground
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <glad/glad.h>
+
+#include "noncopyable.h"
+
+namespace OglPlayground
+{
+
+//! Thread creating GL resources in a second context shared with the render
+//! thread. load runs on the loader thread, then a fence is inserted and
+//! publish runs on the render thread, in poll(), once the GPU is done with
+//! what load issued. The render thread never waits.
+//!
+//! Buffers, textures, programs and syncs are shared between contexts,
+//! vertex arrays and framebuffers are not: create GeometryBinders in
+//! publish, not in load.
+class ResourceLoader : public noncopyable
+{
+public:
+  typedef std::function<void ()> Task;
+
+  // makeCurrent is called on the loader thread before any load, to make
+  // the shared context current there (a GLFW context can be made current
+  // on any thread, it must be created on the main one). doneCurrent is
+  // called on exit. Loads are dropped if makeCurrent returns false.
+  ResourceLoader(std::function<bool ()> makeCurrent, std::function<void ()> doneCurrent = nullptr);
+  // Finish the queued loads, their publish calls are dropped
+  ~ResourceLoader();
+
+  void enqueue(Task load, Task publish = nullptr);
+
+  // On the render thread, once per frame. Run publish for loads the GPU
+  // completed, in order, and return how many.
+  size_t poll();
+  // Wait until everything queued is loaded and published
+  void finish();
+
+  // Loads queued or running, or waiting to be published
+  size_t pendingCount() const;
+
+private:
+  struct Job
+  {
+    Task load;
+    Task publish;
+    GLsync fence;
+  };
+
+  void loaderLoop(std::function<bool ()> makeCurrent, std::function<void ()> doneCurrent);
+
+  mutable std::mutex mutex_;
+  std::condition_variable wake_;
+  std::condition_variable loaded_;
+  std::deque<Job> queued_; // To load, guarded by mutex_
+  std::deque<Job> published_; // Loaded, waiting for their fence, guarded by mutex_
+  size_t running_ = 0;
+  bool stop_ = false;
+  std::thread thread_;
+};
+
+} // namespace OglPlayground
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <inttypes.h>
+#include <vector>
+
+#include <glad/glad.h>
+
+#include "noncopyable.h"
+
+namespace OglPlayground
+{
+
+//! Persistently mapped streaming buffer split in frame regions. Data is
+//! written straight to the mapping, without map or unmap, and a fence per
+//! region tells when the GPU is done reading it. With as many regions as
+//! frames in flight writing never waits. Works for any target: vertex,
+//! index, uniform, shader storage or pixel unpack data.
+class RingBuffer : public noncopyable
+{
+public:
+  // Region size is rounded up to 256 bytes, so regions start on any offset
+  // alignment GL asks for
+  RingBuffer(GLenum target, size_t regionSize, uint32_t regionCount = 3);
+  ~RingBuffer();
+
+  GLuint name() const;
+  GLenum target() const;
+  size_t regionSize() const;
+  uint32_t regionCount() const;
+
+  // Move to the next region, waiting for the GPU if it still reads it
+  void beginFrame();
+  // Reserve size bytes in the current region, offset is set to their
+  // position in the buffer. Return nullptr when the region is full.
+  void* allocate(size_t size, size_t alignment, size_t& offset);
+  // Most bytes allocate can still reserve in the current region
+  size_t available(size_t alignment) const;
+  // Fence the region, after the commands reading it were issued
+  void endFrame();
+
+  void bind() const;
+  void unbind() const;
+  // Indexed binding of an allocation, for uniform and shader storage buffers
+  void bindRange(GLuint index, size_t offset, size_t size) const;
+
+  // Times beginFrame had to wait for the GPU
+  uint64_t stallCount() const;
+
+private:
+  GLenum target_;
+  size_t regionSize_;
+  uint32_t regionCount_;
+  GLuint buffer_ = 0;
+  uint8_t* mapping_ = nullptr;
+
+  std::vector<GLsync> fences_; // One per region, null when not in use
+  uint32_t current_;
+  size_t used_ = 0;
+  uint64_t stallCount_ = 0;
+};
+
+} // namespace OglPlayground
@@ -0,0 +1,83 @@
+#pragma once
+
+#include <inttypes.h>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "camera.h"
+#include "frustum.h"
+#include "simd.h"
+
+namespace OglPlayground
+{
+
+// Practical split scheme, lambda blends the logarithmic (1) and uniform (0)
+// splits. Write count+1 depths from near to far in splits.
+void practicalSplits(float nearPlane, float farPlane, uint32_t count, float lambda, float* splits);
+
+//! Light space projection of one cascade
+struct ShadowCascade
+{
+  float splitNear; // Camera view depths covered by the cascade
+  float splitFar;
+  glm::mat4 viewProjection; // World to light clip space, snapped to texels
+};
+
+//! Cascaded shadow maps of a directional light. Each camera depth slice is
+//! fitted with a bounding sphere, which keeps the cascade size constant when
+//! the camera turns, and its position is snapped to shadow map texels so
+//! shadow edges do not shimmer when it moves.
+class ShadowCascades
+{
+public:
+  // Cascades of a caster mask
+  static const uint32_t maxCascades = 8;
+
+  explicit ShadowCascades(uint32_t count = 4, uint32_t resolution = 2048);
+
+  uint32_t count() const;
+  uint32_t resolution() const;
+
+  void setSplitLambda(float lambda);
+  float splitLambda() const;
+
+  // Cascades stop at that depth, 0 uses the camera far plane
+  void setShadowDistance(float distance);
+  float shadowDistance() const;
+
+  // How far toward the light casters outside of a cascade are kept
+  void setCasterDistance(float distance);
+  float casterDistance() const;
+
+  // Fit the cascades on the camera, whose near plane must be positive, for
+  // a light shining along lightDirection
+  void update(const Camera& camera, const glm::vec3& lightDirection);
+
+  const ShadowCascade& cascade(uint32_t index) const;
+  const Frustum& frustum(uint32_t index) const;
+
+  // Cull caster boxes for every cascade in a single pass, with the outputs
+  // of cullBoxesMulti. Bit c of a mask is set when the caster draws in cascade c.
+  size_t cullCasters(
+      const BoxArrays& boxes,
+      size_t count,
+      uint32_t* casters,
+      uint8_t* masks,
+      SimdLevel level = maxSimdLevel()) const;
+
+private:
+  uint32_t resolution_;
+  float splitLambda_ = 0.75f;
+  float shadowDistance_ = 0.f;
+  float casterDistance_ = 100.f;
+
+  std::vector<ShadowCascade> cascades_;
+  std::vector<Frustum> frustums_;
+  // Cascade frustums are boxes in the light rotation space
+  glm::mat4 lightView_;
+  std::vector<glm::vec3> cascadeMin_;
+  std::vector<glm::vec3> cascadeMax_;
+};
+
+} // namespace OglPlayground
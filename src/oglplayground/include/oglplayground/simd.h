@@ -0,0 +1,24 @@
+#pragma once
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define OGLPLAYGROUND_SSE2 1
+#endif
+
+namespace OglPlayground
+{
+
+//! Instruction sets the batched kernels can be dispatched to
+enum class SimdLevel
+{
+  Scalar,
+  SSE2,
+  AVX2
+};
+
+// Best level supported by both the build and the running cpu
+SimdLevel maxSimdLevel();
+
+// Clamp a requested level to what is available
+SimdLevel supportedSimdLevel(SimdLevel requested);
+
+} // namespace OglPlayground
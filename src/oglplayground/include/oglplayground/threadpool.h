@@ -0,0 +1,59 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "noncopyable.h"
+
+namespace OglPlayground
+{
+
+//! Work stealing thread pool. Every thread owns a queue of tasks, idle
+//! threads steal from the others. The thread calling parallelFor takes part
+//! in the work, so a pool of size 1 has no worker thread.
+class ThreadPool : public noncopyable
+{
+public:
+  typedef std::function<void (size_t, size_t)> RangeFunction;
+
+  // Total number of threads working on a parallelFor, caller included
+  explicit ThreadPool(size_t threadCount = std::thread::hardware_concurrency());
+  ~ThreadPool();
+
+  size_t size() const;
+
+  // Call fn(begin, end) on chunks of at most grainSize elements covering
+  // [0, count) and wait for all of them. Chunks only depend on count and
+  // grainSize, never on the number of threads. Can be nested.
+  void parallelFor(size_t count, size_t grainSize, const RangeFunction& fn);
+
+private:
+  struct Job;
+  struct Task
+  {
+    Job* job;
+    size_t begin;
+    size_t end;
+  };
+  struct Queue;
+
+  void workerLoop(size_t index);
+  bool popOrSteal(size_t index, Task& task);
+  void run(const Task& task);
+  size_t currentQueue() const;
+
+  std::vector<std::unique_ptr<Queue>> queues_; // Last queue is shared by external threads
+  std::vector<std::thread> threads_;
+
+  std::mutex wakeMutex_;
+  std::condition_variable wake_;
+  std::atomic<size_t> pendingTasks_;
+  bool stop_ = false;
+};
+
+} // namespace OglPlayground
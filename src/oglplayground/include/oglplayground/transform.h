@@ -1,8 +1,12 @@
 #pragma once
 
+#include <inttypes.h>
+
 #include <glm/glm.hpp>
 #include <glm/gtc/quaternion.hpp>
 
+#include "simd.h"
+
 namespace OglPlayground
 {
 
@@ -12,6 +16,39 @@ enum class Space
   World
 };
 
+class TransformHierarchy;
+
+// translate * rotate * scale
+glm::mat4 matrixFromTRS(const glm::vec3& position, const glm::quat& rotation, const glm::vec3& scale);
+
+// Closed form inverse of matrixFromTRS: inverse(scale) * transpose(rotate) * -translate
+glm::mat4 inverseMatrixFromTRS(const glm::vec3& position, const glm::quat& rotation, const glm::vec3& scale);
+
+// Batched matrixFromTRS processing 4 (SSE2) or 8 (AVX2) transforms at once.
+// The scalar level is bit-identical to matrixFromTRS, SIMD levels give equal values.
+void composeMatrices(
+    const glm::vec3* positions,
+    const glm::quat* rotations,
+    const glm::vec3* scales,
+    glm::mat4* matrices,
+    size_t count,
+    SimdLevel level = maxSimdLevel());
+
+// Batched inverseMatrixFromTRS, same guarantees than composeMatrices
+void composeInverseMatrices(
+    const glm::vec3* positions,
+    const glm::quat* rotations,
+    const glm::vec3* scales,
+    glm::mat4* matrices,
+    size_t count,
+    SimdLevel level = maxSimdLevel());
+
+// Stamp for the versions of transforms and hierarchy nodes, each
+// modification gets one no other transform ever had
+uint64_t newTransformVersion();
+
+//! Either a standalone transform owning its data or a handle on a
+//! TransformHierarchy node.
 class Transform
 {
 public:
@@ -20,6 +57,14 @@ public:
   static const glm::vec3 worldRight;
 
   Transform() = default;
+  Transform(TransformHierarchy* hierarchy, uint32_t node);
+  Transform(const Transform& other) = default;
+  // Takes a new version, the assigned content may differ from what caches
+  // keyed on the previous one hold
+  Transform& operator=(const Transform& other);
+
+  TransformHierarchy* hierarchy() const;
+  uint32_t node() const;
 
   glm::vec3 forward() const;
   glm::vec3 up() const;
@@ -36,6 +81,10 @@ public:
   glm::quat rotation() const;
   glm::vec3 scale() const;
 
+  // Increases each time the transform, or one of its parents, is modified
+  uint64_t version() const;
+
+  // Cached until the next modification
   glm::mat4 localToWorldMatrix() const;
   glm::mat4 worldToLocalMatrix() const;
 
@@ -45,9 +94,23 @@ public:
   void scale(const glm::vec3& scale);
   
 private:
+  void flagDirty();
+  void translateInWorld(const glm::vec3& translation);
+
+  TransformHierarchy* hierarchy_ = nullptr;
+  uint32_t node_ = 0;
+
+  // Used only when not attached to a hierarchy
   glm::vec3 position_ = glm::vec3(0.f);
   glm::quat rotation_ = glm::quat(1.0, 0.0, 0.0, 0.0);
   glm::vec3 scale_ = glm::vec3(1.f);
+  uint64_t version_ = newTransformVersion();
+
+  // Matrices are valid while their version matches version()
+  mutable uint64_t localToWorldVersion_ = UINT64_MAX;
+  mutable uint64_t worldToLocalVersion_ = UINT64_MAX;
+  mutable glm::mat4 localToWorld_;
+  mutable glm::mat4 worldToLocal_;
 };
   
 } // namespace OglPlayground
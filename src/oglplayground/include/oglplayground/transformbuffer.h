@@ -0,0 +1,52 @@
+#pragma once
+
+#include <vector>
+
+#include <glad/glad.h>
+
+#include "bufferobject.h"
+#include "noncopyable.h"
+#include "packedtransform.h"
+#include "transformhierarchy.h"
+
+namespace OglPlayground
+{
+
+//! Shader storage buffer of packed transforms. One upload and one bind per
+//! frame replace a transform uniform per draw, shaders index it with
+//! gl_InstanceID or a per draw index.
+class TransformBuffer : public noncopyable
+{
+public:
+  // Initial capacity in bytes, grows on upload when needed
+  explicit TransformBuffer(size_t capacity = 0);
+
+  void upload(const PackedTransform* transforms, size_t count);
+  void upload(const PackedUniformTransform* transforms, size_t count);
+  // Incremental path, to call after each hierarchy update(). Packs the world
+  // matrices of the changed ranges only and writes them in place, changed
+  // runs closer than maxGap nodes go in a single call. Uploads everything
+  // when updates were missed since the previous call, and nothing without a
+  // new update.
+  void upload(const TransformHierarchy& hierarchy, uint32_t maxGap = 16);
+
+  // Bind to the storage buffer binding point used by the shader
+  void bind(GLuint binding) const;
+
+  size_t capacity() const;
+  const BufferObject& buffer() const;
+
+private:
+  void uploadBytes(const void* data, size_t size);
+  void reserve(size_t size);
+
+  BufferObject buffer_;
+  size_t capacity_ = 0;
+
+  // Incremental upload state, copy of the buffer content
+  std::vector<PackedTransform> packed_;
+  std::vector<IndexRange> ranges_;
+  uint64_t uploadedUpdate_ = 0; // Hierarchy updateCount() of packed_
+};
+
+} // namespace OglPlayground
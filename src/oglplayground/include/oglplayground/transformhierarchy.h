@@ -0,0 +1,131 @@
+#pragma once
+
+#include <inttypes.h>
+#include <vector>
+
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+
+#include "noncopyable.h"
+#include "transform.h"
+
+namespace OglPlayground
+{
+
+class ThreadPool;
+
+// Contiguous range of storage indices
+struct IndexRange
+{
+  uint32_t first;
+  uint32_t count;
+};
+
+//! Structure of arrays storage for a forest of transforms.
+//! Nodes are addressed through stable ids while their data lives in contiguous
+//! arrays sorted parent-before-child, so update() computes every world matrix
+//! in a single linear pass.
+class TransformHierarchy : public noncopyable
+{
+public:
+  typedef uint32_t NodeId;
+  static const NodeId invalidNode;
+  // Parent index stored for root nodes
+  static const uint32_t noParent;
+
+  TransformHierarchy() = default;
+
+  void reserve(size_t capacity);
+  size_t size() const;
+
+  NodeId create(NodeId parent = invalidNode);
+  // Destroy the node and all its descendants
+  void destroy(NodeId node);
+  bool isValid(NodeId node) const;
+
+  void setParent(NodeId node, NodeId parent);
+  NodeId parent(NodeId node) const;
+
+  // Lightweight handle exposing the Transform API on a node
+  Transform transform(NodeId node);
+
+  const glm::vec3& localPosition(NodeId node) const;
+  const glm::quat& localRotation(NodeId node) const;
+  const glm::vec3& localScale(NodeId node) const;
+  void setLocalPosition(NodeId node, const glm::vec3& position);
+  void setLocalRotation(NodeId node, const glm::quat& rotation);
+  void setLocalScale(NodeId node, const glm::vec3& scale);
+  // Batched setters, nodes[i] receives values[i]
+  void setLocalPositions(const NodeId* nodes, const glm::vec3* positions, size_t count);
+  void setLocalRotations(const NodeId* nodes, const glm::quat* rotations, size_t count);
+  void setLocalScales(const NodeId* nodes, const glm::vec3* scales, size_t count);
+
+  glm::vec3 position(NodeId node) const;
+  glm::quat rotation(NodeId node) const;
+  glm::vec3 scale(NodeId node) const;
+
+  // Increases each time the node or one of its ancestors is modified
+  uint64_t version(NodeId node) const;
+
+  // Return the matrix computed by the last update(), or walk the parent chain
+  // if the node or one of its ancestors changed since then.
+  glm::mat4 localToWorldMatrix(NodeId node) const;
+  glm::mat4 parentToWorldMatrix(NodeId node) const;
+
+  // Recompute the world matrices of the nodes modified since the last update
+  void update();
+  // Same as update(), one depth level after the other with the nodes of a
+  // level split between the pool threads. The result does not depend on the
+  // pool size. Sorts the storage by depth first if the structure changed,
+  // which moves indices like setParent does.
+  void update(ThreadPool& pool);
+
+  // Ranges of nodes whose world matrix or index changed during the last
+  // update, for incremental uploads. Runs separated by at most maxGap
+  // unchanged nodes are merged into one range.
+  void changedRanges(std::vector<IndexRange>& ranges, uint32_t maxGap = 0) const;
+  // Number of update() calls, tells consumers of changedRanges whether they
+  // missed an update
+  uint64_t updateCount() const;
+
+  // Raw storage access, arrays are indexed in parent-before-child order.
+  // Indices are invalidated by create, destroy and setParent, and by the
+  // parallel update() following them.
+  uint32_t indexOf(NodeId node) const;
+  NodeId nodeAt(uint32_t index) const;
+  const uint32_t* parentIndices() const;
+  const glm::vec3* localPositions() const;
+  const glm::quat* localRotations() const;
+  const glm::vec3* localScales() const;
+  const glm::mat4* worldMatrices() const;
+
+private:
+  void flagDirty(uint32_t index);
+  uint64_t chainVersion(uint32_t index) const;
+  glm::mat4 worldMatrix(uint32_t index) const;
+  void updateRange(uint32_t first, uint32_t last);
+  void flagMoved();
+  void sortByDepth();
+
+  std::vector<uint32_t> parents_;
+  std::vector<glm::vec3> positions_;
+  std::vector<glm::quat> rotations_;
+  std::vector<glm::vec3> scales_;
+  std::vector<glm::mat4> worldMatrices_;
+  std::vector<uint64_t> versions_; // Stamp of the last local modification
+  std::vector<uint64_t> worldVersions_; // Chain version of worldMatrices_
+
+  std::vector<NodeId> nodes_; // index -> node id
+  std::vector<uint32_t> indices_; // node id -> index
+  std::vector<NodeId> freeNodes_;
+
+  // levels_[d] to levels_[d+1] is the range of depth d when levelsValid_
+  std::vector<uint32_t> levels_ = {0};
+  bool levelsValid_ = true;
+
+  std::vector<uint8_t> outdated_; // Nodes changed by the last update()
+  uint32_t movedFrom_ = 0; // First index moved since the last update()
+  uint64_t updateCount_ = 0;
+};
+
+} // namespace OglPlayground
@@ -0,0 +1,96 @@
+#pragma once
+
+#include <deque>
+#include <inttypes.h>
+#include <vector>
+
+#include <glad/glad.h>
+
+#include "noncopyable.h"
+#include "ringbuffer.h"
+
+namespace OglPlayground
+{
+
+class BufferObject;
+
+//! Deferred uploads to buffers and textures. Data is copied aside when
+//! queued, flush() then moves up to a byte budget of it, oldest first, into
+//! a staging RingBuffer and issues the GL copies: one glCopyBufferSubData
+//! per run of contiguous buffer uploads, one glTexSubImage2D from the
+//! staging buffer per texture upload. Calling flush() once per frame spreads
+//! a level load over frames instead of stalling one.
+//!
+//! Destinations are kept by name, they must live until flushed.
+class UploadQueue : public noncopyable
+{
+public:
+  // frameBudget is the most bytes flush() uploads, and the size of each of
+  // the staging regions. Buffer uploads larger than it are split over
+  // frames, texture uploads larger than it are uploaded alone in a flush
+  // straight from client memory.
+  explicit UploadQueue(size_t frameBudget = 4 << 20, uint32_t framesInFlight = 3);
+
+  void uploadBuffer(const BufferObject& destination, size_t offset, const void* data, size_t size);
+  void uploadBuffer(GLuint destination, size_t offset, const void* data, size_t size);
+  // Region of a level of a 2D texture, data laid out as the unpack state at
+  // flush time says (tightly packed rows by default, 4 bytes aligned)
+  void uploadTexture2D(
+      GLuint texture,
+      GLint level,
+      GLint x,
+      GLint y,
+      GLsizei width,
+      GLsizei height,
+      GLenum format,
+      GLenum type,
+      const void* data,
+      size_t size);
+
+  // Upload what fits in the budget, return the bytes uploaded
+  size_t flush();
+  // Flush until empty or until a flush makes no progress, for loading screens
+  void finish();
+
+  size_t frameBudget() const;
+  size_t pendingBytes() const;
+  size_t pendingCount() const;
+  // GL copy and texture calls issued by the last flush
+  uint32_t lastCallCount() const;
+
+private:
+  struct Upload
+  {
+    GLuint destination; // Buffer or texture name
+    size_t offset; // In the destination buffer
+    size_t size;
+    size_t data; // Offset in bytes_
+    bool texture;
+    GLint level;
+    GLint x, y;
+    GLsizei width, height;
+    GLenum format, type;
+  };
+
+  // Pending copy from staging to a buffer, merged when contiguous
+  struct Copy
+  {
+    GLuint destination;
+    size_t source;
+    size_t offset;
+    size_t size;
+  };
+
+  size_t push(const void* data, size_t size);
+  void issueCopies();
+
+  RingBuffer staging_;
+  std::deque<Upload> uploads_;
+  std::vector<uint8_t> bytes_; // Data of the pending uploads, from bytesBegin_
+  size_t bytesBegin_ = 0;
+  size_t pendingBytes_ = 0;
+  std::vector<Copy> copies_;
+  uint32_t lastCallCount_ = 0;
+};
+
+} // namespace OglPlayground
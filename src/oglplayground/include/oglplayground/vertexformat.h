@@ -0,0 +1,32 @@
+#pragma once
+
+#include <inttypes.h>
+#include <stddef.h>
+
+#include <glm/glm.hpp>
+
+#include "simd.h"
+
+namespace OglPlayground
+{
+
+// Conversions of float vertex data to the packed AttributeTypes of a
+// VertexDesc, count is in components. Rounding is to nearest even. Normalized
+// types clamp to [-1, 1] (signed) or [0, 1] (unsigned), NaN gives any value.
+// Half floats past 65504 become infinity.
+void packHalf(const float* src, uint16_t* dst, size_t count, SimdLevel level = maxSimdLevel());
+void packSnorm8(const float* src, int8_t* dst, size_t count, SimdLevel level = maxSimdLevel());
+void packUnorm8(const float* src, uint8_t* dst, size_t count, SimdLevel level = maxSimdLevel());
+void packSnorm16(const float* src, int16_t* dst, size_t count, SimdLevel level = maxSimdLevel());
+void packUnorm16(const float* src, uint16_t* dst, size_t count, SimdLevel level = maxSimdLevel());
+
+// xyz as 10 bit and w as 2 bit normalized integers, the layout of
+// AttributeType::Int2101010. For normals, and tangents with w the handedness.
+uint32_t packSnorm2101010(const glm::vec4& v);
+void packSnorm2101010(const glm::vec4* src, uint32_t* dst, size_t count);
+
+// Scalar references of packHalf, and the way back
+uint16_t floatToHalf(float f);
+float halfToFloat(uint16_t h);
+
+} // namespace OglPlayground
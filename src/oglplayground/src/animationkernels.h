@@ -0,0 +1,52 @@
+#pragma once
+
+// Internal batched interpolation kernels over the wide float types of
+// simdfloat.h. Each kernel processes count rounded down to the lane width and
+// returns how many elements it handled, callers finish the tail.
+
+#include "simdfloat.h"
+
+namespace OglPlayground
+{
+namespace detail
+{
+namespace
+{
+
+// results = from + (to - from) * alphas, on plain float streams
+template<typename F>
+size_t lerpKernel(const float* from, const float* to, const float* alphas, float* results, size_t count)
+{
+  size_t i = 0;
+  for(; i + F::width <= count; i += F::width) {
+    const F a = F::load(from+i);
+    const F b = F::load(to+i);
+    (a + (b - a) * F::load(alphas+i)).store(results+i);
+  }
+  return i;
+}
+
+// Normalized lerp, keys must already be on the same hemisphere
+template<typename F>
+size_t nlerpKernel(const glm::quat* from, const glm::quat* to, const float* alphas, glm::quat* results, size_t count)
+{
+  const F one = F::set1(1.f);
+  size_t i = 0;
+  for(; i + F::width <= count; i += F::width) {
+    F ax, ay, az, aw, bx, by, bz, bw;
+    F::loadQuats(from+i, ax, ay, az, aw);
+    F::loadQuats(to+i, bx, by, bz, bw);
+    const F t = F::load(alphas+i);
+    const F x = ax + (bx - ax) * t;
+    const F y = ay + (by - ay) * t;
+    const F z = az + (bz - az) * t;
+    const F w = aw + (bw - aw) * t;
+    const F invLength = one / sqrt(x*x + y*y + z*z + w*w);
+    F::storeQuats(results+i, x*invLength, y*invLength, z*invLength, w*invLength);
+  }
+  return i;
+}
+
+} // anonymous namespace
+} // namespace detail
+} // namespace OglPlayground
@@ -0,0 +1,189 @@
+#include <oglplayground/animationsampler.h>
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+
+#include "animationkernels.h"
+
+namespace OglPlayground
+{
+
+#ifdef OGLPLAYGROUND_AVX2
+// Defined in animationsampler_avx2.cpp, built with avx2 enabled
+size_t lerpAVX2(const float* from, const float* to, const float* alphas, float* results, size_t count);
+size_t nlerpAVX2(const glm::quat* from, const glm::quat* to, const float* alphas, glm::quat* results, size_t count);
+#endif
+
+namespace
+{
+
+void lerp_(const float* from, const float* to, const float* alphas, float* results, size_t count, SimdLevel level)
+{
+  size_t done = 0;
+  switch(supportedSimdLevel(level)) {
+#ifdef OGLPLAYGROUND_AVX2
+  case SimdLevel::AVX2:
+    done = lerpAVX2(from, to, alphas, results, count);
+    // fallthrough, the 4 wide kernel handles part of the tail
+#endif
+#ifdef OGLPLAYGROUND_SSE2
+  case SimdLevel::SSE2:
+    done += detail::lerpKernel<detail::Float4>(from+done, to+done, alphas+done, results+done, count-done);
+#endif
+  default:
+    break;
+  }
+
+  for(size_t i = done; i < count; ++i) {
+    results[i] = from[i] + (to[i] - from[i]) * alphas[i];
+  }
+}
+
+void nlerp_(const glm::quat* from, const glm::quat* to, const float* alphas, glm::quat* results, size_t count, SimdLevel level)
+{
+  size_t done = 0;
+  switch(supportedSimdLevel(level)) {
+#ifdef OGLPLAYGROUND_AVX2
+  case SimdLevel::AVX2:
+    done = nlerpAVX2(from, to, alphas, results, count);
+    // fallthrough, the 4 wide kernel handles part of the tail
+#endif
+#ifdef OGLPLAYGROUND_SSE2
+  case SimdLevel::SSE2:
+    done += detail::nlerpKernel<detail::Float4>(from+done, to+done, alphas+done, results+done, count-done);
+#endif
+  default:
+    break;
+  }
+
+  // Same operations in the same order than the kernels
+  for(size_t i = done; i < count; ++i) {
+    const glm::quat& a = from[i];
+    const glm::quat& b = to[i];
+    const float t = alphas[i];
+    const float x = a.x + (b.x - a.x) * t;
+    const float y = a.y + (b.y - a.y) * t;
+    const float z = a.z + (b.z - a.z) * t;
+    const float w = a.w + (b.w - a.w) * t;
+    const float invLength = 1.f / std::sqrt(x*x + y*y + z*z + w*w);
+    results[i] = glm::quat(w*invLength, x*invLength, y*invLength, z*invLength);
+  }
+}
+
+float* floats_(std::vector<glm::vec3>& v)
+{
+  return reinterpret_cast<float*>(v.data());
+}
+
+// First key of the segment containing time, in [0, count-2]
+uint32_t findKey_(const float* times, uint32_t count, float time, uint32_t cursor)
+{
+  // Playing forward mostly stays in the same segment or enters the next one
+  if(times[cursor] <= time) {
+    if(cursor+2 >= count || time < times[cursor+1]) return cursor;
+    if(cursor+3 >= count || time < times[cursor+2]) return cursor+1;
+  }
+  const float* it = std::upper_bound(times+1, times+count-1, time);
+  return uint32_t(it - times) - 1;
+}
+
+} // anonymous namespace
+
+void AnimationSampler::addPositionTrack(NodeId node, const float* times, const glm::vec3* positions, size_t count)
+{
+  addTrack(positions_, node, times, positions, count);
+}
+
+void AnimationSampler::addRotationTrack(NodeId node, const float* times, const glm::quat* rotations, size_t count)
+{
+  const size_t first = rotations_.values.size();
+  addTrack(rotations_, node, times, rotations, count);
+
+  // Keep consecutive keys on the same hemisphere so sampling never has to
+  // pick the shortest path
+  for(size_t i = first+1; i < rotations_.values.size(); ++i) {
+    glm::quat& q = rotations_.values[i];
+    if(glm::dot(rotations_.values[i-1], q) < 0.f) q = glm::quat(-q.w, -q.x, -q.y, -q.z);
+  }
+}
+
+void AnimationSampler::addScaleTrack(NodeId node, const float* times, const glm::vec3* scales, size_t count)
+{
+  addTrack(scales_, node, times, scales, count);
+}
+
+size_t AnimationSampler::trackCount() const
+{
+  return positions_.nodes.size() + rotations_.nodes.size() + scales_.nodes.size();
+}
+
+float AnimationSampler::duration() const
+{
+  return duration_;
+}
+
+void AnimationSampler::sample(float time, TransformHierarchy& hierarchy, SimdLevel level)
+{
+  // Vectors are interpolated as float streams, hence one alpha per component
+  gatherKeys(positions_, time, 3);
+  lerp_(floats_(positions_.from), floats_(positions_.to), positions_.alphas.data(),
+      floats_(positions_.results), positions_.from.size()*3, level);
+  hierarchy.setLocalPositions(positions_.nodes.data(), positions_.results.data(), positions_.nodes.size());
+
+  gatherKeys(rotations_, time, 1);
+  nlerp_(rotations_.from.data(), rotations_.to.data(), rotations_.alphas.data(),
+      rotations_.results.data(), rotations_.from.size(), level);
+  hierarchy.setLocalRotations(rotations_.nodes.data(), rotations_.results.data(), rotations_.nodes.size());
+
+  gatherKeys(scales_, time, 3);
+  lerp_(floats_(scales_.from), floats_(scales_.to), scales_.alphas.data(),
+      floats_(scales_.results), scales_.from.size()*3, level);
+  hierarchy.setLocalScales(scales_.nodes.data(), scales_.results.data(), scales_.nodes.size());
+}
+
+template<typename T>
+void AnimationSampler::addTrack(Channel<T>& channel, NodeId node, const float* times, const T* values, size_t count)
+{
+  assert(count > 0);
+  assert(std::is_sorted(times, times+count));
+  if(count == 0) return;
+
+  channel.nodes.push_back(node);
+  channel.firstKeys.push_back((uint32_t)channel.times.size());
+  channel.keyCounts.push_back((uint32_t)count);
+  channel.cursors.push_back(0);
+  channel.times.insert(channel.times.end(), times, times+count);
+  channel.values.insert(channel.values.end(), values, values+count);
+  duration_ = std::max(duration_, times[count-1]);
+}
+
+template<typename T>
+void AnimationSampler::gatherKeys(Channel<T>& channel, float time, size_t alphaStride)
+{
+  const size_t trackCount = channel.nodes.size();
+  channel.from.resize(trackCount);
+  channel.to.resize(trackCount);
+  channel.alphas.resize(trackCount*alphaStride);
+  channel.results.resize(trackCount);
+
+  for(size_t i = 0; i < trackCount; ++i) {
+    const float* times = &channel.times[channel.firstKeys[i]];
+    const T* values = &channel.values[channel.firstKeys[i]];
+    const uint32_t count = channel.keyCounts[i];
+
+    float alpha = 0.f;
+    uint32_t key = 0;
+    if(count > 1) {
+      key = findKey_(times, count, time, channel.cursors[i]);
+      channel.cursors[i] = key;
+      const float span = times[key+1] - times[key];
+      alpha = span > 0.f ? glm::clamp((time - times[key]) / span, 0.f, 1.f) : 1.f;
+    }
+    channel.from[i] = values[key];
+    channel.to[i] = values[std::min(key+1, count-1)];
+    std::fill_n(&channel.alphas[i*alphaStride], alphaStride, alpha);
+  }
+}
+
+} // namespace OglPlayground
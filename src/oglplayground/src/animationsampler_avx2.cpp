@@ -0,0 +1,22 @@
+#include <oglplayground/animationsampler.h>
+
+#if defined(OGLPLAYGROUND_AVX2) && defined(__AVX2__)
+
+#include "animationkernels.h"
+
+namespace OglPlayground
+{
+
+size_t lerpAVX2(const float* from, const float* to, const float* alphas, float* results, size_t count)
+{
+  return detail::lerpKernel<detail::Float8>(from, to, alphas, results, count);
+}
+
+size_t nlerpAVX2(const glm::quat* from, const glm::quat* to, const float* alphas, glm::quat* results, size_t count)
+{
+  return detail::nlerpKernel<detail::Float8>(from, to, alphas, results, count);
+}
+
+} // namespace OglPlayground
+
+#endif
@@ -0,0 +1,275 @@
+#include <oglplayground/arenaallocator.h>
+
+#include <algorithm>
+#include <cassert>
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+namespace OglPlayground
+{
+namespace
+{
+
+// Index of the highest set bit, v must not be 0
+uint32_t highestBit_(uint32_t v)
+{
+#ifdef _MSC_VER
+  unsigned long index;
+  _BitScanReverse(&index, v);
+  return (uint32_t)index;
+#else
+  return 31 - (uint32_t)__builtin_clz(v);
+#endif
+}
+
+// Index of the lowest set bit, v must not be 0
+uint32_t lowestBit_(uint32_t v)
+{
+#ifdef _MSC_VER
+  unsigned long index;
+  _BitScanForward(&index, v);
+  return (uint32_t)index;
+#else
+  return (uint32_t)__builtin_ctz(v);
+#endif
+}
+
+} // anonymous namespace
+
+const ArenaAllocator::Allocation ArenaAllocator::invalid;
+
+ArenaAllocator::ArenaAllocator(uint32_t capacity) : capacity_(capacity)
+{
+  for(auto& heads : freeHeads_) {
+    std::fill(heads, heads+secondLevelCount, invalid);
+  }
+  if(capacity_ == 0) return;
+  firstBlock_ = newBlock();
+  Block& block = blocks_[firstBlock_];
+  block.offset = 0;
+  block.size = capacity_;
+  insertFree(firstBlock_);
+}
+
+uint32_t ArenaAllocator::capacity() const
+{
+  return capacity_;
+}
+
+ArenaAllocator::Allocation ArenaAllocator::allocate(uint32_t size)
+{
+  if(size == 0) size = 1;
+  const uint32_t index = findFree(size);
+  if(index == invalid) return invalid;
+  removeFree(index);
+
+  // Give the tail back
+  if(blocks_[index].size > size) {
+    const uint32_t tail = newBlock();
+    Block& block = blocks_[index];
+    Block& rest = blocks_[tail];
+    rest.offset = block.offset + size;
+    rest.size = block.size - size;
+    rest.prevPhysical = index;
+    rest.nextPhysical = block.nextPhysical;
+    if(block.nextPhysical != invalid) blocks_[block.nextPhysical].prevPhysical = tail;
+    block.nextPhysical = tail;
+    block.size = size;
+    insertFree(tail);
+  }
+
+  used_ += size;
+  ++allocations_;
+  return index;
+}
+
+void ArenaAllocator::free(Allocation allocation)
+{
+  assert(allocation < blocks_.size() && !blocks_[allocation].free);
+  used_ -= blocks_[allocation].size;
+  --allocations_;
+
+  // Merge the free neighbours into the freed block, their entries are recycled
+  uint32_t index = allocation;
+  const uint32_t prev = blocks_[index].prevPhysical;
+  if(prev != invalid && blocks_[prev].free) {
+    removeFree(prev);
+    blocks_[prev].size += blocks_[index].size;
+    blocks_[prev].nextPhysical = blocks_[index].nextPhysical;
+    if(blocks_[index].nextPhysical != invalid) blocks_[blocks_[index].nextPhysical].prevPhysical = prev;
+    blocks_[index].nextFree = unusedBlocks_;
+    unusedBlocks_ = index;
+    index = prev;
+  }
+  const uint32_t next = blocks_[index].nextPhysical;
+  if(next != invalid && blocks_[next].free) {
+    removeFree(next);
+    blocks_[index].size += blocks_[next].size;
+    blocks_[index].nextPhysical = blocks_[next].nextPhysical;
+    if(blocks_[next].nextPhysical != invalid) blocks_[blocks_[next].nextPhysical].prevPhysical = index;
+    blocks_[next].nextFree = unusedBlocks_;
+    unusedBlocks_ = next;
+  }
+  insertFree(index);
+}
+
+uint32_t ArenaAllocator::offset(Allocation allocation) const
+{
+  assert(allocation < blocks_.size() && !blocks_[allocation].free);
+  return blocks_[allocation].offset;
+}
+
+uint32_t ArenaAllocator::size(Allocation allocation) const
+{
+  assert(allocation < blocks_.size() && !blocks_[allocation].free);
+  return blocks_[allocation].size;
+}
+
+void ArenaAllocator::defragment(std::vector<Move>& moves)
+{
+  moves.clear();
+  if(firstBlock_ == invalid) return;
+
+  // Slide the allocations down in offset order, recycle the free blocks
+  uint32_t offset = 0;
+  uint32_t first = invalid;
+  uint32_t last = invalid;
+  for(uint32_t index = firstBlock_; index != invalid;) {
+    const uint32_t next = blocks_[index].nextPhysical;
+    Block& block = blocks_[index];
+    if(block.free) {
+      removeFree(index);
+      block.nextFree = unusedBlocks_;
+      unusedBlocks_ = index;
+    } else {
+      if(block.offset != offset) moves.push_back({block.offset, offset, block.size});
+      block.offset = offset;
+      block.prevPhysical = last;
+      if(last != invalid) blocks_[last].nextPhysical = index;
+      if(first == invalid) first = index;
+      offset += block.size;
+      last = index;
+    }
+    index = next;
+  }
+
+  if(offset < capacity_) {
+    const uint32_t tail = newBlock();
+    blocks_[tail].offset = offset;
+    blocks_[tail].size = capacity_ - offset;
+    blocks_[tail].prevPhysical = last;
+    if(last != invalid) blocks_[last].nextPhysical = tail;
+    insertFree(tail);
+    if(first == invalid) first = tail;
+    last = tail;
+  }
+  blocks_[last].nextPhysical = invalid;
+  firstBlock_ = first;
+}
+
+ArenaAllocator::Stats ArenaAllocator::stats() const
+{
+  Stats stats;
+  stats.capacity = capacity_;
+  stats.used = used_;
+  stats.allocations = allocations_;
+  stats.largestFree = 0;
+  stats.freeBlocks = 0;
+  for(uint32_t fl = 0; fl < firstLevelCount; ++fl) {
+    for(uint32_t sl = 0; sl < secondLevelCount; ++sl) {
+      for(uint32_t index = freeHeads_[fl][sl]; index != invalid; index = blocks_[index].nextFree) {
+        stats.largestFree = std::max(stats.largestFree, blocks_[index].size);
+        ++stats.freeBlocks;
+      }
+    }
+  }
+  return stats;
+}
+
+void ArenaAllocator::mapping(uint32_t size, uint32_t& firstLevel, uint32_t& secondLevel)
+{
+  if(size < secondLevelCount) {
+    firstLevel = 0;
+    secondLevel = size;
+    return;
+  }
+  const uint32_t bit = highestBit_(size);
+  firstLevel = bit - secondLevelLog2 + 1;
+  secondLevel = (size >> (bit - secondLevelLog2)) & (secondLevelCount-1);
+}
+
+uint32_t ArenaAllocator::newBlock()
+{
+  uint32_t index = unusedBlocks_;
+  if(index != invalid) {
+    unusedBlocks_ = blocks_[index].nextFree;
+  } else {
+    index = (uint32_t)blocks_.size();
+    blocks_.push_back(Block());
+  }
+  blocks_[index] = Block{0, 0, invalid, invalid, invalid, invalid, false};
+  return index;
+}
+
+void ArenaAllocator::insertFree(uint32_t index)
+{
+  uint32_t fl, sl;
+  mapping(blocks_[index].size, fl, sl);
+  Block& block = blocks_[index];
+  block.free = true;
+  block.prevFree = invalid;
+  block.nextFree = freeHeads_[fl][sl];
+  if(block.nextFree != invalid) blocks_[block.nextFree].prevFree = index;
+  freeHeads_[fl][sl] = index;
+  firstLevelBitmap_ |= 1u << fl;
+  secondLevelBitmaps_[fl] |= 1u << sl;
+}
+
+void ArenaAllocator::removeFree(uint32_t index)
+{
+  uint32_t fl, sl;
+  mapping(blocks_[index].size, fl, sl);
+  Block& block = blocks_[index];
+  if(block.prevFree != invalid) blocks_[block.prevFree].nextFree = block.nextFree;
+  if(block.nextFree != invalid) blocks_[block.nextFree].prevFree = block.prevFree;
+  if(freeHeads_[fl][sl] == index) {
+    freeHeads_[fl][sl] = block.nextFree;
+    if(block.nextFree == invalid) {
+      secondLevelBitmaps_[fl] &= ~(1u << sl);
+      if(secondLevelBitmaps_[fl] == 0) firstLevelBitmap_ &= ~(1u << fl);
+    }
+  }
+  block.free = false;
+}
+
+uint32_t ArenaAllocator::findFree(uint32_t size) const
+{
+  // Round up to the next class, any block there is large enough
+  uint64_t rounded = size;
+  if(size >= secondLevelCount) rounded += (uint64_t(1) << (highestBit_(size) - secondLevelLog2)) - 1;
+  if(rounded <= capacity_) {
+    uint32_t fl, sl;
+    mapping((uint32_t)rounded, fl, sl);
+    uint32_t secondLevelMap = secondLevelBitmaps_[fl] & (~0u << sl);
+    if(secondLevelMap == 0) {
+      const uint32_t firstLevelMap = fl+1 < firstLevelCount ? firstLevelBitmap_ & (~0u << (fl+1)) : 0;
+      if(firstLevelMap != 0) {
+        fl = lowestBit_(firstLevelMap);
+        secondLevelMap = secondLevelBitmaps_[fl];
+      }
+    }
+    if(secondLevelMap != 0) return freeHeads_[fl][lowestBit_(secondLevelMap)];
+  }
+
+  // Nearly full arena, the class of the size itself may still hold a fit
+  uint32_t fl, sl;
+  mapping(size, fl, sl);
+  for(uint32_t index = freeHeads_[fl][sl]; index != invalid; index = blocks_[index].nextFree) {
+    if(blocks_[index].size >= size) return index;
+  }
+  return invalid;
+}
+
+} // namespace OglPlayground
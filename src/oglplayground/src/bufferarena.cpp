@@ -0,0 +1,123 @@
+#include <oglplayground/bufferarena.h>
+
+#include <algorithm>
+#include <cassert>
+
+namespace OglPlayground
+{
+
+BufferArena::BufferArena(
+    const VertexDesc& desc,
+    uint32_t vertexCapacity,
+    uint32_t indexCapacity,
+    IndexType indexType)
+    : desc_(desc)
+    , stride_(strideFromVertexDesc(desc))
+    , indexType_(indexType)
+    , vertices_(GL_ARRAY_BUFFER, vertexCapacity*strideFromVertexDesc(desc), nullptr, GL_STATIC_DRAW)
+    , indices_(GL_ELEMENT_ARRAY_BUFFER, indexCapacity*indexSize(indexType), nullptr, GL_STATIC_DRAW)
+    , vertexAllocator_(vertexCapacity)
+    , indexAllocator_(indexCapacity)
+{
+}
+
+const VertexDesc& BufferArena::desc() const
+{
+  return desc_;
+}
+
+IndexType BufferArena::indexType() const
+{
+  return indexType_;
+}
+
+const BufferObject& BufferArena::vertexBuffer() const
+{
+  return vertices_;
+}
+
+const BufferObject& BufferArena::indexBuffer() const
+{
+  return indices_;
+}
+
+BufferArena::Allocation BufferArena::allocateVertices(const void* vertices, uint32_t count)
+{
+  const Allocation allocation = vertexAllocator_.allocate(count);
+  if(allocation == ArenaAllocator::invalid) return allocation;
+  vertices_.upload(vertexAllocator_.offset(allocation)*stride_, count*stride_, vertices);
+  return allocation;
+}
+
+BufferArena::Allocation BufferArena::allocateIndices(const uint32_t* indices, uint32_t count)
+{
+  const Allocation allocation = indexAllocator_.allocate(count);
+  if(allocation == ArenaAllocator::invalid) return allocation;
+  const size_t size = indexSize(indexType_);
+  const size_t offset = indexAllocator_.offset(allocation)*size;
+  if(indexType_ == IndexType::UInt32) {
+    indices_.upload(offset, count*size, indices);
+    return allocation;
+  }
+  narrowed_.resize(count*size);
+  narrowIndices(indices, count, indexType_, narrowed_.data());
+  indices_.upload(offset, count*size, narrowed_.data());
+  return allocation;
+}
+
+void BufferArena::freeVertices(Allocation allocation)
+{
+  vertexAllocator_.free(allocation);
+}
+
+void BufferArena::freeIndices(Allocation allocation)
+{
+  indexAllocator_.free(allocation);
+}
+
+uint32_t BufferArena::vertexOffset(Allocation allocation) const
+{
+  return vertexAllocator_.offset(allocation);
+}
+
+uint32_t BufferArena::indexOffset(Allocation allocation) const
+{
+  return indexAllocator_.offset(allocation);
+}
+
+void BufferArena::defragment()
+{
+  compact(vertices_, vertexAllocator_, stride_);
+  compact(indices_, indexAllocator_, indexSize(indexType_));
+}
+
+ArenaAllocator::Stats BufferArena::vertexStats() const
+{
+  return vertexAllocator_.stats();
+}
+
+ArenaAllocator::Stats BufferArena::indexStats() const
+{
+  return indexAllocator_.stats();
+}
+
+void BufferArena::compact(const BufferObject& buffer, ArenaAllocator& allocator, size_t unitSize)
+{
+  allocator.defragment(moves_);
+  if(moves_.empty()) return;
+
+  // Moved ranges may overlap their old place, they go through a scratch
+  // buffer holding the packed layout
+  uint32_t end = 0;
+  for(const auto& move : moves_) end = std::max(end, move.to + move.size);
+  BufferObject scratch(GL_COPY_WRITE_BUFFER, end*unitSize, nullptr, GL_STREAM_COPY);
+
+  for(const auto& move : moves_) {
+    scratch.copyFrom(buffer, move.from*unitSize, move.to*unitSize, move.size*unitSize);
+  }
+  for(const auto& move : moves_) {
+    buffer.copyFrom(scratch, move.to*unitSize, move.to*unitSize, move.size*unitSize);
+  }
+}
+
+} // namespace OglPlayground
@@ -1,20 +1,65 @@
 #include <oglplayground/bufferobject.h>
 
+#include <cassert>
+
+#include <oglplayground/directstateaccess.h>
+#include <oglplayground/gpumemory.h>
+
+#include "dsafunctions.h"
+
 namespace OglPlayground
 {
 
 BufferObject::BufferObject(GLenum target, size_t size, const void* data, GLenum usage)
     : target_(target)
     , size_(size)
+    , usage_(usage)
+    , dsa_(OglPlayground::directStateAccess())
 {
+  trackGpuAllocation(gpuResourceFromTarget(target_), size_);
+  if(dsa_) {
+    detail::createBuffers(1, &buffer_);
+    // Zero sized storage is an error, the buffer stays empty
+    const GLbitfield flags = GL_DYNAMIC_STORAGE_BIT | GL_MAP_READ_BIT | GL_MAP_WRITE_BIT;
+    if(size_ > 0) detail::namedBufferStorage(buffer_, size_, data, flags);
+    return;
+  }
   glGenBuffers(1, &buffer_);
   bind();
   glBufferData(target, size, data, usage);
   unbind();
 }
 
+BufferObject::BufferObject(BufferObject&& other) noexcept
+    : target_(other.target_)
+    , size_(other.size_)
+    , usage_(other.usage_)
+    , buffer_(other.buffer_)
+    , dsa_(other.dsa_)
+{
+  other.size_ = 0;
+  other.buffer_ = 0;
+}
+
+BufferObject& BufferObject::operator=(BufferObject&& other) noexcept
+{
+  if(this == &other) return *this;
+  if(buffer_) trackGpuFree(gpuResourceFromTarget(target_), size_);
+  glDeleteBuffers(1, &buffer_);
+  target_ = other.target_;
+  size_ = other.size_;
+  usage_ = other.usage_;
+  buffer_ = other.buffer_;
+  dsa_ = other.dsa_;
+  other.size_ = 0;
+  other.buffer_ = 0;
+  return *this;
+}
+
 BufferObject::~BufferObject()
 {
+  if(buffer_) trackGpuFree(gpuResourceFromTarget(target_), size_);
+  // Deleting name 0 is a no-op
   glDeleteBuffers(1, &buffer_);
 }
 
@@ -23,6 +68,21 @@ GLuint BufferObject::name() const
   return buffer_;
 }
 
+GLenum BufferObject::target() const
+{
+  return target_;
+}
+
+size_t BufferObject::size() const
+{
+  return size_;
+}
+
+bool BufferObject::directStateAccess() const
+{
+  return dsa_;
+}
+
 void BufferObject::bind() const
 {
   glBindBuffer(target_, buffer_);
@@ -35,12 +95,117 @@ void BufferObject::unbind() const
 
 void* BufferObject::map(GLenum usage) const
 {
+  if(dsa_) return detail::mapNamedBuffer(buffer_, usage);
   return glMapBuffer(target_, usage);
 }
 
+void* BufferObject::mapRange(size_t offset, size_t length, GLbitfield access) const
+{
+  assert(offset+length <= size_);
+  if(dsa_) return detail::mapNamedBufferRange(buffer_, offset, length, access);
+  return glMapBufferRange(target_, offset, length, access);
+}
+
+void BufferObject::flushRange(size_t offset, size_t length) const
+{
+  if(dsa_) {
+    detail::flushMappedNamedBufferRange(buffer_, offset, length);
+    return;
+  }
+  glFlushMappedBufferRange(target_, offset, length);
+}
+
 void BufferObject::unmap() const
 {
+  if(dsa_) {
+    detail::unmapNamedBuffer(buffer_);
+    return;
+  }
   glUnmapBuffer(target_);
 }
 
+void BufferObject::orphan() const
+{
+  if(dsa_) {
+    glInvalidateBufferData(buffer_);
+    return;
+  }
+  glBindBuffer(GL_COPY_WRITE_BUFFER, buffer_);
+  glBufferData(GL_COPY_WRITE_BUFFER, size_, nullptr, usage_);
+  glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+}
+
+void BufferObject::upload(size_t offset, size_t size, const void* data) const
+{
+  assert(offset+size <= size_);
+  if(dsa_) {
+    detail::namedBufferSubData(buffer_, offset, size, data);
+    return;
+  }
+  glBindBuffer(GL_COPY_WRITE_BUFFER, buffer_);
+  glBufferSubData(GL_COPY_WRITE_BUFFER, offset, size, data);
+  glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+}
+
+void BufferObject::copyFrom(const BufferObject& source, size_t sourceOffset, size_t offset, size_t size) const
+{
+  assert(sourceOffset+size <= source.size_ && offset+size <= size_);
+  if(dsa_ && source.dsa_) {
+    detail::copyNamedBufferSubData(source.buffer_, buffer_, sourceOffset, offset, size);
+    return;
+  }
+  glBindBuffer(GL_COPY_READ_BUFFER, source.buffer_);
+  glBindBuffer(GL_COPY_WRITE_BUFFER, buffer_);
+  glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, sourceOffset, offset, size);
+  glBindBuffer(GL_COPY_READ_BUFFER, 0);
+  glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+}
+
+BufferMapping::BufferMapping(const BufferObject& buffer, size_t offset, size_t length, GLbitfield access)
+    : buffer_(buffer)
+    , length_(length)
+{
+  if(!buffer_.directStateAccess()) buffer_.bind();
+  data_ = buffer_.mapRange(offset, length, access);
+}
+
+BufferMapping::BufferMapping(const BufferObject& buffer, GLbitfield access)
+    : BufferMapping(buffer, 0, buffer.size(), access)
+{
+}
+
+BufferMapping::~BufferMapping()
+{
+  if(buffer_.directStateAccess()) {
+    if(data_) buffer_.unmap();
+    return;
+  }
+  // Something else may have been bound to the target meanwhile
+  buffer_.bind();
+  if(data_) buffer_.unmap();
+  buffer_.unbind();
+}
+
+bool BufferMapping::isValid() const
+{
+  return data_ != nullptr;
+}
+
+void* BufferMapping::data() const
+{
+  return data_;
+}
+
+size_t BufferMapping::length() const
+{
+  return length_;
+}
+
+void BufferMapping::flush(size_t offset, size_t length) const
+{
+  assert(data_ && offset+length <= length_);
+  if(!buffer_.directStateAccess()) buffer_.bind();
+  buffer_.flushRange(offset, length);
+}
+
 } // namespace OglPlayground
@@ -7,6 +7,8 @@ namespace OglPlayground
 
 void Camera::setFov(float fov)
 {
+  // Setting the same value every frame keeps the caches valid
+  if (fov == fov_) return;
   fov_ = fov;
   flagDirty();
 }
@@ -18,6 +20,7 @@ float Camera::fov() const
 
 void Camera::setAspect(float aspect)
 {
+  if (aspect == aspect_) return;
   aspect_ = aspect;
   flagDirty();
 }
@@ -29,6 +32,7 @@ float Camera::aspect() const
 
 void Camera::setClippingPlanes(float nearPlane, float farPlane)
 {
+  if (nearPlane == nearPlane_ && farPlane == farPlane_) return;
   nearPlane_ = nearPlane;
   farPlane_ = farPlane;
   flagDirty();
@@ -53,14 +57,65 @@ const glm::mat4& Camera::projection() const
   return projection_;
 }
 
+const glm::mat4& Camera::view() const
+{
+  const uint64_t version = transform_.version();
+  if (viewVersion_ != version) {
+    view_ = transform_.worldToLocalMatrix();
+    viewVersion_ = version;
+  }
+  return view_;
+}
+
+const glm::mat4& Camera::viewProjection() const
+{
+  const Versions current = versions();
+  if (viewProjectionVersions_ != current) {
+    viewProjection_ = projection() * view();
+    viewProjectionVersions_ = current;
+  }
+  return viewProjection_;
+}
+
+const glm::mat4& Camera::inverseViewProjection() const
+{
+  const Versions current = versions();
+  if (inverseViewProjectionVersions_ != current) {
+    inverseViewProjection_ = glm::inverse(viewProjection());
+    inverseViewProjectionVersions_ = current;
+  }
+  return inverseViewProjection_;
+}
+
+const Frustum& Camera::frustum() const
+{
+  const Versions current = versions();
+  if (frustumVersions_ != current) {
+    frustum_ = frustumFromMatrix(viewProjection());
+    frustumVersions_ = current;
+  }
+  return frustum_;
+}
+
+uint64_t Camera::version() const
+{
+  return transform_.version() + projectionVersion_;
+}
+
 Transform& Camera::transform()
 {
   return transform_;
 }
 
+Camera::Versions Camera::versions() const
+{
+  return {transform_.version(), projectionVersion_};
+}
+
 void Camera::flagDirty()
 {
   cacheDirty_ = true;
+  ++projectionVersion_;
 }
 
 } // namespace OglPlayground
@@ -0,0 +1,83 @@
+#include <oglplayground/transform.h>
+
+#include "simdfloat.h"
+#include "trskernels.h"
+
+namespace OglPlayground
+{
+
+#ifdef OGLPLAYGROUND_AVX2
+// Defined in composematrices_avx2.cpp, built with avx2 enabled
+size_t composeMatricesAVX2(
+    const glm::vec3* positions,
+    const glm::quat* rotations,
+    const glm::vec3* scales,
+    glm::mat4* matrices,
+    size_t count);
+size_t composeInverseMatricesAVX2(
+    const glm::vec3* positions,
+    const glm::quat* rotations,
+    const glm::vec3* scales,
+    glm::mat4* matrices,
+    size_t count);
+#endif
+
+void composeMatrices(
+    const glm::vec3* positions,
+    const glm::quat* rotations,
+    const glm::vec3* scales,
+    glm::mat4* matrices,
+    size_t count,
+    SimdLevel level)
+{
+  size_t done = 0;
+  switch(supportedSimdLevel(level)) {
+#ifdef OGLPLAYGROUND_AVX2
+  case SimdLevel::AVX2:
+    done = composeMatricesAVX2(positions, rotations, scales, matrices, count);
+    // fallthrough, the 4 wide kernel handles part of the tail
+#endif
+#ifdef OGLPLAYGROUND_SSE2
+  case SimdLevel::SSE2:
+    done += detail::composeMatricesKernel<detail::Float4>(
+        positions+done, rotations+done, scales+done, matrices+done, count-done);
+#endif
+  default:
+    break;
+  }
+
+  for(size_t i = done; i < count; ++i) {
+    matrices[i] = matrixFromTRS(positions[i], rotations[i], scales[i]);
+  }
+}
+
+void composeInverseMatrices(
+    const glm::vec3* positions,
+    const glm::quat* rotations,
+    const glm::vec3* scales,
+    glm::mat4* matrices,
+    size_t count,
+    SimdLevel level)
+{
+  size_t done = 0;
+  switch(supportedSimdLevel(level)) {
+#ifdef OGLPLAYGROUND_AVX2
+  case SimdLevel::AVX2:
+    done = composeInverseMatricesAVX2(positions, rotations, scales, matrices, count);
+    // fallthrough, the 4 wide kernel handles part of the tail
+#endif
+#ifdef OGLPLAYGROUND_SSE2
+  case SimdLevel::SSE2:
+    done += detail::composeInverseMatricesKernel<detail::Float4>(
+        positions+done, rotations+done, scales+done, matrices+done, count-done);
+#endif
+  default:
+    break;
+  }
+
+  for(size_t i = done; i < count; ++i) {
+    matrices[i] = inverseMatrixFromTRS(positions[i], rotations[i], scales[i]);
+  }
+}
+
+} // namespace OglPlayground
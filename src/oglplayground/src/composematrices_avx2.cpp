@@ -0,0 +1,33 @@
+#include <oglplayground/transform.h>
+
+#if defined(OGLPLAYGROUND_AVX2) && defined(__AVX2__)
+
+#include "simdfloat.h"
+#include "trskernels.h"
+
+namespace OglPlayground
+{
+
+size_t composeMatricesAVX2(
+    const glm::vec3* positions,
+    const glm::quat* rotations,
+    const glm::vec3* scales,
+    glm::mat4* matrices,
+    size_t count)
+{
+  return detail::composeMatricesKernel<detail::Float8>(positions, rotations, scales, matrices, count);
+}
+
+size_t composeInverseMatricesAVX2(
+    const glm::vec3* positions,
+    const glm::quat* rotations,
+    const glm::vec3* scales,
+    glm::mat4* matrices,
+    size_t count)
+{
+  return detail::composeInverseMatricesKernel<detail::Float8>(positions, rotations, scales, matrices, count);
+}
+
+} // namespace OglPlayground
+
+#endif
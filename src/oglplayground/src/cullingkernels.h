@@ -0,0 +1,124 @@
+#pragma once
+
+// Internal batched frustum tests over the wide float types of simdfloat.h.
+// Each kernel starts at first, stops when less than a lane width remains,
+// appends the visible indices and returns where it stopped.
+
+#include <oglplayground/frustum.h>
+
+#include "simdfloat.h"
+
+namespace OglPlayground
+{
+namespace detail
+{
+namespace
+{
+
+// Indices of the lanes not flagged in outside, written branchless: every
+// lane is stored and only the visible ones advance the output
+inline uint32_t* compactVisible(uint32_t* visible, uint32_t first, int outside, size_t width)
+{
+  for(size_t k = 0; k < width; ++k) {
+    *visible = first + (uint32_t)k;
+    visible += ((outside >> k) & 1) ^ 1;
+  }
+  return visible;
+}
+
+// Same with the frustum masks of each lane, written next to the indices
+inline void compactMasks(uint32_t*& visible, uint8_t*& masks, uint32_t first, const uint32_t* laneMasks, size_t width)
+{
+  for(size_t k = 0; k < width; ++k) {
+    *visible = first + (uint32_t)k;
+    *masks = (uint8_t)laneMasks[k];
+    const size_t inside = laneMasks[k] != 0;
+    visible += inside;
+    masks += inside;
+  }
+}
+
+template<typename F>
+size_t cullBoxesKernel(const Frustum& frustum, const BoxArrays& boxes, size_t first, size_t count, uint32_t*& visible)
+{
+  const F zero = F::zero();
+  size_t i = first;
+  for(; i + F::width <= count; i += F::width) {
+    const F cx = F::load(boxes.centerX+i);
+    const F cy = F::load(boxes.centerY+i);
+    const F cz = F::load(boxes.centerZ+i);
+    const F ex = F::load(boxes.extentX+i);
+    const F ey = F::load(boxes.extentY+i);
+    const F ez = F::load(boxes.extentZ+i);
+    int outside = 0;
+    for(const glm::vec4& plane : frustum.planes) {
+      // Distance of the center plus the box projected radius on the normal
+      const F d = F::set1(plane.x)*cx + F::set1(plane.y)*cy + F::set1(plane.z)*cz + F::set1(plane.w);
+      const F r = F::set1(abs_(plane.x))*ex + F::set1(abs_(plane.y))*ey + F::set1(abs_(plane.z))*ez;
+      outside |= lessMask(d + r, zero);
+    }
+    visible = compactVisible(visible, (uint32_t)i, outside, F::width);
+  }
+  return i;
+}
+
+// Boxes against several frustums, each box loaded once
+template<typename F>
+size_t cullBoxesMultiKernel(
+    const Frustum* frustums,
+    size_t frustumCount,
+    const BoxArrays& boxes,
+    size_t first,
+    size_t count,
+    uint32_t*& visible,
+    uint8_t*& masks)
+{
+  const F zero = F::zero();
+  size_t i = first;
+  for(; i + F::width <= count; i += F::width) {
+    const F cx = F::load(boxes.centerX+i);
+    const F cy = F::load(boxes.centerY+i);
+    const F cz = F::load(boxes.centerZ+i);
+    const F ex = F::load(boxes.extentX+i);
+    const F ey = F::load(boxes.extentY+i);
+    const F ez = F::load(boxes.extentZ+i);
+    uint32_t laneMasks[F::width] = {};
+    for(size_t f = 0; f < frustumCount; ++f) {
+      int outside = 0;
+      for(const glm::vec4& plane : frustums[f].planes) {
+        const F d = F::set1(plane.x)*cx + F::set1(plane.y)*cy + F::set1(plane.z)*cz + F::set1(plane.w);
+        const F r = F::set1(abs_(plane.x))*ex + F::set1(abs_(plane.y))*ey + F::set1(abs_(plane.z))*ez;
+        outside |= lessMask(d + r, zero);
+      }
+      for(size_t k = 0; k < F::width; ++k) {
+        laneMasks[k] |= (((outside >> k) & 1) ^ 1) << f;
+      }
+    }
+    compactMasks(visible, masks, (uint32_t)i, laneMasks, F::width);
+  }
+  return i;
+}
+
+template<typename F>
+size_t cullSpheresKernel(const Frustum& frustum, const SphereArrays& spheres, size_t first, size_t count, uint32_t*& visible)
+{
+  const F zero = F::zero();
+  size_t i = first;
+  for(; i + F::width <= count; i += F::width) {
+    const F cx = F::load(spheres.centerX+i);
+    const F cy = F::load(spheres.centerY+i);
+    const F cz = F::load(spheres.centerZ+i);
+    const F r = F::load(spheres.radius+i);
+    int outside = 0;
+    for(const glm::vec4& plane : frustum.planes) {
+      const F d = F::set1(plane.x)*cx + F::set1(plane.y)*cy + F::set1(plane.z)*cz + F::set1(plane.w);
+      outside |= lessMask(d + r, zero);
+    }
+    visible = compactVisible(visible, (uint32_t)i, outside, F::width);
+  }
+  return i;
+}
+
+} // anonymous namespace
+} // namespace detail
+} // namespace OglPlayground
@@ -0,0 +1,98 @@
+#include <oglplayground/directstateaccess.h>
+
+#include <cstring>
+
+#include "dsafunctions.h"
+
+namespace OglPlayground
+{
+namespace detail
+{
+
+PfnCreateBuffers createBuffers = nullptr;
+PfnNamedBufferStorage namedBufferStorage = nullptr;
+PfnNamedBufferSubData namedBufferSubData = nullptr;
+PfnCopyNamedBufferSubData copyNamedBufferSubData = nullptr;
+PfnMapNamedBuffer mapNamedBuffer = nullptr;
+PfnMapNamedBufferRange mapNamedBufferRange = nullptr;
+PfnUnmapNamedBuffer unmapNamedBuffer = nullptr;
+PfnFlushMappedNamedBufferRange flushMappedNamedBufferRange = nullptr;
+PfnCreateVertexArrays createVertexArrays = nullptr;
+PfnVertexArrayVertexBuffer vertexArrayVertexBuffer = nullptr;
+PfnVertexArrayElementBuffer vertexArrayElementBuffer = nullptr;
+PfnVertexArrayAttribFormat vertexArrayAttribFormat = nullptr;
+PfnVertexArrayAttribIFormat vertexArrayAttribIFormat = nullptr;
+PfnVertexArrayAttribBinding vertexArrayAttribBinding = nullptr;
+PfnEnableVertexArrayAttrib enableVertexArrayAttrib = nullptr;
+
+} // namespace detail
+
+namespace
+{
+
+bool loaded_ = false;
+bool enabled_ = false;
+
+bool hasExtension_(const char* name)
+{
+  GLint count = 0;
+  glGetIntegerv(GL_NUM_EXTENSIONS, &count);
+  for(GLint i = 0; i < count; ++i) {
+    const char* extension = reinterpret_cast<const char*>(glGetStringi(GL_EXTENSIONS, (GLuint)i));
+    if(extension && std::strcmp(extension, name) == 0) return true;
+  }
+  return false;
+}
+
+template<typename Pfn>
+bool load_(GLADloadproc load, const char* name, Pfn& function)
+{
+  function = reinterpret_cast<Pfn>(load(name));
+  return function != nullptr;
+}
+
+} // anonymous namespace
+
+bool loadDirectStateAccess(GLADloadproc load)
+{
+  using namespace detail;
+  loaded_ = false;
+  enabled_ = false;
+  if(!(GLVersion.major > 4 || (GLVersion.major == 4 && GLVersion.minor >= 5))
+      && !hasExtension_("GL_ARB_direct_state_access")) {
+    return false;
+  }
+
+  // Same names in the extension and in 4.5 core
+  bool ok = true;
+  ok &= load_(load, "glCreateBuffers", createBuffers);
+  ok &= load_(load, "glNamedBufferStorage", namedBufferStorage);
+  ok &= load_(load, "glNamedBufferSubData", namedBufferSubData);
+  ok &= load_(load, "glCopyNamedBufferSubData", copyNamedBufferSubData);
+  ok &= load_(load, "glMapNamedBuffer", mapNamedBuffer);
+  ok &= load_(load, "glMapNamedBufferRange", mapNamedBufferRange);
+  ok &= load_(load, "glUnmapNamedBuffer", unmapNamedBuffer);
+  ok &= load_(load, "glFlushMappedNamedBufferRange", flushMappedNamedBufferRange);
+  ok &= load_(load, "glCreateVertexArrays", createVertexArrays);
+  ok &= load_(load, "glVertexArrayVertexBuffer", vertexArrayVertexBuffer);
+  ok &= load_(load, "glVertexArrayElementBuffer", vertexArrayElementBuffer);
+  ok &= load_(load, "glVertexArrayAttribFormat", vertexArrayAttribFormat);
+  ok &= load_(load, "glVertexArrayAttribIFormat", vertexArrayAttribIFormat);
+  ok &= load_(load, "glVertexArrayAttribBinding", vertexArrayAttribBinding);
+  ok &= load_(load, "glEnableVertexArrayAttrib", enableVertexArrayAttrib);
+  loaded_ = ok;
+  enabled_ = ok;
+  return ok;
+}
+
+bool directStateAccess()
+{
+  return enabled_;
+}
+
+void setDirectStateAccess(bool enabled)
+{
+  enabled_ = enabled && loaded_;
+}
+
+} // namespace OglPlayground
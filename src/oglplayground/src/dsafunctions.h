@@ -0,0 +1,46 @@
+#pragma once
+
+#include <glad/glad.h>
+
+// ARB_direct_state_access entry points used by the library. The generated
+// glad loader stops at GL 4.4, loadDirectStateAccess fills these.
+
+namespace OglPlayground
+{
+namespace detail
+{
+
+typedef void (APIENTRYP PfnCreateBuffers)(GLsizei n, GLuint* buffers);
+typedef void (APIENTRYP PfnNamedBufferStorage)(GLuint buffer, GLsizeiptr size, const void* data, GLbitfield flags);
+typedef void (APIENTRYP PfnNamedBufferSubData)(GLuint buffer, GLintptr offset, GLsizeiptr size, const void* data);
+typedef void (APIENTRYP PfnCopyNamedBufferSubData)(GLuint readBuffer, GLuint writeBuffer, GLintptr readOffset, GLintptr writeOffset, GLsizeiptr size);
+typedef void* (APIENTRYP PfnMapNamedBuffer)(GLuint buffer, GLenum access);
+typedef void* (APIENTRYP PfnMapNamedBufferRange)(GLuint buffer, GLintptr offset, GLsizeiptr length, GLbitfield access);
+typedef GLboolean (APIENTRYP PfnUnmapNamedBuffer)(GLuint buffer);
+typedef void (APIENTRYP PfnFlushMappedNamedBufferRange)(GLuint buffer, GLintptr offset, GLsizeiptr length);
+typedef void (APIENTRYP PfnCreateVertexArrays)(GLsizei n, GLuint* arrays);
+typedef void (APIENTRYP PfnVertexArrayVertexBuffer)(GLuint vaobj, GLuint bindingindex, GLuint buffer, GLintptr offset, GLsizei stride);
+typedef void (APIENTRYP PfnVertexArrayElementBuffer)(GLuint vaobj, GLuint buffer);
+typedef void (APIENTRYP PfnVertexArrayAttribFormat)(GLuint vaobj, GLuint attribindex, GLint size, GLenum type, GLboolean normalized, GLuint relativeoffset);
+typedef void (APIENTRYP PfnVertexArrayAttribIFormat)(GLuint vaobj, GLuint attribindex, GLint size, GLenum type, GLuint relativeoffset);
+typedef void (APIENTRYP PfnVertexArrayAttribBinding)(GLuint vaobj, GLuint attribindex, GLuint bindingindex);
+typedef void (APIENTRYP PfnEnableVertexArrayAttrib)(GLuint vaobj, GLuint index);
+
+extern PfnCreateBuffers createBuffers;
+extern PfnNamedBufferStorage namedBufferStorage;
+extern PfnNamedBufferSubData namedBufferSubData;
+extern PfnCopyNamedBufferSubData copyNamedBufferSubData;
+extern PfnMapNamedBuffer mapNamedBuffer;
+extern PfnMapNamedBufferRange mapNamedBufferRange;
+extern PfnUnmapNamedBuffer unmapNamedBuffer;
+extern PfnFlushMappedNamedBufferRange flushMappedNamedBufferRange;
+extern PfnCreateVertexArrays createVertexArrays;
+extern PfnVertexArrayVertexBuffer vertexArrayVertexBuffer;
+extern PfnVertexArrayElementBuffer vertexArrayElementBuffer;
+extern PfnVertexArrayAttribFormat vertexArrayAttribFormat;
+extern PfnVertexArrayAttribIFormat vertexArrayAttribIFormat;
+extern PfnVertexArrayAttribBinding vertexArrayAttribBinding;
+extern PfnEnableVertexArrayAttrib enableVertexArrayAttrib;
+
+} // namespace detail
+} // namespace OglPlayground
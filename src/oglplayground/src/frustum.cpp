@@ -0,0 +1,160 @@
+#include <oglplayground/frustum.h>
+
+#include <cassert>
+
+#include "cullingkernels.h"
+
+namespace OglPlayground
+{
+
+#ifdef OGLPLAYGROUND_AVX2
+// Defined in frustum_avx2.cpp, built with avx2 enabled
+size_t cullBoxesAVX2(const Frustum& frustum, const BoxArrays& boxes, size_t first, size_t count, uint32_t*& visible);
+size_t cullSpheresAVX2(const Frustum& frustum, const SphereArrays& spheres, size_t first, size_t count, uint32_t*& visible);
+size_t cullBoxesMultiAVX2(
+    const Frustum* frustums,
+    size_t frustumCount,
+    const BoxArrays& boxes,
+    size_t first,
+    size_t count,
+    uint32_t*& visible,
+    uint8_t*& masks);
+#endif
+
+Frustum frustumFromMatrix(const glm::mat4& m)
+{
+  // Gribb and Hartmann, combinations of the matrix rows
+  const glm::vec4 row0(m[0][0], m[1][0], m[2][0], m[3][0]);
+  const glm::vec4 row1(m[0][1], m[1][1], m[2][1], m[3][1]);
+  const glm::vec4 row2(m[0][2], m[1][2], m[2][2], m[3][2]);
+  const glm::vec4 row3(m[0][3], m[1][3], m[2][3], m[3][3]);
+
+  Frustum frustum;
+  frustum.planes[Frustum::Left] = row3 + row0;
+  frustum.planes[Frustum::Right] = row3 - row0;
+  frustum.planes[Frustum::Bottom] = row3 + row1;
+  frustum.planes[Frustum::Top] = row3 - row1;
+  frustum.planes[Frustum::Near] = row3 + row2;
+  frustum.planes[Frustum::Far] = row3 - row2;
+  for(glm::vec4& plane : frustum.planes) {
+    plane /= glm::length(glm::vec3(plane));
+  }
+  return frustum;
+}
+
+size_t cullBoxes(
+    const Frustum& frustum,
+    const BoxArrays& boxes,
+    size_t count,
+    uint32_t* visible,
+    SimdLevel level)
+{
+  uint32_t* const begin = visible;
+  size_t done = 0;
+  switch(supportedSimdLevel(level)) {
+#ifdef OGLPLAYGROUND_AVX2
+  case SimdLevel::AVX2:
+    done = cullBoxesAVX2(frustum, boxes, done, count, visible);
+    // fallthrough, the 4 wide kernel handles part of the tail
+#endif
+#ifdef OGLPLAYGROUND_SSE2
+  case SimdLevel::SSE2:
+    done = detail::cullBoxesKernel<detail::Float4>(frustum, boxes, done, count, visible);
+#endif
+  default:
+    break;
+  }
+
+  // Same operations in the same order than the kernels
+  for(size_t i = done; i < count; ++i) {
+    bool outside = false;
+    for(const glm::vec4& plane : frustum.planes) {
+      const float d = plane.x*boxes.centerX[i] + plane.y*boxes.centerY[i] + plane.z*boxes.centerZ[i] + plane.w;
+      const float r = glm::abs(plane.x)*boxes.extentX[i] + glm::abs(plane.y)*boxes.extentY[i] + glm::abs(plane.z)*boxes.extentZ[i];
+      outside |= d + r < 0.f;
+    }
+    if(!outside) *visible++ = (uint32_t)i;
+  }
+  return visible - begin;
+}
+
+size_t cullSpheres(
+    const Frustum& frustum,
+    const SphereArrays& spheres,
+    size_t count,
+    uint32_t* visible,
+    SimdLevel level)
+{
+  uint32_t* const begin = visible;
+  size_t done = 0;
+  switch(supportedSimdLevel(level)) {
+#ifdef OGLPLAYGROUND_AVX2
+  case SimdLevel::AVX2:
+    done = cullSpheresAVX2(frustum, spheres, done, count, visible);
+    // fallthrough, the 4 wide kernel handles part of the tail
+#endif
+#ifdef OGLPLAYGROUND_SSE2
+  case SimdLevel::SSE2:
+    done = detail::cullSpheresKernel<detail::Float4>(frustum, spheres, done, count, visible);
+#endif
+  default:
+    break;
+  }
+
+  for(size_t i = done; i < count; ++i) {
+    bool outside = false;
+    for(const glm::vec4& plane : frustum.planes) {
+      const float d = plane.x*spheres.centerX[i] + plane.y*spheres.centerY[i] + plane.z*spheres.centerZ[i] + plane.w;
+      outside |= d + spheres.radius[i] < 0.f;
+    }
+    if(!outside) *visible++ = (uint32_t)i;
+  }
+  return visible - begin;
+}
+
+size_t cullBoxesMulti(
+    const Frustum* frustums,
+    size_t frustumCount,
+    const BoxArrays& boxes,
+    size_t count,
+    uint32_t* visible,
+    uint8_t* masks,
+    SimdLevel level)
+{
+  assert(frustumCount <= 8);
+  uint32_t* const begin = visible;
+  size_t done = 0;
+  switch(supportedSimdLevel(level)) {
+#ifdef OGLPLAYGROUND_AVX2
+  case SimdLevel::AVX2:
+    done = cullBoxesMultiAVX2(frustums, frustumCount, boxes, done, count, visible, masks);
+    // fallthrough, the 4 wide kernel handles part of the tail
+#endif
+#ifdef OGLPLAYGROUND_SSE2
+  case SimdLevel::SSE2:
+    done = detail::cullBoxesMultiKernel<detail::Float4>(frustums, frustumCount, boxes, done, count, visible, masks);
+#endif
+  default:
+    break;
+  }
+
+  for(size_t i = done; i < count; ++i) {
+    uint32_t mask = 0;
+    for(size_t f = 0; f < frustumCount; ++f) {
+      bool outside = false;
+      for(const glm::vec4& plane : frustums[f].planes) {
+        const float d = plane.x*boxes.centerX[i] + plane.y*boxes.centerY[i] + plane.z*boxes.centerZ[i] + plane.w;
+        const float r = glm::abs(plane.x)*boxes.extentX[i] + glm::abs(plane.y)*boxes.extentY[i] + glm::abs(plane.z)*boxes.extentZ[i];
+        outside |= d + r < 0.f;
+      }
+      if(!outside) mask |= 1u << f;
+    }
+    if(mask != 0) {
+      *visible++ = (uint32_t)i;
+      *masks++ = (uint8_t)mask;
+    }
+  }
+  return visible - begin;
+}
+
+} // namespace OglPlayground
@@ -0,0 +1,34 @@
+#include <oglplayground/frustum.h>
+
+#if defined(OGLPLAYGROUND_AVX2) && defined(__AVX2__)
+
+#include "cullingkernels.h"
+
+namespace OglPlayground
+{
+
+size_t cullBoxesAVX2(const Frustum& frustum, const BoxArrays& boxes, size_t first, size_t count, uint32_t*& visible)
+{
+  return detail::cullBoxesKernel<detail::Float8>(frustum, boxes, first, count, visible);
+}
+
+size_t cullSpheresAVX2(const Frustum& frustum, const SphereArrays& spheres, size_t first, size_t count, uint32_t*& visible)
+{
+  return detail::cullSpheresKernel<detail::Float8>(frustum, spheres, first, count, visible);
+}
+
+size_t cullBoxesMultiAVX2(
+    const Frustum* frustums,
+    size_t frustumCount,
+    const BoxArrays& boxes,
+    size_t first,
+    size_t count,
+    uint32_t*& visible,
+    uint8_t*& masks)
+{
+  return detail::cullBoxesMultiKernel<detail::Float8>(frustums, frustumCount, boxes, first, count, visible, masks);
+}
+
+} // namespace OglPlayground
+
+#endif
@@ -1,76 +1,362 @@
 #include <oglplayground/geometry.h>
+#include <oglplayground/bufferarena.h>
+#include <oglplayground/directstateaccess.h>
+#include <oglplayground/gpumemory.h>
+#include <oglplayground/uploadqueue.h>
 
 #include <algorithm>
 #include <cassert>
+#include <cstring>
+#include <utility>
+
+#include "dsafunctions.h"
 
 namespace OglPlayground
 {
 
+GLenum attributeGLType(AttributeType type)
+{
+  switch(type) {
+  case AttributeType::Float: return GL_FLOAT;
+  case AttributeType::Half: return GL_HALF_FLOAT;
+  case AttributeType::Int8: return GL_BYTE;
+  case AttributeType::UInt8: return GL_UNSIGNED_BYTE;
+  case AttributeType::Int16: return GL_SHORT;
+  case AttributeType::UInt16: return GL_UNSIGNED_SHORT;
+  case AttributeType::Int32: return GL_INT;
+  case AttributeType::UInt32: return GL_UNSIGNED_INT;
+  case AttributeType::Int2101010: return GL_INT_2_10_10_10_REV;
+  }
+  assert(false);
+  return GL_FLOAT;
+}
+
+size_t attributeSize(const VertexAttribute& attribute)
+{
+  size_t componentSize = 4;
+  switch(attribute.type) {
+  case AttributeType::Int2101010: return 4;
+  case AttributeType::Int8:
+  case AttributeType::UInt8: componentSize = 1; break;
+  case AttributeType::Half:
+  case AttributeType::Int16:
+  case AttributeType::UInt16: componentSize = 2; break;
+  default: break;
+  }
+  return (attribute.nbComponents*componentSize + 3) & ~size_t(3);
+}
+
 size_t strideFromVertexDesc(const VertexDesc& desc)
 {
-  const size_t floatSize = sizeof(float);
   size_t stride = 0;
   for(const auto& attribDesc : desc) {
-    stride += attribDesc.nbComponents * floatSize;
+    stride += attributeSize(attribDesc);
   }
   return stride;
 }
 
+size_t offsetFromVertexDesc(const VertexDesc& desc, AttributeUsage usage)
+{
+  size_t offset = 0;
+  for(const auto& attribDesc : desc) {
+    if(attribDesc.usage == usage) break;
+    offset += attributeSize(attribDesc);
+  }
+  return offset;
+}
+
+const VertexAttribute* findAttribute(const VertexDesc& desc, AttributeUsage usage)
+{
+  for(const auto& attribDesc : desc) {
+    if(attribDesc.usage == usage) return &attribDesc;
+  }
+  return nullptr;
+}
+
+GLenum indexGLType(IndexType type)
+{
+  switch(type) {
+  case IndexType::UInt8: return GL_UNSIGNED_BYTE;
+  case IndexType::UInt16: return GL_UNSIGNED_SHORT;
+  case IndexType::UInt32: return GL_UNSIGNED_INT;
+  }
+  assert(false);
+  return GL_UNSIGNED_INT;
+}
+
+size_t indexSize(IndexType type)
+{
+  switch(type) {
+  case IndexType::UInt8: return 1;
+  case IndexType::UInt16: return 2;
+  case IndexType::UInt32: return 4;
+  }
+  assert(false);
+  return 4;
+}
+
+IndexType indexTypeFromVertexCount(size_t verticesCount, IndexType smallest)
+{
+  // No primitive restart, so the largest value is a valid index
+  IndexType type = IndexType::UInt32;
+  if(verticesCount <= 0x10000) type = IndexType::UInt16;
+  if(verticesCount <= 0x100) type = IndexType::UInt8;
+  return std::max(type, smallest);
+}
+
+void narrowIndices(const uint32_t* src, size_t count, IndexType type, void* dst)
+{
+  switch(type) {
+  case IndexType::UInt8: {
+    uint8_t* out = static_cast<uint8_t*>(dst);
+    for(size_t i = 0; i < count; ++i) {
+      assert(src[i] <= 0xff);
+      out[i] = (uint8_t)src[i];
+    }
+    break;
+  }
+  case IndexType::UInt16: {
+    uint16_t* out = static_cast<uint16_t*>(dst);
+    for(size_t i = 0; i < count; ++i) {
+      assert(src[i] <= 0xffff);
+      out[i] = (uint16_t)src[i];
+    }
+    break;
+  }
+  case IndexType::UInt32:
+    std::memcpy(dst, src, count*sizeof(uint32_t));
+    break;
+  }
+}
+
 Geometry::Geometry(
-    const float* vertices,
+    const void* vertices,
     size_t verticesCount,
     const uint32_t* indices,
     size_t indicesCount,
-    const VertexDesc& desc)
-    : vertices_(
+    const VertexDesc& desc,
+    IndexType smallestIndexType)
+    : indexType_(indexTypeFromVertexCount(verticesCount, smallestIndexType))
+    , vertices_(
           GL_ARRAY_BUFFER,
           verticesCount*strideFromVertexDesc(desc),
           vertices,
           GL_STATIC_DRAW)
     , indices_(
         GL_ELEMENT_ARRAY_BUFFER,
-        indicesCount*sizeof(uint32_t),
-        indices,
+        indicesCount*indexSize(indexType_),
+        indexType_ == IndexType::UInt32 ? indices : nullptr,
         GL_STATIC_DRAW)
     , verticesCount_(verticesCount)
     , indicesCount_(indicesCount)
     , desc_(desc)
 {
+  if(!indices || indexType_ == IndexType::UInt32) return;
+  std::vector<uint8_t> narrowed(indices_.size());
+  narrowIndices(indices, indicesCount, indexType_, narrowed.data());
+  indices_.upload(0, narrowed.size(), narrowed.data());
+}
+
+Geometry::Geometry(
+    UploadQueue& queue,
+    const void* vertices,
+    size_t verticesCount,
+    const uint32_t* indices,
+    size_t indicesCount,
+    const VertexDesc& desc,
+    IndexType smallestIndexType)
+    : Geometry(nullptr, verticesCount, nullptr, indicesCount, desc, smallestIndexType)
+{
+  queue.uploadBuffer(vertices_, 0, vertices, vertices_.size());
+  if(indexType_ == IndexType::UInt32) {
+    queue.uploadBuffer(indices_, 0, indices, indices_.size());
+    return;
+  }
+  // The queue copies the data right away
+  std::vector<uint8_t> narrowed(indices_.size());
+  narrowIndices(indices, indicesCount, indexType_, narrowed.data());
+  queue.uploadBuffer(indices_, 0, narrowed.data(), narrowed.size());
+}
+
+Geometry::Geometry(
+    BufferArena& arena,
+    const void* vertices,
+    size_t verticesCount,
+    const uint32_t* indices,
+    size_t indicesCount)
+    : indexType_(arena.indexType())
+    , arena_(&arena)
+    , vertexAllocation_(arena.allocateVertices(vertices, (uint32_t)verticesCount))
+    , indexAllocation_(arena.allocateIndices(indices, (uint32_t)indicesCount))
+    , verticesCount_(verticesCount)
+    , indicesCount_(indicesCount)
+    , desc_(arena.desc())
+{
+  assert(indexTypeFromVertexCount(verticesCount, IndexType::UInt8) <= indexType_);
+  if(vertexAllocation_ != ArenaAllocator::invalid && indexAllocation_ != ArenaAllocator::invalid) return;
+
+  // Arena full, give back the range that fit
+  if(vertexAllocation_ != ArenaAllocator::invalid) arena.freeVertices(vertexAllocation_);
+  if(indexAllocation_ != ArenaAllocator::invalid) arena.freeIndices(indexAllocation_);
+  vertexAllocation_ = ArenaAllocator::invalid;
+  indexAllocation_ = ArenaAllocator::invalid;
+}
+
+Geometry::Geometry(Geometry&& other) noexcept
+    : indexType_(other.indexType_)
+    , vertices_(std::move(other.vertices_))
+    , indices_(std::move(other.indices_))
+    , arena_(other.arena_)
+    , vertexAllocation_(other.vertexAllocation_)
+    , indexAllocation_(other.indexAllocation_)
+    , verticesCount_(other.verticesCount_)
+    , indicesCount_(other.indicesCount_)
+    , desc_(std::move(other.desc_))
+{
+  other.arena_ = nullptr;
+  other.verticesCount_ = 0;
+  other.indicesCount_ = 0;
+}
+
+Geometry& Geometry::operator=(Geometry&& other) noexcept
+{
+  if(this == &other) return *this;
+  release();
+  indexType_ = other.indexType_;
+  vertices_ = std::move(other.vertices_);
+  indices_ = std::move(other.indices_);
+  arena_ = other.arena_;
+  vertexAllocation_ = other.vertexAllocation_;
+  indexAllocation_ = other.indexAllocation_;
+  verticesCount_ = other.verticesCount_;
+  indicesCount_ = other.indicesCount_;
+  desc_ = std::move(other.desc_);
+  other.arena_ = nullptr;
+  other.verticesCount_ = 0;
+  other.indicesCount_ = 0;
+  return *this;
+}
+
+Geometry::~Geometry()
+{
+  release();
+}
+
+void Geometry::release()
+{
+  if(!arena_) return;
+  if(vertexAllocation_ != ArenaAllocator::invalid) arena_->freeVertices(vertexAllocation_);
+  if(indexAllocation_ != ArenaAllocator::invalid) arena_->freeIndices(indexAllocation_);
+  arena_ = nullptr;
+}
+
+bool Geometry::isValid() const
+{
+  return !arena_ || (vertexAllocation_ != ArenaAllocator::invalid && indexAllocation_ != ArenaAllocator::invalid);
 }
 
-GeometryBinder::GeometryBinder(const Geometry* geometry, AttributeBindDesc desc) : geometry_(geometry)
+BufferArena* Geometry::arena() const
 {
-  assert(geometry_ != nullptr);
-      
-  glGenVertexArrays(1, &vao_);
-  bind();
-  geometry_->vertices_.bind();
-  geometry_->indices_.bind();
+  return arena_;
+}
+
+IndexType Geometry::indexType() const
+{
+  return indexType_;
+}
+
+const BufferObject& Geometry::vertexBuffer() const
+{
+  return arena_ ? arena_->vertexBuffer() : vertices_;
+}
+
+const BufferObject& Geometry::indexBuffer() const
+{
+  return arena_ ? arena_->indexBuffer() : indices_;
+}
+
+GeometryBinder::GeometryBinder(const Geometry& geometry, AttributeBindDesc desc)
+    : vertexBuffer_(geometry.vertexBuffer().name())
+{
+  // Set up by name without touching the bindings, or bind everything
+  const bool dsa = directStateAccess();
+  const size_t stride = strideFromVertexDesc(geometry.desc_);
+  trackGpuAllocation(GpuResource::VertexArray, 0);
+  if(dsa) {
+    detail::createVertexArrays(1, &vao_);
+    detail::vertexArrayVertexBuffer(vao_, 0, geometry.vertexBuffer().name(), 0, (GLsizei)stride);
+    detail::vertexArrayElementBuffer(vao_, geometry.indexBuffer().name());
+  } else {
+    glGenVertexArrays(1, &vao_);
+    bind();
+    geometry.vertexBuffer().bind();
+    geometry.indexBuffer().bind();
+  }
 
   std::sort(
       desc.begin(),
       desc.end(),
       [](const auto& a, const auto& b) { return a.usage < b.usage;});
 
-  const size_t stride = strideFromVertexDesc(geometry->desc_);
   size_t offset = 0;
-  for(const auto& attribDesc : geometry->desc_) {
+  for(const auto& attribDesc : geometry.desc_) {
     auto it = std::lower_bound(
         desc.begin(),
         desc.end(),
         attribDesc.usage,
         [](const auto& a, const auto &b) {return a.usage < b;});
-    assert(it != desc.end());
-    if(it == desc.end()) continue;
-    const size_t index = it->index;
-    glVertexAttribPointer((GLuint)index, (GLint)attribDesc.nbComponents, GL_FLOAT, GL_FALSE, (GLsizei)stride, (GLvoid*)offset);
-    glEnableVertexAttribArray((GLuint)index);
-    offset+=attribDesc.nbComponents*sizeof(float);
+    // Skipped attributes still take their place in the vertex
+    const size_t attribOffset = offset;
+    offset += attributeSize(attribDesc);
+    if(it == desc.end() || it->usage != attribDesc.usage) continue;
+
+    const GLuint index = (GLuint)it->index;
+    const GLint size = (GLint)attribDesc.nbComponents;
+    const GLenum type = attributeGLType(attribDesc.type);
+    const bool integer = attribDesc.mode == AttributeMode::Integer;
+    const GLboolean normalized = attribDesc.mode == AttributeMode::Normalized ? GL_TRUE : GL_FALSE;
+    assert(!integer || (attribDesc.type != AttributeType::Float && attribDesc.type != AttributeType::Half));
+    assert(attribDesc.type != AttributeType::Int2101010 || (size == 4 && !integer));
+    if(dsa) {
+      if(integer) detail::vertexArrayAttribIFormat(vao_, index, size, type, (GLuint)attribOffset);
+      else detail::vertexArrayAttribFormat(vao_, index, size, type, normalized, (GLuint)attribOffset);
+      detail::vertexArrayAttribBinding(vao_, index, 0);
+      detail::enableVertexArrayAttrib(vao_, index);
+    } else {
+      if(integer) glVertexAttribIPointer(index, size, type, (GLsizei)stride, (GLvoid*)attribOffset);
+      else glVertexAttribPointer(index, size, type, normalized, (GLsizei)stride, (GLvoid*)attribOffset);
+      glEnableVertexAttribArray(index);
+    }
   }
-  
+  if(dsa) return;
+
   unbind();
-  geometry->vertices_.unbind();
-  geometry->indices_.unbind();
+  geometry.vertexBuffer().unbind();
+  geometry.indexBuffer().unbind();
+}
+
+GeometryBinder::GeometryBinder(GeometryBinder&& other) noexcept
+    : vao_(other.vao_)
+    , vertexBuffer_(other.vertexBuffer_)
+{
+  other.vao_ = 0;
+}
+
+GeometryBinder& GeometryBinder::operator=(GeometryBinder&& other) noexcept
+{
+  if(this == &other) return *this;
+  if(vao_) trackGpuFree(GpuResource::VertexArray, 0);
+  glDeleteVertexArrays(1, &vao_);
+  vao_ = other.vao_;
+  vertexBuffer_ = other.vertexBuffer_;
+  other.vao_ = 0;
+  return *this;
+}
+
+GeometryBinder::~GeometryBinder()
+{
+  if(vao_) trackGpuFree(GpuResource::VertexArray, 0);
+  glDeleteVertexArrays(1, &vao_);
 }
 
 void GeometryBinder::bind() const
@@ -78,9 +364,22 @@ void GeometryBinder::bind() const
   glBindVertexArray(vao_);
 }
 
-void GeometryBinder::draw() const
+void GeometryBinder::draw(const Geometry& geometry) const
 {
-  glDrawElements(GL_TRIANGLES, (GLsizei)geometry_->indicesCount_, GL_UNSIGNED_INT, 0);
+  assert(geometry.vertexBuffer().name() == vertexBuffer_);
+  if(!geometry.isValid()) return;
+  const GLenum indexType = indexGLType(geometry.indexType_);
+  if(!geometry.arena_) {
+    glDrawElements(GL_TRIANGLES, (GLsizei)geometry.indicesCount_, indexType, 0);
+    return;
+  }
+  const size_t indexOffset = geometry.arena_->indexOffset(geometry.indexAllocation_);
+  glDrawElementsBaseVertex(
+      GL_TRIANGLES,
+      (GLsizei)geometry.indicesCount_,
+      indexType,
+      (GLvoid*)(indexOffset*indexSize(geometry.indexType_)),
+      (GLint)geometry.arena_->vertexOffset(geometry.vertexAllocation_));
 }
 
 void GeometryBinder::unbind() const
@@ -0,0 +1,139 @@
+#include <oglplayground/gpumemory.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+
+namespace OglPlayground
+{
+namespace
+{
+
+struct Counters_
+{
+  std::atomic<int64_t> objects{0};
+  std::atomic<int64_t> bytes{0};
+  std::atomic<int64_t> peakBytes{0};
+};
+
+Counters_ resources_[size_t(GpuResource::Count)];
+Counters_ total_;
+std::atomic<int64_t> allocatedBytes_{0};
+std::atomic<int64_t> freedBytes_{0};
+std::atomic<uint64_t> frame_{0};
+
+void raisePeak_(std::atomic<int64_t>& peak, int64_t value)
+{
+  int64_t current = peak.load(std::memory_order_relaxed);
+  while(current < value && !peak.compare_exchange_weak(current, value, std::memory_order_relaxed)) {}
+}
+
+Counters_& counters_(GpuResource resource)
+{
+  assert(resource < GpuResource::Count);
+  return resources_[size_t(resource)];
+}
+
+} // anonymous namespace
+
+void trackGpuAllocation(GpuResource resource, size_t bytes)
+{
+  Counters_& counters = counters_(resource);
+  counters.objects.fetch_add(1, std::memory_order_relaxed);
+  raisePeak_(counters.peakBytes, counters.bytes.fetch_add(bytes, std::memory_order_relaxed) + (int64_t)bytes);
+  total_.objects.fetch_add(1, std::memory_order_relaxed);
+  raisePeak_(total_.peakBytes, total_.bytes.fetch_add(bytes, std::memory_order_relaxed) + (int64_t)bytes);
+  allocatedBytes_.fetch_add(bytes, std::memory_order_relaxed);
+}
+
+void trackGpuFree(GpuResource resource, size_t bytes)
+{
+  Counters_& counters = counters_(resource);
+  counters.objects.fetch_sub(1, std::memory_order_relaxed);
+  counters.bytes.fetch_sub(bytes, std::memory_order_relaxed);
+  total_.objects.fetch_sub(1, std::memory_order_relaxed);
+  total_.bytes.fetch_sub(bytes, std::memory_order_relaxed);
+  freedBytes_.fetch_add(bytes, std::memory_order_relaxed);
+}
+
+GpuResource gpuResourceFromTarget(GLenum target)
+{
+  switch(target) {
+  case GL_ARRAY_BUFFER: return GpuResource::VertexBuffer;
+  case GL_ELEMENT_ARRAY_BUFFER: return GpuResource::IndexBuffer;
+  case GL_PIXEL_UNPACK_BUFFER: return GpuResource::PixelUnpackBuffer;
+  case GL_UNIFORM_BUFFER: return GpuResource::UniformBuffer;
+  case GL_SHADER_STORAGE_BUFFER: return GpuResource::StorageBuffer;
+  default: return GpuResource::OtherBuffer;
+  }
+}
+
+size_t texture2DBytes(size_t width, size_t height, size_t bytesPerPixel, bool mipmaps)
+{
+  size_t bytes = width * height * bytesPerPixel;
+  while(mipmaps && (width > 1 || height > 1)) {
+    width = std::max<size_t>(width / 2, 1);
+    height = std::max<size_t>(height / 2, 1);
+    bytes += width * height * bytesPerPixel;
+  }
+  return bytes;
+}
+
+const char* gpuResourceName(GpuResource resource)
+{
+  switch(resource) {
+  case GpuResource::VertexBuffer: return "vertex";
+  case GpuResource::IndexBuffer: return "index";
+  case GpuResource::PixelUnpackBuffer: return "pixel unpack";
+  case GpuResource::UniformBuffer: return "uniform";
+  case GpuResource::StorageBuffer: return "storage";
+  case GpuResource::OtherBuffer: return "other buffer";
+  case GpuResource::Texture: return "texture";
+  case GpuResource::VertexArray: return "vertex array";
+  default: return "unknown";
+  }
+}
+
+GpuResourceStats gpuResourceStats(GpuResource resource)
+{
+  const Counters_& counters = counters_(resource);
+  return {
+    counters.objects.load(std::memory_order_relaxed),
+    counters.bytes.load(std::memory_order_relaxed),
+    counters.peakBytes.load(std::memory_order_relaxed)};
+}
+
+GpuMemorySnapshot gpuMemorySnapshot()
+{
+  GpuMemorySnapshot snapshot;
+  snapshot.frame = frame_.load(std::memory_order_relaxed);
+  for(size_t i = 0; i < size_t(GpuResource::Count); ++i) {
+    snapshot.resources[i] = gpuResourceStats(GpuResource(i));
+  }
+  snapshot.bytes = total_.bytes.load(std::memory_order_relaxed);
+  snapshot.peakBytes = total_.peakBytes.load(std::memory_order_relaxed);
+  snapshot.allocatedBytes = allocatedBytes_.load(std::memory_order_relaxed);
+  snapshot.freedBytes = freedBytes_.load(std::memory_order_relaxed);
+  return snapshot;
+}
+
+GpuMemorySnapshot endGpuMemoryFrame()
+{
+  GpuMemorySnapshot snapshot = gpuMemorySnapshot();
+  // Counts from other threads between the snapshot and the reset go to the
+  // next frame
+  snapshot.allocatedBytes = allocatedBytes_.exchange(0, std::memory_order_relaxed);
+  snapshot.freedBytes = freedBytes_.exchange(0, std::memory_order_relaxed);
+  frame_.fetch_add(1, std::memory_order_relaxed);
+  return snapshot;
+}
+
+void resetGpuMemoryPeaks()
+{
+  for(auto& counters : resources_) {
+    counters.peakBytes.store(counters.bytes.load(std::memory_order_relaxed), std::memory_order_relaxed);
+  }
+  total_.peakBytes.store(total_.bytes.load(std::memory_order_relaxed), std::memory_order_relaxed);
+}
+
+} // namespace OglPlayground
@@ -0,0 +1,306 @@
+#include <oglplayground/lightgrid.h>
+#include <oglplayground/threadpool.h>
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+
+namespace OglPlayground
+{
+namespace
+{
+
+// Lights bounded by one task
+const size_t boundGrainSize_ = 256;
+
+// Squared distance from the sphere center to the box, against its radius
+bool sphereIntersectsBox_(const glm::vec3& center, float radius, const glm::vec3& lo, const glm::vec3& hi)
+{
+  const glm::vec3 d = glm::max(glm::vec3(0.f), glm::max(lo - center, center - hi));
+  return glm::dot(d, d) <= radius*radius;
+}
+
+// Cone against a sphere bounding the cluster, conservative
+bool coneIntersectsSphere_(
+    const glm::vec3& apex,
+    const glm::vec3& direction,
+    float range,
+    float cosAngle,
+    float sinAngle,
+    const glm::vec3& center,
+    float radius)
+{
+  const glm::vec3 v = center - apex;
+  const float along = glm::dot(v, direction);
+  const float across = std::sqrt(std::max(0.f, glm::dot(v, v) - along*along));
+  const float distance = cosAngle*across - sinAngle*along;
+  return distance <= radius && along <= radius + range && along >= -radius;
+}
+
+// Tile containing a normalized device coordinate, clamped to the grid
+uint32_t tileFromNdc_(float ndc, uint32_t tiles)
+{
+  const float tile = std::floor((ndc + 1.f) * 0.5f * float(tiles));
+  return uint32_t(std::min(std::max(tile, 0.f), float(tiles-1)));
+}
+
+} // anonymous namespace
+
+const char* const lightGridGlsl = R"(
+#ifndef LIGHT_CLUSTER_BINDING
+#define LIGHT_CLUSTER_BINDING 2
+#endif
+#ifndef LIGHT_INDEX_BINDING
+#define LIGHT_INDEX_BINDING 3
+#endif
+layout(std430, binding = LIGHT_CLUSTER_BINDING) readonly buffer LightClusters
+{
+  uvec2 lightClusters[];
+};
+layout(std430, binding = LIGHT_INDEX_BINDING) readonly buffer LightIndices
+{
+  uint lightIndices[];
+};
+uniform uvec3 lightGridSize;
+uniform vec2 lightGridDepth;
+
+uvec2 lightCluster(vec2 screenUv, float viewDepth)
+{
+  uvec2 tile = min(uvec2(max(screenUv, vec2(0.0)) * vec2(lightGridSize.xy)), lightGridSize.xy - 1u);
+  float slice = log(max(viewDepth, 1e-6)) * lightGridDepth.x + lightGridDepth.y;
+  uint z = uint(clamp(slice, 0.0, float(lightGridSize.z - 1u)));
+  return lightClusters[(z * lightGridSize.y + tile.y) * lightGridSize.x + tile.x];
+}
+)";
+
+//! View space light with the clusters it may touch
+struct LightGrid::LightBounds
+{
+  glm::vec3 position;
+  float radius;
+  glm::vec3 direction;
+  float cosAngle; // Spots narrower than a half sphere only
+  float sinAngle;
+  bool spot;
+  uint32_t minX, maxX;
+  uint32_t minY, maxY;
+  uint32_t firstSlice, lastSlice; // Empty when first > last
+};
+
+LightGrid::LightGrid(uint32_t tilesX, uint32_t tilesY, uint32_t slices)
+    : tilesX_(tilesX)
+    , tilesY_(tilesY)
+    , slices_(slices)
+    , view_(1.f)
+    , projectionScale_(1.f)
+    , rowLights_(size_t(slices)*tilesY)
+    , rowIndices_(size_t(slices)*tilesY)
+    , rowOffsets_(size_t(slices)*tilesY)
+    , clusters_(size_t(tilesX)*tilesY*slices, ClusterRange{0, 0})
+{
+  assert(tilesX > 0 && tilesY > 0 && slices > 0);
+}
+
+LightGrid::~LightGrid()
+{
+}
+
+uint32_t LightGrid::tilesX() const
+{
+  return tilesX_;
+}
+
+uint32_t LightGrid::tilesY() const
+{
+  return tilesY_;
+}
+
+uint32_t LightGrid::slices() const
+{
+  return slices_;
+}
+
+uint32_t LightGrid::clusterCount() const
+{
+  return tilesX_*tilesY_*slices_;
+}
+
+void LightGrid::build(const Camera& camera, const ClusterLight* lights, size_t count)
+{
+  setup(camera, count);
+  boundLights(lights, 0, count);
+  binLights();
+  assignRows(0, slices_*tilesY_);
+  offsetRows();
+  packRows(0, slices_*tilesY_);
+}
+
+void LightGrid::build(ThreadPool& pool, const Camera& camera, const ClusterLight* lights, size_t count)
+{
+  // Rows write their own clusters and index list, binning the lights to rows
+  // and the offsets are the only sequential steps
+  setup(camera, count);
+  pool.parallelFor(count, boundGrainSize_, [this, lights](size_t begin, size_t end) {
+    boundLights(lights, begin, end);
+  });
+  binLights();
+  pool.parallelFor(slices_*tilesY_, 1, [this](size_t begin, size_t end) {
+    assignRows((uint32_t)begin, (uint32_t)end);
+  });
+  offsetRows();
+  pool.parallelFor(slices_*tilesY_, tilesY_, [this](size_t begin, size_t end) {
+    packRows((uint32_t)begin, (uint32_t)end);
+  });
+}
+
+const std::vector<ClusterRange>& LightGrid::clusters() const
+{
+  return clusters_;
+}
+
+const std::vector<uint32_t>& LightGrid::lightIndices() const
+{
+  return lightIndices_;
+}
+
+uint32_t LightGrid::clusterIndex(uint32_t x, uint32_t y, uint32_t slice) const
+{
+  assert(x < tilesX_ && y < tilesY_ && slice < slices_);
+  return (slice*tilesY_ + y)*tilesX_ + x;
+}
+
+uint32_t LightGrid::sliceFromDepth(float viewDepth) const
+{
+  const float slice = std::floor(std::log(std::max(viewDepth, near_)) * depthScale_ + depthBias_);
+  return uint32_t(std::min(std::max(slice, 0.f), float(slices_-1)));
+}
+
+glm::vec2 LightGrid::depthScaleBias() const
+{
+  return glm::vec2(depthScale_, depthBias_);
+}
+
+void LightGrid::setup(const Camera& camera, size_t lightCount)
+{
+  const glm::mat4& projection = camera.projection();
+  view_ = camera.view();
+  projectionScale_ = glm::vec2(projection[0][0], projection[1][1]);
+  near_ = camera.nearPlane();
+  far_ = camera.farPlane();
+  assert(near_ > 0.f && far_ > near_);
+  depthScale_ = float(slices_) / std::log(far_ / near_);
+  depthBias_ = -std::log(near_) * depthScale_;
+  bounds_.resize(lightCount);
+}
+
+void LightGrid::boundLights(const ClusterLight* lights, size_t first, size_t last)
+{
+  for(size_t i = first; i < last; ++i) {
+    const ClusterLight& light = lights[i];
+    LightBounds& b = bounds_[i];
+    b.position = glm::vec3(view_ * glm::vec4(light.position, 1.f));
+    b.radius = light.radius;
+    b.direction = glm::normalize(glm::mat3(view_) * light.direction);
+    b.spot = light.spotAngle < 0.5f * 3.14159265f;
+    b.cosAngle = std::cos(light.spotAngle);
+    b.sinAngle = std::sin(light.spotAngle);
+    b.firstSlice = 1;
+    b.lastSlice = 0;
+
+    // Depth range clipped to the frustum, then the screen rectangle of the
+    // bounding box over that range
+    const float zMin = std::max(b.position.z - b.radius, near_);
+    const float zMax = std::min(b.position.z + b.radius, far_);
+    if(zMin > zMax) continue;
+    const glm::vec2 lo = glm::vec2(b.position.x, b.position.y) - b.radius;
+    const glm::vec2 hi = glm::vec2(b.position.x, b.position.y) + b.radius;
+    const glm::vec2 ndcMin = glm::min(lo / zMin, lo / zMax) * projectionScale_;
+    const glm::vec2 ndcMax = glm::max(hi / zMin, hi / zMax) * projectionScale_;
+    if(ndcMax.x < -1.f || ndcMax.y < -1.f || ndcMin.x > 1.f || ndcMin.y > 1.f) continue;
+
+    b.minX = tileFromNdc_(ndcMin.x, tilesX_);
+    b.maxX = tileFromNdc_(ndcMax.x, tilesX_);
+    b.minY = tileFromNdc_(ndcMin.y, tilesY_);
+    b.maxY = tileFromNdc_(ndcMax.y, tilesY_);
+    b.firstSlice = sliceFromDepth(zMin);
+    b.lastSlice = sliceFromDepth(zMax);
+  }
+}
+
+void LightGrid::binLights()
+{
+  for(auto& lights : rowLights_) lights.clear();
+  for(uint32_t i = 0; i < (uint32_t)bounds_.size(); ++i) {
+    const LightBounds& b = bounds_[i];
+    for(uint32_t slice = b.firstSlice; slice <= b.lastSlice; ++slice) {
+      for(uint32_t y = b.minY; y <= b.maxY; ++y) {
+        rowLights_[slice*tilesY_ + y].push_back(i);
+      }
+    }
+  }
+}
+
+void LightGrid::assignRows(uint32_t firstRow, uint32_t lastRow)
+{
+  for(uint32_t row = firstRow; row < lastRow; ++row) {
+    const uint32_t slice = row / tilesY_;
+    const uint32_t y = row % tilesY_;
+    std::vector<uint32_t>& indices = rowIndices_[row];
+    indices.clear();
+
+    // View space box of each cluster, the tile corners at both slice depths
+    const float zNear = near_ * std::pow(far_ / near_, float(slice) / float(slices_));
+    const float zFar = near_ * std::pow(far_ / near_, float(slice+1) / float(slices_));
+    const float v0 = -1.f + 2.f * float(y) / float(tilesY_);
+    const float v1 = -1.f + 2.f * float(y+1) / float(tilesY_);
+    for(uint32_t x = 0; x < tilesX_; ++x) {
+      const float u0 = -1.f + 2.f * float(x) / float(tilesX_);
+      const float u1 = -1.f + 2.f * float(x+1) / float(tilesX_);
+      const glm::vec3 lo(
+          std::min(u0*zNear, u0*zFar) / projectionScale_.x,
+          std::min(v0*zNear, v0*zFar) / projectionScale_.y,
+          zNear);
+      const glm::vec3 hi(
+          std::max(u1*zNear, u1*zFar) / projectionScale_.x,
+          std::max(v1*zNear, v1*zFar) / projectionScale_.y,
+          zFar);
+      const glm::vec3 center = (lo + hi) * 0.5f;
+      const float clusterRadius = glm::length(hi - center);
+
+      ClusterRange& range = clusters_[(slice*tilesY_ + y)*tilesX_ + x];
+      range.offset = (uint32_t)indices.size();
+      for(uint32_t i : rowLights_[row]) {
+        const LightBounds& b = bounds_[i];
+        if(x < b.minX || x > b.maxX) continue;
+        if(!sphereIntersectsBox_(b.position, b.radius, lo, hi)) continue;
+        if(b.spot && !coneIntersectsSphere_(
+            b.position, b.direction, b.radius, b.cosAngle, b.sinAngle, center, clusterRadius)) continue;
+        indices.push_back(i);
+      }
+      range.count = (uint32_t)indices.size() - range.offset;
+    }
+  }
+}
+
+void LightGrid::offsetRows()
+{
+  uint32_t offset = 0;
+  for(size_t row = 0; row < rowIndices_.size(); ++row) {
+    rowOffsets_[row] = offset;
+    offset += (uint32_t)rowIndices_[row].size();
+  }
+  lightIndices_.resize(offset);
+}
+
+void LightGrid::packRows(uint32_t firstRow, uint32_t lastRow)
+{
+  for(uint32_t row = firstRow; row < lastRow; ++row) {
+    const std::vector<uint32_t>& indices = rowIndices_[row];
+    std::copy(indices.begin(), indices.end(), lightIndices_.begin() + rowOffsets_[row]);
+    for(uint32_t x = 0; x < tilesX_; ++x) {
+      clusters_[row*tilesX_ + x].offset += rowOffsets_[row];
+    }
+  }
+}
+
+} // namespace OglPlayground
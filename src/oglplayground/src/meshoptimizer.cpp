@@ -0,0 +1,359 @@
+#include <oglplayground/meshoptimizer.h>
+#include <oglplayground/threadpool.h>
+#include <oglplayground/vertexformat.h>
+
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+
+#include <glm/glm.hpp>
+
+namespace OglPlayground
+{
+
+namespace
+{
+
+// FIFO cache simulation shared by the analysis and the cluster splitting.
+// A vertex is in the cache while fewer than size misses happened since its
+// own, bumping the time by more than size flushes it.
+class VertexCache_
+{
+public:
+  VertexCache_(size_t verticesCount, size_t size)
+      : stamps_(verticesCount, 0)
+      , size_((uint32_t)size)
+      , time_((uint32_t)size+1)
+  {
+  }
+
+  // True on a miss
+  bool access(uint32_t vertex)
+  {
+    if(time_ - stamps_[vertex] <= size_) return false;
+    stamps_[vertex] = time_++;
+    return true;
+  }
+
+  void flush()
+  {
+    time_ += size_+1;
+  }
+
+private:
+  std::vector<uint32_t> stamps_;
+  uint32_t size_;
+  uint32_t time_;
+};
+
+// Triangles using each vertex, in a single array with per vertex offsets
+struct Adjacency_
+{
+  Adjacency_(const uint32_t* indices, size_t indicesCount, size_t verticesCount)
+      : offsets(verticesCount+1, 0)
+      , triangles(indicesCount)
+  {
+    for(size_t i = 0; i < indicesCount; ++i) ++offsets[indices[i]+1];
+    for(size_t v = 0; v < verticesCount; ++v) offsets[v+1] += offsets[v];
+    std::vector<uint32_t> fill(offsets.begin(), offsets.end()-1);
+    for(size_t i = 0; i < indicesCount; ++i) triangles[fill[indices[i]]++] = uint32_t(i/3);
+  }
+
+  std::vector<uint32_t> offsets;
+  std::vector<uint32_t> triangles;
+};
+
+// Tipsify, clusters gets the first triangle of every run that started with
+// a jump in input order, where the cache is as good as flushed
+void tipsify_(
+    uint32_t* dst,
+    const uint32_t* indices,
+    size_t indicesCount,
+    size_t verticesCount,
+    size_t cacheSize,
+    std::vector<uint32_t>* clusters)
+{
+  assert(dst != indices);
+  const size_t trianglesCount = indicesCount/3;
+  const Adjacency_ adjacency(indices, indicesCount, verticesCount);
+
+  std::vector<uint32_t> live(verticesCount);
+  for(size_t v = 0; v < verticesCount; ++v) live[v] = adjacency.offsets[v+1] - adjacency.offsets[v];
+  std::vector<uint32_t> stamps(verticesCount, 0);
+  std::vector<bool> emitted(trianglesCount, false);
+  std::vector<uint32_t> deadEnds;
+  std::vector<uint32_t> candidates;
+  uint32_t time = (uint32_t)cacheSize+1;
+  size_t cursor = 0;
+  size_t written = 0;
+
+  // Vertices of recently emitted triangles still used, else the next vertex
+  // with triangles left in input order, a jump away from the cache content
+  bool jumped = false;
+  auto skipDeadEnd = [&]() -> int64_t {
+    while(!deadEnds.empty()) {
+      const uint32_t v = deadEnds.back();
+      deadEnds.pop_back();
+      if(live[v] > 0) return v;
+    }
+    jumped = true;
+    for(; cursor < verticesCount; ++cursor) {
+      if(live[cursor] > 0) return (int64_t)cursor;
+    }
+    return -1;
+  };
+
+  int64_t fanning = skipDeadEnd();
+  if(clusters) clusters->push_back(0);
+  while(fanning >= 0) {
+    candidates.clear();
+    const uint32_t f = (uint32_t)fanning;
+    for(uint32_t a = adjacency.offsets[f]; a < adjacency.offsets[f+1]; ++a) {
+      const uint32_t t = adjacency.triangles[a];
+      if(emitted[t]) continue;
+      emitted[t] = true;
+      for(size_t k = 0; k < 3; ++k) {
+        const uint32_t v = indices[t*3+k];
+        dst[written++] = v;
+        deadEnds.push_back(v);
+        candidates.push_back(v);
+        --live[v];
+        if(time - stamps[v] > cacheSize) stamps[v] = time++;
+      }
+    }
+
+    // Candidate still in the cache after emitting all its triangles, that
+    // entered the cache first
+    fanning = -1;
+    uint32_t best = 0;
+    for(uint32_t v : candidates) {
+      if(live[v] == 0) continue;
+      uint32_t priority = 0;
+      if(time - stamps[v] + 2*live[v] <= cacheSize) priority = time - stamps[v];
+      if(priority > best) {
+        best = priority;
+        fanning = v;
+      }
+    }
+    if(fanning < 0) {
+      jumped = false;
+      fanning = skipDeadEnd();
+      if(jumped && fanning >= 0 && clusters) clusters->push_back(uint32_t(written/3));
+    }
+  }
+  assert(written == trianglesCount*3);
+}
+
+glm::vec3 position_(const uint8_t* vertices, size_t stride, size_t offset, AttributeType type, uint32_t vertex)
+{
+  const uint8_t* p = vertices + vertex*stride + offset;
+  if(type == AttributeType::Half) {
+    uint16_t h[3];
+    std::memcpy(h, p, sizeof(h));
+    return glm::vec3(halfToFloat(h[0]), halfToFloat(h[1]), halfToFloat(h[2]));
+  }
+  float f[3];
+  std::memcpy(f, p, sizeof(f));
+  return glm::vec3(f[0], f[1], f[2]);
+}
+
+} // anonymous namespace
+
+VertexCacheStats analyzeVertexCache(
+    const uint32_t* indices,
+    size_t indicesCount,
+    size_t verticesCount,
+    size_t cacheSize)
+{
+  VertexCacheStats stats;
+  VertexCache_ cache(verticesCount, cacheSize);
+  for(size_t i = 0; i < indicesCount; ++i) {
+    if(cache.access(indices[i])) ++stats.transformed;
+  }
+  if(indicesCount >= 3) stats.acmr = float(stats.transformed) / float(indicesCount/3);
+  if(verticesCount > 0) stats.atvr = float(stats.transformed) / float(verticesCount);
+  return stats;
+}
+
+void optimizeVertexCache(
+    uint32_t* dst,
+    const uint32_t* indices,
+    size_t indicesCount,
+    size_t verticesCount,
+    size_t cacheSize)
+{
+  tipsify_(dst, indices, indicesCount, verticesCount, cacheSize, nullptr);
+}
+
+void optimizeOverdraw(
+    uint32_t* dst,
+    const uint32_t* indices,
+    size_t indicesCount,
+    const void* vertices,
+    size_t verticesCount,
+    const VertexDesc& desc,
+    float threshold,
+    size_t cacheSize)
+{
+  // Without positions to sort by, the Tipsify order alone
+  const VertexAttribute* position = findAttribute(desc, AttributeUsage::Position);
+  if(!position
+      || position->nbComponents < 3
+      || (position->type != AttributeType::Float && position->type != AttributeType::Half)) {
+    tipsify_(dst, indices, indicesCount, verticesCount, cacheSize, nullptr);
+    return;
+  }
+  const size_t stride = strideFromVertexDesc(desc);
+  const size_t offset = offsetFromVertexDesc(desc, AttributeUsage::Position);
+  const uint8_t* bytes = static_cast<const uint8_t*>(vertices);
+
+  std::vector<uint32_t> hardClusters;
+  std::vector<uint32_t> sorted(indicesCount);
+  tipsify_(sorted.data(), indices, indicesCount, verticesCount, cacheSize, &hardClusters);
+  const size_t trianglesCount = indicesCount/3;
+  hardClusters.push_back((uint32_t)trianglesCount);
+
+  // Soft boundaries inside the hard clusters, the cache restarts empty at
+  // each one since the cluster may move
+  const float targetAcmr = threshold * analyzeVertexCache(sorted.data(), indicesCount, verticesCount, cacheSize).acmr;
+  std::vector<uint32_t> clusters;
+  VertexCache_ cache(verticesCount, cacheSize);
+  for(size_t c = 0; c+1 < hardClusters.size(); ++c) {
+    const uint32_t end = hardClusters[c+1];
+    uint32_t begin = hardClusters[c];
+    if(begin == end) continue;
+    clusters.push_back(begin);
+    cache.flush();
+    size_t misses = 0;
+    for(uint32_t t = begin; t < end; ++t) {
+      for(size_t k = 0; k < 3; ++k) misses += cache.access(sorted[t*3+k]) ? 1 : 0;
+      if(t+1 < end && float(misses) <= targetAcmr * float(t+1-begin)) {
+        begin = t+1;
+        clusters.push_back(begin);
+        cache.flush();
+        misses = 0;
+      }
+    }
+  }
+  clusters.push_back((uint32_t)trianglesCount);
+
+  // Area weighted centroids and normals
+  glm::vec3 meshCentroid(0.f);
+  float meshArea = 0.f;
+  std::vector<glm::vec3> centroids(clusters.size()-1, glm::vec3(0.f));
+  std::vector<glm::vec3> normals(clusters.size()-1, glm::vec3(0.f));
+  for(size_t c = 0; c+1 < clusters.size(); ++c) {
+    float area = 0.f;
+    for(uint32_t t = clusters[c]; t < clusters[c+1]; ++t) {
+      const glm::vec3 a = position_(bytes, stride, offset, position->type, sorted[t*3]);
+      const glm::vec3 b = position_(bytes, stride, offset, position->type, sorted[t*3+1]);
+      const glm::vec3 d = position_(bytes, stride, offset, position->type, sorted[t*3+2]);
+      const glm::vec3 normal = glm::cross(b-a, d-a);
+      const float triangleArea = glm::length(normal);
+      centroids[c] += (a+b+d) * (triangleArea/3.f);
+      normals[c] += normal;
+      area += triangleArea;
+    }
+    meshCentroid += centroids[c];
+    meshArea += area;
+    if(area > 0.f) centroids[c] /= area;
+  }
+  if(meshArea > 0.f) meshCentroid /= meshArea;
+
+  std::vector<float> keys(centroids.size());
+  std::vector<uint32_t> order(centroids.size());
+  for(size_t c = 0; c < centroids.size(); ++c) {
+    const float length = glm::length(normals[c]);
+    keys[c] = length > 0.f ? glm::dot(centroids[c]-meshCentroid, normals[c]) / length : 0.f;
+    order[c] = (uint32_t)c;
+  }
+  std::stable_sort(order.begin(), order.end(), [&keys](uint32_t a, uint32_t b) { return keys[a] > keys[b]; });
+
+  uint32_t* out = dst;
+  for(uint32_t c : order) {
+    const size_t count = (clusters[c+1]-clusters[c])*3;
+    std::memcpy(out, sorted.data() + clusters[c]*3, count*sizeof(uint32_t));
+    out += count;
+  }
+}
+
+size_t optimizeVertexFetch(
+    void* dst,
+    uint32_t* indices,
+    size_t indicesCount,
+    const void* vertices,
+    size_t verticesCount,
+    size_t stride)
+{
+  assert(dst != vertices);
+  const uint8_t* src = static_cast<const uint8_t*>(vertices);
+  uint8_t* out = static_cast<uint8_t*>(dst);
+  const uint32_t unused = ~0u;
+  std::vector<uint32_t> remap(verticesCount, unused);
+  uint32_t next = 0;
+  for(size_t i = 0; i < indicesCount; ++i) {
+    uint32_t& to = remap[indices[i]];
+    if(to == unused) {
+      std::memcpy(out + next*stride, src + indices[i]*stride, stride);
+      to = next++;
+    }
+    indices[i] = to;
+  }
+  return next;
+}
+
+size_t MeshData::verticesCount() const
+{
+  const size_t stride = strideFromVertexDesc(desc);
+  return stride ? vertices.size() / stride : 0;
+}
+
+MeshOptimizeStats optimizeMesh(MeshData& mesh, float overdrawThreshold, size_t cacheSize)
+{
+  const size_t stride = strideFromVertexDesc(mesh.desc);
+  const size_t verticesCount = mesh.verticesCount();
+  MeshOptimizeStats stats;
+  stats.before = analyzeVertexCache(mesh.indices.data(), mesh.indices.size(), verticesCount, cacheSize);
+
+  std::vector<uint32_t> indices(mesh.indices.size());
+  optimizeOverdraw(
+      indices.data(),
+      mesh.indices.data(),
+      mesh.indices.size(),
+      mesh.vertices.data(),
+      verticesCount,
+      mesh.desc,
+      overdrawThreshold,
+      cacheSize);
+  std::vector<uint8_t> vertices(mesh.vertices.size());
+  const size_t used = optimizeVertexFetch(
+      vertices.data(),
+      indices.data(),
+      indices.size(),
+      mesh.vertices.data(),
+      verticesCount,
+      stride);
+  vertices.resize(used*stride);
+  mesh.indices.swap(indices);
+  mesh.vertices.swap(vertices);
+
+  stats.after = analyzeVertexCache(mesh.indices.data(), mesh.indices.size(), used, cacheSize);
+  return stats;
+}
+
+std::vector<MeshOptimizeStats> optimizeMeshes(
+    ThreadPool& pool,
+    std::vector<MeshData>& meshes,
+    float overdrawThreshold,
+    size_t cacheSize)
+{
+  std::vector<MeshOptimizeStats> stats(meshes.size());
+  pool.parallelFor(meshes.size(), 1, [&](size_t begin, size_t end) {
+    for(size_t i = begin; i < end; ++i) {
+      stats[i] = optimizeMesh(meshes[i], overdrawThreshold, cacheSize);
+    }
+  });
+  return stats;
+}
+
+} // namespace OglPlayground
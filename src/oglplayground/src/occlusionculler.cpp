@@ -0,0 +1,283 @@
+#include <oglplayground/occlusionculler.h>
+#include <oglplayground/threadpool.h>
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <limits>
+
+#include "occlusionkernels.h"
+
+namespace OglPlayground
+{
+
+#ifdef OGLPLAYGROUND_AVX2
+// Defined in occlusionculler_avx2.cpp, built with avx2 enabled
+void rasterizeTileAVX2(
+    const detail::OccluderTriangle* triangles,
+    const uint32_t* bin,
+    size_t binCount,
+    float* depth,
+    size_t stride,
+    int x0, int y0, int x1, int y1);
+#endif
+
+namespace
+{
+
+// Vertices closer than that to the eye plane are not projected
+const float minW_ = 1e-5f;
+
+} // anonymous namespace
+
+OccluderMesh occluderFromVertices(
+    const float* vertices,
+    size_t verticesCount,
+    const uint32_t* indices,
+    size_t indicesCount,
+    const VertexDesc& desc)
+{
+  const size_t stride = strideFromVertexDesc(desc) / sizeof(float);
+  const size_t offset = offsetFromVertexDesc(desc, AttributeUsage::Position) / sizeof(float);
+  assert(offset < stride);
+  assert(findAttribute(desc, AttributeUsage::Position)->type == AttributeType::Float);
+
+  OccluderMesh mesh;
+  mesh.positions.reserve(verticesCount);
+  for(size_t i = 0; i < verticesCount; ++i) {
+    const float* p = vertices + i*stride + offset;
+    mesh.positions.push_back(glm::vec3(p[0], p[1], p[2]));
+  }
+  mesh.indices.assign(indices, indices+indicesCount);
+  return mesh;
+}
+
+OcclusionCuller::OcclusionCuller(uint32_t width, uint32_t height)
+    : width_(width)
+    , height_(height)
+    , stride_((width+tileWidth-1) / tileWidth * tileWidth)
+    , tilesX_((width+tileWidth-1) / tileWidth)
+    , tilesY_((height+tileHeight-1) / tileHeight)
+    , viewProjection_(1.f)
+    , bins_(tilesX_*tilesY_)
+    , depth_(size_t(stride_)*height, 1.f)
+{
+  assert(width > 0 && height > 0);
+
+  // Pyramid sizes down to a single texel
+  glm::uvec2 size(width, height);
+  pyramidSizes_.push_back(size);
+  while(size.x > 1 || size.y > 1) {
+    size = glm::uvec2((size.x+1) / 2, (size.y+1) / 2);
+    pyramidSizes_.push_back(size);
+    pyramid_.push_back(std::vector<float>(size_t(size.x)*size.y, 1.f));
+  }
+}
+
+OcclusionCuller::~OcclusionCuller()
+{
+}
+
+uint32_t OcclusionCuller::width() const
+{
+  return width_;
+}
+
+uint32_t OcclusionCuller::height() const
+{
+  return height_;
+}
+
+void OcclusionCuller::begin(const glm::mat4& viewProjection)
+{
+  viewProjection_ = viewProjection;
+  triangles_.clear();
+  for(auto& bin : bins_) bin.clear();
+  std::fill(depth_.begin(), depth_.end(), 1.f);
+}
+
+void OcclusionCuller::addOccluder(const OccluderMesh& mesh, const glm::mat4& model)
+{
+  const glm::mat4 transform = viewProjection_ * model;
+  const glm::vec2 screen(width_, height_);
+
+  for(size_t i = 0; i+2 < mesh.indices.size(); i += 3) {
+    // Triangles crossing the near plane are dropped, which only makes the
+    // culling more conservative
+    glm::vec3 v[3];
+    bool clipped = false;
+    for(int k = 0; k < 3; ++k) {
+      const glm::vec4 clip = transform * glm::vec4(mesh.positions[mesh.indices[i+k]], 1.f);
+      clipped |= clip.w < minW_;
+      const glm::vec3 ndc = glm::vec3(clip) / clip.w;
+      v[k] = glm::vec3((glm::vec2(ndc.x, ndc.y) * 0.5f + 0.5f) * screen, ndc.z * 0.5f + 0.5f);
+    }
+    if(clipped) continue;
+
+    // Both windings are occluders, make the edge functions positive inside
+    float area = (v[1].x - v[0].x) * (v[2].y - v[0].y) - (v[1].y - v[0].y) * (v[2].x - v[0].x);
+    if(area < 0.f) {
+      std::swap(v[1], v[2]);
+      area = -area;
+    }
+    if(area <= 0.f) continue;
+
+    detail::OccluderTriangle tri;
+    const glm::vec3 lo = glm::min(v[0], glm::min(v[1], v[2]));
+    const glm::vec3 hi = glm::max(v[0], glm::max(v[1], v[2]));
+    tri.minX = std::max(0, int(std::floor(lo.x)));
+    tri.minY = std::max(0, int(std::floor(lo.y)));
+    tri.maxX = std::min(int(width_)-1, int(std::floor(hi.x)));
+    tri.maxY = std::min(int(height_)-1, int(std::floor(hi.y)));
+    if(tri.minX > tri.maxX || tri.minY > tri.maxY || lo.z > 1.f) continue;
+
+    // Edge k goes from v[k] to v[k+1], it is zero on that edge and area at
+    // the opposite vertex, so edge k weights the depth of v[k+2]
+    tri.zx = tri.zy = tri.zc = 0.f;
+    for(int k = 0; k < 3; ++k) {
+      const glm::vec3& from = v[k];
+      const glm::vec3& to = v[(k+1) % 3];
+      tri.a[k] = -(to.y - from.y);
+      tri.b[k] = to.x - from.x;
+      tri.c[k] = -(tri.a[k]*from.x + tri.b[k]*from.y);
+      const float z = v[(k+2) % 3].z / area;
+      tri.zx += tri.a[k] * z;
+      tri.zy += tri.b[k] * z;
+      tri.zc += tri.c[k] * z;
+    }
+
+    const uint32_t index = (uint32_t)triangles_.size();
+    triangles_.push_back(tri);
+    for(int ty = tri.minY / int(tileHeight); ty <= tri.maxY / int(tileHeight); ++ty) {
+      for(int tx = tri.minX / int(tileWidth); tx <= tri.maxX / int(tileWidth); ++tx) {
+        bins_[ty*tilesX_ + tx].push_back(index);
+      }
+    }
+  }
+}
+
+void OcclusionCuller::rasterize(SimdLevel level)
+{
+  rasterizeTiles(0, tilesX_*tilesY_, level);
+  buildPyramid();
+}
+
+void OcclusionCuller::rasterize(ThreadPool& pool, SimdLevel level)
+{
+  // Tiles own their pixels, no synchronization needed
+  pool.parallelFor(tilesX_*tilesY_, 1, [this, level](size_t begin, size_t end) {
+    rasterizeTiles((uint32_t)begin, (uint32_t)end, level);
+  });
+  buildPyramid();
+}
+
+float OcclusionCuller::depth(uint32_t x, uint32_t y) const
+{
+  assert(x < width_ && y < height_);
+  return depth_[size_t(y)*stride_ + x];
+}
+
+bool OcclusionCuller::isVisible(const glm::vec3& center, const glm::vec3& extent) const
+{
+  // Screen rectangle and nearest depth of the 8 corners
+  glm::vec2 lo(std::numeric_limits<float>::max());
+  glm::vec2 hi(-std::numeric_limits<float>::max());
+  float nearest = 1.f;
+  for(int corner = 0; corner < 8; ++corner) {
+    const glm::vec3 sign((corner & 1) ? 1.f : -1.f, (corner & 2) ? 1.f : -1.f, (corner & 4) ? 1.f : -1.f);
+    const glm::vec4 clip = viewProjection_ * glm::vec4(center + sign*extent, 1.f);
+    if(clip.w < minW_) return true;
+    const glm::vec3 ndc = glm::vec3(clip) / clip.w;
+    const glm::vec2 p = (glm::vec2(ndc.x, ndc.y) * 0.5f + 0.5f) * glm::vec2(width_, height_);
+    lo = glm::min(lo, p);
+    hi = glm::max(hi, p);
+    nearest = std::min(nearest, ndc.z * 0.5f + 0.5f);
+  }
+  if(hi.x < 0.f || hi.y < 0.f || lo.x >= float(width_) || lo.y >= float(height_)) return false;
+  const int x0 = std::max(0, int(lo.x));
+  const int y0 = std::max(0, int(lo.y));
+  const int x1 = std::min(int(width_)-1, int(hi.x));
+  const int y1 = std::min(int(height_)-1, int(hi.y));
+
+  // Coarsest level where the rectangle spans at most 2 texels per axis
+  const int size = std::max(x1-x0, y1-y0);
+  size_t level = 0;
+  while((size >> level) > 1 && level+1 < pyramidSizes_.size()) ++level;
+
+  const float* texels = level == 0 ? depth_.data() : pyramid_[level-1].data();
+  const size_t rowStride = level == 0 ? stride_ : pyramidSizes_[level].x;
+  float farthest = 0.f;
+  for(int y = y0 >> level; y <= (y1 >> level); ++y) {
+    for(int x = x0 >> level; x <= (x1 >> level); ++x) {
+      farthest = std::max(farthest, texels[y*rowStride + x]);
+    }
+  }
+  return nearest <= farthest;
+}
+
+size_t OcclusionCuller::testBoxes(const BoxArrays& boxes, const uint32_t* indices, size_t count, uint32_t* visible) const
+{
+  size_t visibleCount = 0;
+  for(size_t i = 0; i < count; ++i) {
+    const uint32_t index = indices[i];
+    const glm::vec3 center(boxes.centerX[index], boxes.centerY[index], boxes.centerZ[index]);
+    const glm::vec3 extent(boxes.extentX[index], boxes.extentY[index], boxes.extentZ[index]);
+    if(isVisible(center, extent)) visible[visibleCount++] = index;
+  }
+  return visibleCount;
+}
+
+void OcclusionCuller::rasterizeTiles(uint32_t firstTile, uint32_t lastTile, SimdLevel level)
+{
+  level = supportedSimdLevel(level);
+  for(uint32_t tile = firstTile; tile < lastTile; ++tile) {
+    const std::vector<uint32_t>& bin = bins_[tile];
+    if(bin.empty()) continue;
+    const int x0 = int(tile % tilesX_ * tileWidth);
+    const int y0 = int(tile / tilesX_ * tileHeight);
+    const int x1 = x0 + int(tileWidth);
+    const int y1 = std::min(y0 + int(tileHeight), int(height_));
+    switch(level) {
+#ifdef OGLPLAYGROUND_AVX2
+    case SimdLevel::AVX2:
+      rasterizeTileAVX2(triangles_.data(), bin.data(), bin.size(), depth_.data(), stride_, x0, y0, x1, y1);
+      break;
+#endif
+#ifdef OGLPLAYGROUND_SSE2
+    case SimdLevel::SSE2:
+      detail::rasterizeTile<detail::Float4>(triangles_.data(), bin.data(), bin.size(), depth_.data(), stride_, x0, y0, x1, y1);
+      break;
+#endif
+    default:
+      detail::rasterizeTile<detail::Float1>(triangles_.data(), bin.data(), bin.size(), depth_.data(), stride_, x0, y0, x1, y1);
+      break;
+    }
+  }
+}
+
+void OcclusionCuller::buildPyramid()
+{
+  const float* source = depth_.data();
+  size_t sourceStride = stride_;
+  for(size_t level = 1; level < pyramidSizes_.size(); ++level) {
+    const glm::uvec2 sourceSize = pyramidSizes_[level-1];
+    const glm::uvec2 size = pyramidSizes_[level];
+    std::vector<float>& texels = pyramid_[level-1];
+    for(uint32_t y = 0; y < size.y; ++y) {
+      // Odd sizes clamp to the last source row or column
+      const size_t y0 = 2*y;
+      const size_t y1 = std::min<size_t>(2*y+1, sourceSize.y-1);
+      for(uint32_t x = 0; x < size.x; ++x) {
+        const size_t x0 = 2*x;
+        const size_t x1 = std::min<size_t>(2*x+1, sourceSize.x-1);
+        texels[y*size.x + x] = std::max(
+            std::max(source[y0*sourceStride + x0], source[y0*sourceStride + x1]),
+            std::max(source[y1*sourceStride + x0], source[y1*sourceStride + x1]));
+      }
+    }
+    source = texels.data();
+    sourceStride = size.x;
+  }
+}
+
+} // namespace OglPlayground
@@ -0,0 +1,23 @@
+#include <oglplayground/occlusionculler.h>
+
+#if defined(OGLPLAYGROUND_AVX2) && defined(__AVX2__)
+
+#include "occlusionkernels.h"
+
+namespace OglPlayground
+{
+
+void rasterizeTileAVX2(
+    const detail::OccluderTriangle* triangles,
+    const uint32_t* bin,
+    size_t binCount,
+    float* depth,
+    size_t stride,
+    int x0, int y0, int x1, int y1)
+{
+  detail::rasterizeTile<detail::Float8>(triangles, bin, binCount, depth, stride, x0, y0, x1, y1);
+}
+
+} // namespace OglPlayground
+
+#endif
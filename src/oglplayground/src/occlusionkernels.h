@@ -0,0 +1,96 @@
+#pragma once
+
+// Internal occluder rasterization written once over the wide float types of
+// simdfloat.h, the scalar version is the one lane case.
+
+#include "simdfloat.h"
+
+namespace OglPlayground
+{
+namespace detail
+{
+
+//! Screen space triangle setup, all functions in pixel coordinates
+struct OccluderTriangle
+{
+  // Edge functions a*x + b*y + c, positive inside
+  float a[3];
+  float b[3];
+  float c[3];
+  // Depth plane
+  float zx;
+  float zy;
+  float zc;
+  // Pixel bounds, inclusive and clamped to the screen
+  int minX;
+  int minY;
+  int maxX;
+  int maxY;
+};
+
+namespace
+{
+
+//! One lane float, lets the kernel run without any instruction set
+struct Float1
+{
+  static const size_t width = 1;
+  float v;
+
+  static Float1 set1(float f) { return {f}; }
+  static Float1 zero() { return {0.f}; }
+  static Float1 load(const float* p) { return {*p}; }
+  void store(float* p) const { *p = v; }
+};
+
+inline Float1 operator+(Float1 a, Float1 b) { return {a.v + b.v}; }
+inline Float1 operator*(Float1 a, Float1 b) { return {a.v * b.v}; }
+inline Float1 min(Float1 a, Float1 b) { return {a.v < b.v ? a.v : b.v}; }
+inline Float1 selectLess(Float1 a, Float1 b, Float1 ifLess, Float1 otherwise) { return a.v < b.v ? ifLess : otherwise; }
+
+// Keep the nearest depth of the triangles listed in bin over the pixels of
+// [x0, x1) x [y0, y1), x0 and x1 multiples of F::width
+template<typename F>
+void rasterizeTile(
+    const OccluderTriangle* triangles,
+    const uint32_t* bin,
+    size_t binCount,
+    float* depth,
+    size_t stride,
+    int x0, int y0, int x1, int y1)
+{
+  static const float laneCenters[8] = {0.5f, 1.5f, 2.5f, 3.5f, 4.5f, 5.5f, 6.5f, 7.5f};
+  const F zero = F::zero();
+  const F centers = F::load(laneCenters);
+
+  for(size_t t = 0; t < binCount; ++t) {
+    const OccluderTriangle& tri = triangles[bin[t]];
+    const int minY = tri.minY > y0 ? tri.minY : y0;
+    const int maxY = tri.maxY < y1-1 ? tri.maxY : y1-1;
+    const int minX = (tri.minX > x0 ? tri.minX : x0) / int(F::width) * int(F::width);
+    const int maxX = tri.maxX < x1-1 ? tri.maxX : x1-1;
+
+    const F a0 = F::set1(tri.a[0]), a1 = F::set1(tri.a[1]), a2 = F::set1(tri.a[2]);
+    const F zx = F::set1(tri.zx);
+    for(int y = minY; y <= maxY; ++y) {
+      // Terms constant along the row
+      const float py = float(y) + 0.5f;
+      const F r0 = F::set1(tri.b[0]*py + tri.c[0]);
+      const F r1 = F::set1(tri.b[1]*py + tri.c[1]);
+      const F r2 = F::set1(tri.b[2]*py + tri.c[2]);
+      const F rz = F::set1(tri.zy*py + tri.zc);
+      float* row = depth + size_t(y)*stride;
+      for(int x = minX; x <= maxX; x += int(F::width)) {
+        const F px = F::set1(float(x)) + centers;
+        const F e = min(a0*px + r0, min(a1*px + r1, a2*px + r2));
+        const F z = zx*px + rz;
+        const F old = F::load(row+x);
+        selectLess(e, zero, old, min(old, z)).store(row+x);
+      }
+    }
+  }
+}
+
+} // anonymous namespace
+} // namespace detail
+} // namespace OglPlayground
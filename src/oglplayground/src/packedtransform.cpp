@@ -0,0 +1,147 @@
+#include <oglplayground/packedtransform.h>
+
+namespace OglPlayground
+{
+namespace
+{
+
+glm::vec4 packQuat_(const glm::quat& q)
+{
+  return glm::vec4(q.x, q.y, q.z, q.w);
+}
+
+// Column lengths give the scale, a negative determinant is carried by x
+void decompose_(const glm::mat4& m, glm::vec3& position, glm::vec4& rotation, glm::vec3& scale)
+{
+  glm::mat3 r(m);
+  scale = glm::vec3(glm::length(r[0]), glm::length(r[1]), glm::length(r[2]));
+  if(glm::determinant(r) < 0.f) scale.x = -scale.x;
+  r[0] /= scale.x;
+  r[1] /= scale.y;
+  r[2] /= scale.z;
+  rotation = packQuat_(glm::quat_cast(r));
+  position = glm::vec3(m[3]);
+}
+
+// Same operations as glm::mat3_cast, mirrored by the glsl
+glm::mat4 matrixFromPacked_(const glm::vec4& q, const glm::vec3& position, const glm::vec3& scale)
+{
+  const float xx = q.x*q.x, yy = q.y*q.y, zz = q.z*q.z;
+  const float xy = q.x*q.y, xz = q.x*q.z, yz = q.y*q.z;
+  const float wx = q.w*q.x, wy = q.w*q.y, wz = q.w*q.z;
+  return glm::mat4(
+      glm::vec4(1.f - 2.f*(yy+zz), 2.f*(xy+wz), 2.f*(xz-wy), 0.f) * scale.x,
+      glm::vec4(2.f*(xy-wz), 1.f - 2.f*(xx+zz), 2.f*(yz+wx), 0.f) * scale.y,
+      glm::vec4(2.f*(xz+wy), 2.f*(yz-wx), 1.f - 2.f*(xx+yy), 0.f) * scale.z,
+      glm::vec4(position, 1.f));
+}
+
+} // anonymous namespace
+
+const char* const packedTransformGlsl = R"(
+#ifndef PACKED_TRANSFORM_BINDING
+#define PACKED_TRANSFORM_BINDING 0
+#endif
+layout(std430, binding = PACKED_TRANSFORM_BINDING) readonly buffer PackedTransforms
+{
+  float packedTransforms[];
+};
+
+mat4 packedTransformMatrix(uint index)
+{
+  uint o = index * 10u;
+  vec4 q = vec4(packedTransforms[o], packedTransforms[o+1u], packedTransforms[o+2u], packedTransforms[o+3u]);
+  vec3 p = vec3(packedTransforms[o+4u], packedTransforms[o+5u], packedTransforms[o+6u]);
+  vec3 s = vec3(packedTransforms[o+7u], packedTransforms[o+8u], packedTransforms[o+9u]);
+  float xx = q.x*q.x, yy = q.y*q.y, zz = q.z*q.z;
+  float xy = q.x*q.y, xz = q.x*q.z, yz = q.y*q.z;
+  float wx = q.w*q.x, wy = q.w*q.y, wz = q.w*q.z;
+  return mat4(
+      vec4(1.0 - 2.0*(yy+zz), 2.0*(xy+wz), 2.0*(xz-wy), 0.0) * s.x,
+      vec4(2.0*(xy-wz), 1.0 - 2.0*(xx+zz), 2.0*(yz+wx), 0.0) * s.y,
+      vec4(2.0*(xz+wy), 2.0*(yz-wx), 1.0 - 2.0*(xx+yy), 0.0) * s.z,
+      vec4(p, 1.0));
+}
+)";
+
+const char* const packedUniformTransformGlsl = R"(
+#ifndef PACKED_UNIFORM_TRANSFORM_BINDING
+#define PACKED_UNIFORM_TRANSFORM_BINDING 1
+#endif
+layout(std430, binding = PACKED_UNIFORM_TRANSFORM_BINDING) readonly buffer PackedUniformTransforms
+{
+  vec4 packedUniformTransforms[];
+};
+
+mat4 packedUniformTransformMatrix(uint index)
+{
+  vec4 q = packedUniformTransforms[index*2u];
+  vec4 ps = packedUniformTransforms[index*2u + 1u];
+  float xx = q.x*q.x, yy = q.y*q.y, zz = q.z*q.z;
+  float xy = q.x*q.y, xz = q.x*q.z, yz = q.y*q.z;
+  float wx = q.w*q.x, wy = q.w*q.y, wz = q.w*q.z;
+  return mat4(
+      vec4(1.0 - 2.0*(yy+zz), 2.0*(xy+wz), 2.0*(xz-wy), 0.0) * ps.w,
+      vec4(2.0*(xy-wz), 1.0 - 2.0*(xx+zz), 2.0*(yz+wx), 0.0) * ps.w,
+      vec4(2.0*(xz+wy), 2.0*(yz-wx), 1.0 - 2.0*(xx+yy), 0.0) * ps.w,
+      vec4(ps.xyz, 1.0));
+}
+)";
+
+void packTransforms(
+    const glm::vec3* positions,
+    const glm::quat* rotations,
+    const glm::vec3* scales,
+    PackedTransform* packed,
+    size_t count)
+{
+  for(size_t i = 0; i < count; ++i) {
+    packed[i].rotation = packQuat_(rotations[i]);
+    packed[i].position = positions[i];
+    packed[i].scale = scales[i];
+  }
+}
+
+void packTransforms(
+    const glm::vec3* positions,
+    const glm::quat* rotations,
+    const glm::vec3* scales,
+    PackedUniformTransform* packed,
+    size_t count)
+{
+  for(size_t i = 0; i < count; ++i) {
+    packed[i].rotation = packQuat_(rotations[i]);
+    packed[i].positionScale = glm::vec4(positions[i], scales[i].x);
+  }
+}
+
+void packTransforms(const glm::mat4* matrices, PackedTransform* packed, size_t count)
+{
+  for(size_t i = 0; i < count; ++i) {
+    decompose_(matrices[i], packed[i].position, packed[i].rotation, packed[i].scale);
+  }
+}
+
+void packTransforms(const glm::mat4* matrices, PackedUniformTransform* packed, size_t count)
+{
+  // A negative uniform scale mirrors the three axes at once
+  for(size_t i = 0; i < count; ++i) {
+    const glm::mat3 r(matrices[i]);
+    float scale = glm::length(r[0]);
+    if(glm::determinant(r) < 0.f) scale = -scale;
+    packed[i].rotation = packQuat_(glm::quat_cast(r * (1.f/scale)));
+    packed[i].positionScale = glm::vec4(glm::vec3(matrices[i][3]), scale);
+  }
+}
+
+glm::mat4 matrixFromPacked(const PackedTransform& packed)
+{
+  return matrixFromPacked_(packed.rotation, packed.position, packed.scale);
+}
+
+glm::mat4 matrixFromPacked(const PackedUniformTransform& packed)
+{
+  return matrixFromPacked_(packed.rotation, glm::vec3(packed.positionScale), glm::vec3(packed.positionScale.w));
+}
+
+} // namespace OglPlayground
@@ -0,0 +1,124 @@
+#include <oglplayground/resourceloader.h>
+
+#include <cassert>
+
+namespace OglPlayground
+{
+namespace
+{
+
+// Wait slice between checks of a fence, in nanoseconds
+const GLuint64 waitTimeout_ = 1000000;
+
+} // anonymous namespace
+
+ResourceLoader::ResourceLoader(std::function<bool ()> makeCurrent, std::function<void ()> doneCurrent)
+{
+  thread_ = std::thread(&ResourceLoader::loaderLoop, this, std::move(makeCurrent), std::move(doneCurrent));
+}
+
+ResourceLoader::~ResourceLoader()
+{
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stop_ = true;
+  }
+  wake_.notify_one();
+  thread_.join();
+  // The syncs are shared, deleting them from this context is fine
+  for(Job& job : published_) {
+    if(job.fence) glDeleteSync(job.fence);
+  }
+}
+
+void ResourceLoader::enqueue(Task load, Task publish)
+{
+  assert(load);
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    queued_.push_back({std::move(load), std::move(publish), nullptr});
+  }
+  wake_.notify_one();
+}
+
+size_t ResourceLoader::poll()
+{
+  // Take the completed jobs, publish them without holding the lock
+  std::vector<Job> ready;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    while(!published_.empty()) {
+      Job& job = published_.front();
+      if(job.fence) {
+        const GLenum status = glClientWaitSync(job.fence, 0, 0);
+        if(status == GL_TIMEOUT_EXPIRED) break;
+        assert(status != GL_WAIT_FAILED);
+        glDeleteSync(job.fence);
+      }
+      ready.push_back(std::move(job));
+      published_.pop_front();
+    }
+  }
+  for(Job& job : ready) {
+    if(job.publish) job.publish();
+  }
+  return ready.size();
+}
+
+void ResourceLoader::finish()
+{
+  for(;;) {
+    GLsync fence = nullptr;
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      loaded_.wait(lock, [this] { return queued_.empty() && running_ == 0; });
+      if(published_.empty()) return;
+      fence = published_.front().fence;
+    }
+    // Only this thread deletes fences, the loader flushed them
+    if(fence) {
+      while(glClientWaitSync(fence, 0, waitTimeout_) == GL_TIMEOUT_EXPIRED) {}
+    }
+    // Publish may enqueue more
+    poll();
+  }
+}
+
+size_t ResourceLoader::pendingCount() const
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  return queued_.size() + running_ + published_.size();
+}
+
+void ResourceLoader::loaderLoop(std::function<bool ()> makeCurrent, std::function<void ()> doneCurrent)
+{
+  const bool current = makeCurrent();
+  for(;;) {
+    Job job;
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      wake_.wait(lock, [this] { return stop_ || !queued_.empty(); });
+      if(queued_.empty()) break;
+      job = std::move(queued_.front());
+      queued_.pop_front();
+      ++running_;
+    }
+
+    if(current) {
+      job.load();
+      // Flushed, or the render thread could wait on a fence never submitted
+      job.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+      glFlush();
+    }
+
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      --running_;
+      if(current) published_.push_back(std::move(job));
+    }
+    loaded_.notify_all();
+  }
+  if(current && doneCurrent) doneCurrent();
+}
+
+} // namespace OglPlayground
@@ -0,0 +1,130 @@
+#include <oglplayground/ringbuffer.h>
+
+#include <cassert>
+
+#include <oglplayground/gpumemory.h>
+
+namespace OglPlayground
+{
+namespace
+{
+
+const size_t regionAlignment_ = 256;
+// Wait slice between checks of a fence, in nanoseconds
+const GLuint64 waitTimeout_ = 1000000;
+
+} // anonymous namespace
+
+RingBuffer::RingBuffer(GLenum target, size_t regionSize, uint32_t regionCount)
+    : target_(target)
+    , regionSize_((regionSize+regionAlignment_-1) / regionAlignment_ * regionAlignment_)
+    , regionCount_(regionCount)
+    , fences_(regionCount, nullptr)
+    , current_(regionCount-1)
+{
+  assert(regionSize > 0 && regionCount > 0);
+  // Coherent, the writes are visible to the GPU without explicit flushes
+  const GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+  const size_t size = regionSize_*regionCount_;
+  glGenBuffers(1, &buffer_);
+  bind();
+  glBufferStorage(target_, size, nullptr, flags);
+  mapping_ = static_cast<uint8_t*>(glMapBufferRange(target_, 0, size, flags));
+  unbind();
+  assert(mapping_);
+  trackGpuAllocation(gpuResourceFromTarget(target_), size);
+}
+
+RingBuffer::~RingBuffer()
+{
+  for(GLsync fence : fences_) {
+    if(fence) glDeleteSync(fence);
+  }
+  // Deleting the buffer unmaps it
+  glDeleteBuffers(1, &buffer_);
+  trackGpuFree(gpuResourceFromTarget(target_), regionSize_*regionCount_);
+}
+
+GLuint RingBuffer::name() const
+{
+  return buffer_;
+}
+
+GLenum RingBuffer::target() const
+{
+  return target_;
+}
+
+size_t RingBuffer::regionSize() const
+{
+  return regionSize_;
+}
+
+uint32_t RingBuffer::regionCount() const
+{
+  return regionCount_;
+}
+
+void RingBuffer::beginFrame()
+{
+  current_ = (current_+1) % regionCount_;
+  used_ = 0;
+  GLsync& fence = fences_[current_];
+  if(!fence) return;
+
+  GLenum status = glClientWaitSync(fence, 0, 0);
+  if(status == GL_TIMEOUT_EXPIRED) {
+    ++stallCount_;
+    do {
+      status = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, waitTimeout_);
+    } while(status == GL_TIMEOUT_EXPIRED);
+  }
+  assert(status != GL_WAIT_FAILED);
+  glDeleteSync(fence);
+  fence = nullptr;
+}
+
+void* RingBuffer::allocate(size_t size, size_t alignment, size_t& offset)
+{
+  assert(alignment > 0 && alignment <= regionAlignment_);
+  const size_t begin = (used_+alignment-1) / alignment * alignment;
+  if(begin+size > regionSize_) return nullptr;
+  used_ = begin+size;
+  offset = current_*regionSize_ + begin;
+  return mapping_ + offset;
+}
+
+size_t RingBuffer::available(size_t alignment) const
+{
+  assert(alignment > 0 && alignment <= regionAlignment_);
+  const size_t begin = (used_+alignment-1) / alignment * alignment;
+  return begin < regionSize_ ? regionSize_-begin : 0;
+}
+
+void RingBuffer::endFrame()
+{
+  assert(!fences_[current_]);
+  fences_[current_] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+}
+
+void RingBuffer::bind() const
+{
+  glBindBuffer(target_, buffer_);
+}
+
+void RingBuffer::unbind() const
+{
+  glBindBuffer(target_, 0);
+}
+
+void RingBuffer::bindRange(GLuint index, size_t offset, size_t size) const
+{
+  glBindBufferRange(target_, index, buffer_, offset, size);
+}
+
+uint64_t RingBuffer::stallCount() const
+{
+  return stallCount_;
+}
+
+} // namespace OglPlayground
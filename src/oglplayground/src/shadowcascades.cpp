@@ -0,0 +1,214 @@
+#include <oglplayground/shadowcascades.h>
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+
+#include <glm/gtc/matrix_transform.hpp>
+
+#include "shadowkernels.h"
+
+namespace OglPlayground
+{
+
+#ifdef OGLPLAYGROUND_AVX2
+// Defined in shadowcascades_avx2.cpp, built with avx2 enabled
+size_t cullCastersAVX2(
+    const glm::mat4& lightView,
+    const glm::vec3* cascadeMin,
+    const glm::vec3* cascadeMax,
+    size_t cascadeCount,
+    const BoxArrays& boxes,
+    size_t first,
+    size_t count,
+    uint32_t*& casters,
+    uint8_t*& masks);
+#endif
+
+void practicalSplits(float nearPlane, float farPlane, uint32_t count, float lambda, float* splits)
+{
+  assert(nearPlane > 0.f && farPlane > nearPlane && count > 0);
+  for(uint32_t i = 0; i <= count; ++i) {
+    const float t = float(i) / float(count);
+    const float logarithmic = nearPlane * std::pow(farPlane / nearPlane, t);
+    const float uniform = nearPlane + (farPlane - nearPlane) * t;
+    splits[i] = lambda * logarithmic + (1.f - lambda) * uniform;
+  }
+  // Exact ends whatever the rounding
+  splits[0] = nearPlane;
+  splits[count] = farPlane;
+}
+
+ShadowCascades::ShadowCascades(uint32_t count, uint32_t resolution)
+    : resolution_(resolution)
+    , cascades_(count, ShadowCascade{0.f, 0.f, glm::mat4(1.f)})
+    , frustums_(count, frustumFromMatrix(glm::mat4(1.f)))
+    , lightView_(1.f)
+    , cascadeMin_(count, glm::vec3(-1.f))
+    , cascadeMax_(count, glm::vec3(1.f))
+{
+  assert(count > 0 && count <= maxCascades && resolution > 2);
+}
+
+uint32_t ShadowCascades::count() const
+{
+  return (uint32_t)cascades_.size();
+}
+
+uint32_t ShadowCascades::resolution() const
+{
+  return resolution_;
+}
+
+void ShadowCascades::setSplitLambda(float lambda)
+{
+  splitLambda_ = lambda;
+}
+
+float ShadowCascades::splitLambda() const
+{
+  return splitLambda_;
+}
+
+void ShadowCascades::setShadowDistance(float distance)
+{
+  shadowDistance_ = distance;
+}
+
+float ShadowCascades::shadowDistance() const
+{
+  return shadowDistance_;
+}
+
+void ShadowCascades::setCasterDistance(float distance)
+{
+  casterDistance_ = distance;
+}
+
+float ShadowCascades::casterDistance() const
+{
+  return casterDistance_;
+}
+
+void ShadowCascades::update(const Camera& camera, const glm::vec3& lightDirection)
+{
+  const float nearPlane = camera.nearPlane();
+  const float farPlane = shadowDistance_ > 0.f ? std::min(shadowDistance_, camera.farPlane()) : camera.farPlane();
+  float splits[maxCascades+1];
+  practicalSplits(nearPlane, farPlane, count(), splitLambda_, splits);
+
+  // Squared tangent of the angle between the view axis and the frustum edges
+  const glm::mat4& projection = camera.projection();
+  const float tanX = 1.f / projection[0][0];
+  const float tanY = 1.f / projection[1][1];
+  const float edge2 = tanX*tanX + tanY*tanY;
+  const glm::mat4 cameraToWorld = glm::inverse(camera.view());
+
+  // Light rotation only, cascade positions are snapped in that space
+  const glm::vec3 direction = glm::normalize(lightDirection);
+  const glm::vec3 up = std::abs(direction.y) > 0.99f ? glm::vec3(0.f, 0.f, 1.f) : glm::vec3(0.f, 1.f, 0.f);
+  lightView_ = glm::lookAt(glm::vec3(0.f), direction, up);
+
+  for(uint32_t c = 0; c < count(); ++c) {
+    ShadowCascade& cascade = cascades_[c];
+    cascade.splitNear = splits[c];
+    cascade.splitFar = splits[c+1];
+
+    // Smallest sphere around the slice corners has its center on the view
+    // axis, its radius only depends on the split depths
+    const float n = splits[c];
+    const float f = splits[c+1];
+    const float centerDepth = std::min(0.5f * (n + f) * (1.f + edge2), f);
+    float radius = std::sqrt(std::max(
+        (centerDepth - n)*(centerDepth - n) + n*n*edge2,
+        (f - centerDepth)*(f - centerDepth) + f*f*edge2));
+    radius = std::ceil(radius * 16.f) / 16.f;
+
+    // Move the center by whole texels. Flooring moves it by up to one texel,
+    // the box gets one texel of padding on each side to still hold the sphere
+    const glm::vec3 worldCenter = glm::vec3(cameraToWorld * glm::vec4(0.f, 0.f, centerDepth, 1.f));
+    glm::vec3 center = glm::vec3(lightView_ * glm::vec4(worldCenter, 1.f));
+    const float texel = 2.f * radius / float(resolution_ - 2);
+    const float extent = radius + texel;
+    center.x = std::floor(center.x / texel) * texel;
+    center.y = std::floor(center.y / texel) * texel;
+
+    cascadeMin_[c] = glm::vec3(center.x - extent, center.y - extent, center.z - radius - casterDistance_);
+    cascadeMax_[c] = glm::vec3(center.x + extent, center.y + extent, center.z + radius);
+    const glm::mat4 lightProjection = glm::ortho(
+        cascadeMin_[c].x, cascadeMax_[c].x,
+        cascadeMin_[c].y, cascadeMax_[c].y,
+        cascadeMin_[c].z, cascadeMax_[c].z);
+    cascade.viewProjection = lightProjection * lightView_;
+    frustums_[c] = frustumFromMatrix(cascade.viewProjection);
+  }
+}
+
+const ShadowCascade& ShadowCascades::cascade(uint32_t index) const
+{
+  assert(index < cascades_.size());
+  return cascades_[index];
+}
+
+const Frustum& ShadowCascades::frustum(uint32_t index) const
+{
+  assert(index < frustums_.size());
+  return frustums_[index];
+}
+
+size_t ShadowCascades::cullCasters(
+    const BoxArrays& boxes,
+    size_t count,
+    uint32_t* casters,
+    uint8_t* masks,
+    SimdLevel level) const
+{
+  // The cascade frustums are boxes in light space, cheaper to test there
+  // than with the planes of cullBoxesMulti
+  uint32_t* const begin = casters;
+  const size_t cascadeCount = cascades_.size();
+  size_t done = 0;
+  switch(supportedSimdLevel(level)) {
+#ifdef OGLPLAYGROUND_AVX2
+  case SimdLevel::AVX2:
+    done = cullCastersAVX2(
+        lightView_, cascadeMin_.data(), cascadeMax_.data(), cascadeCount, boxes, done, count, casters, masks);
+    // fallthrough, the 4 wide kernel handles part of the tail
+#endif
+#ifdef OGLPLAYGROUND_SSE2
+  case SimdLevel::SSE2:
+    done = detail::cullCastersKernel<detail::Float4>(
+        lightView_, cascadeMin_.data(), cascadeMax_.data(), cascadeCount, boxes, done, count, casters, masks);
+#endif
+  default:
+    break;
+  }
+
+  for(size_t i = done; i < count; ++i) {
+    const glm::vec3 center(boxes.centerX[i], boxes.centerY[i], boxes.centerZ[i]);
+    const glm::vec3 extent(boxes.extentX[i], boxes.extentY[i], boxes.extentZ[i]);
+    glm::vec3 lo, hi;
+    for(int a = 0; a < 3; ++a) {
+      const float c = lightView_[0][a]*center.x + lightView_[1][a]*center.y + lightView_[2][a]*center.z + lightView_[3][a];
+      const float e = glm::abs(lightView_[0][a])*extent.x + glm::abs(lightView_[1][a])*extent.y + glm::abs(lightView_[2][a])*extent.z;
+      lo[a] = c - e;
+      hi[a] = c + e;
+    }
+    uint32_t mask = 0;
+    for(size_t c = 0; c < cascadeCount; ++c) {
+      bool outside = false;
+      for(int a = 0; a < 3; ++a) {
+        outside |= hi[a] < cascadeMin_[c][a];
+        outside |= cascadeMax_[c][a] < lo[a];
+      }
+      if(!outside) mask |= 1u << c;
+    }
+    if(mask != 0) {
+      *casters++ = (uint32_t)i;
+      *masks++ = (uint8_t)mask;
+    }
+  }
+  return casters - begin;
+}
+
+} // namespace OglPlayground
@@ -0,0 +1,27 @@
+#include <oglplayground/shadowcascades.h>
+
+#if defined(OGLPLAYGROUND_AVX2) && defined(__AVX2__)
+
+#include "shadowkernels.h"
+
+namespace OglPlayground
+{
+
+size_t cullCastersAVX2(
+    const glm::mat4& lightView,
+    const glm::vec3* cascadeMin,
+    const glm::vec3* cascadeMax,
+    size_t cascadeCount,
+    const BoxArrays& boxes,
+    size_t first,
+    size_t count,
+    uint32_t*& casters,
+    uint8_t*& masks)
+{
+  return detail::cullCastersKernel<detail::Float8>(
+      lightView, cascadeMin, cascadeMax, cascadeCount, boxes, first, count, casters, masks);
+}
+
+} // namespace OglPlayground
+
+#endif
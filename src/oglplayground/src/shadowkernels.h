@@ -0,0 +1,62 @@
+#pragma once
+
+// Internal caster culling kernel over the wide float types of simdfloat.h.
+// Every cascade shares the light rotation, so a box is moved to light space
+// once and compared with the box of each cascade there.
+
+#include "cullingkernels.h"
+
+namespace OglPlayground
+{
+namespace detail
+{
+namespace
+{
+
+template<typename F>
+size_t cullCastersKernel(
+    const glm::mat4& lightView,
+    const glm::vec3* cascadeMin,
+    const glm::vec3* cascadeMax,
+    size_t cascadeCount,
+    const BoxArrays& boxes,
+    size_t first,
+    size_t count,
+    uint32_t*& casters,
+    uint8_t*& masks)
+{
+  size_t i = first;
+  for(; i + F::width <= count; i += F::width) {
+    const F cx = F::load(boxes.centerX+i);
+    const F cy = F::load(boxes.centerY+i);
+    const F cz = F::load(boxes.centerZ+i);
+    const F ex = F::load(boxes.extentX+i);
+    const F ey = F::load(boxes.extentY+i);
+    const F ez = F::load(boxes.extentZ+i);
+    // Light space bounds of the box
+    F lo[3], hi[3];
+    for(int a = 0; a < 3; ++a) {
+      const F center = F::set1(column_(lightView, 0)[a])*cx + F::set1(column_(lightView, 1)[a])*cy + F::set1(column_(lightView, 2)[a])*cz + F::set1(column_(lightView, 3)[a]);
+      const F extent = F::set1(abs_(column_(lightView, 0)[a]))*ex + F::set1(abs_(column_(lightView, 1)[a]))*ey + F::set1(abs_(column_(lightView, 2)[a]))*ez;
+      lo[a] = center - extent;
+      hi[a] = center + extent;
+    }
+    uint32_t laneMasks[F::width] = {};
+    for(size_t c = 0; c < cascadeCount; ++c) {
+      int outside = 0;
+      for(int a = 0; a < 3; ++a) {
+        outside |= lessMask(hi[a], F::set1(component_(cascadeMin[c], a)));
+        outside |= lessMask(F::set1(component_(cascadeMax[c], a)), lo[a]);
+      }
+      for(size_t k = 0; k < F::width; ++k) {
+        laneMasks[k] |= (((outside >> k) & 1) ^ 1) << c;
+      }
+    }
+    compactMasks(casters, masks, (uint32_t)i, laneMasks, F::width);
+  }
+  return i;
+}
+
+} // anonymous namespace
+} // namespace detail
+} // namespace OglPlayground
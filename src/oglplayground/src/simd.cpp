@@ -0,0 +1,56 @@
+#include <oglplayground/simd.h>
+
+#if defined(_MSC_VER) && defined(OGLPLAYGROUND_AVX2)
+#include <intrin.h>
+#include <immintrin.h>
+#endif
+
+namespace OglPlayground
+{
+namespace
+{
+
+bool cpuHasAVX2_()
+{
+#if !defined(OGLPLAYGROUND_AVX2)
+  return false;
+#elif defined(_MSC_VER)
+  int info[4];
+  __cpuid(info, 1);
+  const bool osxsave = (info[2] & (1 << 27)) != 0;
+  const bool avx = (info[2] & (1 << 28)) != 0;
+  if(!osxsave || !avx) return false;
+  // The OS must save the ymm registers
+  if((_xgetbv(0) & 0x6) != 0x6) return false;
+  __cpuidex(info, 7, 0);
+  return (info[1] & (1 << 5)) != 0;
+#else
+  return __builtin_cpu_supports("avx2") != 0;
+#endif
+}
+
+SimdLevel detectSimdLevel_()
+{
+  if(cpuHasAVX2_()) return SimdLevel::AVX2;
+#ifdef OGLPLAYGROUND_SSE2
+  return SimdLevel::SSE2;
+#else
+  return SimdLevel::Scalar;
+#endif
+}
+
+} // anonymous namespace
+
+SimdLevel maxSimdLevel()
+{
+  static const SimdLevel level = detectSimdLevel_();
+  return level;
+}
+
+SimdLevel supportedSimdLevel(SimdLevel requested)
+{
+  const SimdLevel available = maxSimdLevel();
+  return requested < available ? requested : available;
+}
+
+} // namespace OglPlayground
@@ -0,0 +1,173 @@
+#pragma once
+
+// Internal wide float types used to write a kernel once and instantiate it
+// for every instruction set. Float8 is only visible in files built with avx2.
+
+#include <oglplayground/simd.h>
+
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+
+#ifdef OGLPLAYGROUND_SSE2
+#include <emmintrin.h>
+#endif
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif
+
+namespace OglPlayground
+{
+namespace detail
+{
+// Internal linkage: files built with avx2 include these too, and at -O0
+// their VEX encoded copies must not replace the ones of the baseline files
+namespace
+{
+
+// Scalar access without the glm and std inline functions, the same reason
+inline float component_(const glm::vec3& v, int c) { return (&v.x)[c]; }
+inline float* column_(glm::mat4& m, int c) { return reinterpret_cast<float*>(&m) + 4*c; }
+inline const float* column_(const glm::mat4& m, int c) { return reinterpret_cast<const float*>(&m) + 4*c; }
+inline float abs_(float f) { return f < 0.f ? -f : f; }
+
+#ifdef OGLPLAYGROUND_SSE2
+struct Float4
+{
+  static const size_t width = 4;
+  __m128 v;
+
+  static Float4 set1(float f) { return {_mm_set1_ps(f)}; }
+  static Float4 zero() { return {_mm_setzero_ps()}; }
+  static Float4 load(const float* p) { return {_mm_loadu_ps(p)}; }
+  void store(float* p) const { _mm_storeu_ps(p, v); }
+
+  // One component of consecutive vec3
+  static Float4 gather(const glm::vec3* p, int c) {
+    return {_mm_setr_ps(component_(p[0], c), component_(p[1], c), component_(p[2], c), component_(p[3], c))};
+  }
+
+  // Consecutive quaternions to one register per component
+  static void loadQuats(const glm::quat* q, Float4& x, Float4& y, Float4& z, Float4& w) {
+    x.v = _mm_loadu_ps(&q[0].x);
+    y.v = _mm_loadu_ps(&q[1].x);
+    z.v = _mm_loadu_ps(&q[2].x);
+    w.v = _mm_loadu_ps(&q[3].x);
+    _MM_TRANSPOSE4_PS(x.v, y.v, z.v, w.v);
+  }
+
+  // Inverse of loadQuats
+  static void storeQuats(glm::quat* q, Float4 x, Float4 y, Float4 z, Float4 w) {
+    _MM_TRANSPOSE4_PS(x.v, y.v, z.v, w.v);
+    _mm_storeu_ps(&q[0].x, x.v);
+    _mm_storeu_ps(&q[1].x, y.v);
+    _mm_storeu_ps(&q[2].x, z.v);
+    _mm_storeu_ps(&q[3].x, w.v);
+  }
+
+  // elements[column][row] holds that element for each lane's matrix
+  static void storeMatrices(glm::mat4* matrices, Float4 (&elements)[4][4]) {
+    for(int c = 0; c < 4; ++c) {
+      _MM_TRANSPOSE4_PS(elements[c][0].v, elements[c][1].v, elements[c][2].v, elements[c][3].v);
+      for(int k = 0; k < 4; ++k) _mm_storeu_ps(column_(matrices[k], c), elements[c][k].v);
+    }
+  }
+};
+
+inline Float4 operator+(Float4 a, Float4 b) { return {_mm_add_ps(a.v, b.v)}; }
+inline Float4 operator-(Float4 a, Float4 b) { return {_mm_sub_ps(a.v, b.v)}; }
+inline Float4 operator*(Float4 a, Float4 b) { return {_mm_mul_ps(a.v, b.v)}; }
+inline Float4 operator/(Float4 a, Float4 b) { return {_mm_div_ps(a.v, b.v)}; }
+inline Float4 operator-(Float4 a) { return {_mm_xor_ps(a.v, _mm_set1_ps(-0.f))}; }
+inline Float4 min(Float4 a, Float4 b) { return {_mm_min_ps(a.v, b.v)}; }
+inline Float4 max(Float4 a, Float4 b) { return {_mm_max_ps(a.v, b.v)}; }
+inline Float4 sqrt(Float4 a) { return {_mm_sqrt_ps(a.v)}; }
+// Bit k set when lane k of a is lower than b
+inline int lessMask(Float4 a, Float4 b) { return _mm_movemask_ps(_mm_cmplt_ps(a.v, b.v)); }
+// Per lane a < b ? ifLess : otherwise
+inline Float4 selectLess(Float4 a, Float4 b, Float4 ifLess, Float4 otherwise) {
+  const __m128 mask = _mm_cmplt_ps(a.v, b.v);
+  return {_mm_or_ps(_mm_and_ps(mask, ifLess.v), _mm_andnot_ps(mask, otherwise.v))};
+}
+#endif
+
+#ifdef __AVX2__
+struct Float8
+{
+  static const size_t width = 8;
+  __m256 v;
+
+  static Float8 set1(float f) { return {_mm256_set1_ps(f)}; }
+  static Float8 zero() { return {_mm256_setzero_ps()}; }
+  static Float8 load(const float* p) { return {_mm256_loadu_ps(p)}; }
+  void store(float* p) const { _mm256_storeu_ps(p, v); }
+
+  static Float8 gather(const glm::vec3* p, int c) {
+    return {_mm256_setr_ps(
+        component_(p[0], c), component_(p[1], c), component_(p[2], c), component_(p[3], c),
+        component_(p[4], c), component_(p[5], c), component_(p[6], c), component_(p[7], c))};
+  }
+
+  // 4x4 transpose inside each 128 bits lane
+  static void transposeLanes(__m256& r0, __m256& r1, __m256& r2, __m256& r3) {
+    const __m256 t0 = _mm256_unpacklo_ps(r0, r1);
+    const __m256 t1 = _mm256_unpackhi_ps(r0, r1);
+    const __m256 t2 = _mm256_unpacklo_ps(r2, r3);
+    const __m256 t3 = _mm256_unpackhi_ps(r2, r3);
+    r0 = _mm256_shuffle_ps(t0, t2, _MM_SHUFFLE(1, 0, 1, 0));
+    r1 = _mm256_shuffle_ps(t0, t2, _MM_SHUFFLE(3, 2, 3, 2));
+    r2 = _mm256_shuffle_ps(t1, t3, _MM_SHUFFLE(1, 0, 1, 0));
+    r3 = _mm256_shuffle_ps(t1, t3, _MM_SHUFFLE(3, 2, 3, 2));
+  }
+
+  // Quaternions k and k+4 share a register so the lane transpose gives
+  // one register per component in order
+  static void loadQuats(const glm::quat* q, Float8& x, Float8& y, Float8& z, Float8& w) {
+    auto pair = [](const glm::quat& low, const glm::quat& high) {
+      return _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_loadu_ps(&low.x)), _mm_loadu_ps(&high.x), 1);
+    };
+    x.v = pair(q[0], q[4]);
+    y.v = pair(q[1], q[5]);
+    z.v = pair(q[2], q[6]);
+    w.v = pair(q[3], q[7]);
+    transposeLanes(x.v, y.v, z.v, w.v);
+  }
+
+  // Inverse of loadQuats
+  static void storeQuats(glm::quat* q, Float8 x, Float8 y, Float8 z, Float8 w) {
+    transposeLanes(x.v, y.v, z.v, w.v);
+    const __m256 lanes[4] = {x.v, y.v, z.v, w.v};
+    for(int k = 0; k < 4; ++k) {
+      _mm_storeu_ps(&q[k].x, _mm256_castps256_ps128(lanes[k]));
+      _mm_storeu_ps(&q[k+4].x, _mm256_extractf128_ps(lanes[k], 1));
+    }
+  }
+
+  // Low lanes hold matrices 0..3, high lanes 4..7
+  static void storeMatrices(glm::mat4* matrices, Float8 (&elements)[4][4]) {
+    for(int c = 0; c < 4; ++c) {
+      transposeLanes(elements[c][0].v, elements[c][1].v, elements[c][2].v, elements[c][3].v);
+      for(int k = 0; k < 4; ++k) {
+        _mm_storeu_ps(column_(matrices[k], c), _mm256_castps256_ps128(elements[c][k].v));
+        _mm_storeu_ps(column_(matrices[k+4], c), _mm256_extractf128_ps(elements[c][k].v, 1));
+      }
+    }
+  }
+};
+
+inline Float8 operator+(Float8 a, Float8 b) { return {_mm256_add_ps(a.v, b.v)}; }
+inline Float8 operator-(Float8 a, Float8 b) { return {_mm256_sub_ps(a.v, b.v)}; }
+inline Float8 operator*(Float8 a, Float8 b) { return {_mm256_mul_ps(a.v, b.v)}; }
+inline Float8 operator/(Float8 a, Float8 b) { return {_mm256_div_ps(a.v, b.v)}; }
+inline Float8 operator-(Float8 a) { return {_mm256_xor_ps(a.v, _mm256_set1_ps(-0.f))}; }
+inline Float8 min(Float8 a, Float8 b) { return {_mm256_min_ps(a.v, b.v)}; }
+inline Float8 max(Float8 a, Float8 b) { return {_mm256_max_ps(a.v, b.v)}; }
+inline Float8 sqrt(Float8 a) { return {_mm256_sqrt_ps(a.v)}; }
+inline int lessMask(Float8 a, Float8 b) { return _mm256_movemask_ps(_mm256_cmp_ps(a.v, b.v, _CMP_LT_OQ)); }
+inline Float8 selectLess(Float8 a, Float8 b, Float8 ifLess, Float8 otherwise) {
+  return {_mm256_blendv_ps(otherwise.v, ifLess.v, _mm256_cmp_ps(a.v, b.v, _CMP_LT_OQ))};
+}
+#endif
+
+} // anonymous namespace
+} // namespace detail
+} // namespace OglPlayground
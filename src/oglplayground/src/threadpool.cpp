@@ -0,0 +1,153 @@
+#include <oglplayground/threadpool.h>
+
+#include <algorithm>
+#include <cassert>
+#include <deque>
+
+namespace OglPlayground
+{
+namespace
+{
+
+// Queue owned by the current thread, if it is a worker of that pool
+thread_local const void* currentPool_ = nullptr;
+thread_local size_t currentQueue_ = 0;
+
+} // anonymous namespace
+
+struct ThreadPool::Job
+{
+  const RangeFunction* fn = nullptr;
+  std::atomic<size_t> remaining;
+};
+
+struct ThreadPool::Queue
+{
+  std::mutex mutex;
+  std::deque<Task> tasks;
+};
+
+ThreadPool::ThreadPool(size_t threadCount) : pendingTasks_(0)
+{
+  threadCount = std::max<size_t>(threadCount, 1);
+  for(size_t i = 0; i < threadCount; ++i) {
+    queues_.emplace_back(new Queue);
+  }
+  for(size_t i = 0; i+1 < threadCount; ++i) {
+    threads_.emplace_back([this, i]() { workerLoop(i); });
+  }
+}
+
+ThreadPool::~ThreadPool()
+{
+  {
+    std::lock_guard<std::mutex> lock(wakeMutex_);
+    stop_ = true;
+  }
+  wake_.notify_all();
+  for(auto& thread : threads_) thread.join();
+}
+
+size_t ThreadPool::size() const
+{
+  return threads_.size()+1;
+}
+
+void ThreadPool::parallelFor(size_t count, size_t grainSize, const RangeFunction& fn)
+{
+  if(count == 0) return;
+  grainSize = std::max<size_t>(grainSize, 1);
+  const size_t chunkCount = (count+grainSize-1) / grainSize;
+  if(threads_.empty() || chunkCount == 1) {
+    for(size_t begin = 0; begin < count; begin += grainSize) {
+      fn(begin, std::min(begin+grainSize, count));
+    }
+    return;
+  }
+
+  Job job;
+  job.fn = &fn;
+  job.remaining = chunkCount;
+
+  // Counted before being pushed so the counter never goes below zero
+  {
+    std::lock_guard<std::mutex> lock(wakeMutex_);
+    pendingTasks_ += chunkCount;
+  }
+  // Deal chunks to every queue, the caller's first so it starts right away
+  const size_t first = currentQueue();
+  for(size_t chunk = 0; chunk < chunkCount; ++chunk) {
+    Queue& queue = *queues_[(first+chunk) % queues_.size()];
+    const size_t begin = chunk*grainSize;
+    std::lock_guard<std::mutex> lock(queue.mutex);
+    queue.tasks.push_back({&job, begin, std::min(begin+grainSize, count)});
+  }
+  wake_.notify_all();
+
+  // Help until every chunk of this job ran, possibly running other jobs' tasks
+  Task task;
+  while(job.remaining.load() != 0) {
+    if(popOrSteal(first, task)) {
+      run(task);
+    } else {
+      std::this_thread::yield();
+    }
+  }
+}
+
+void ThreadPool::workerLoop(size_t index)
+{
+  currentPool_ = this;
+  currentQueue_ = index;
+  Task task;
+  for(;;) {
+    if(popOrSteal(index, task)) {
+      run(task);
+      continue;
+    }
+    std::unique_lock<std::mutex> lock(wakeMutex_);
+    wake_.wait(lock, [this]() { return stop_ || pendingTasks_.load() != 0; });
+    if(stop_) return;
+  }
+}
+
+bool ThreadPool::popOrSteal(size_t index, Task& task)
+{
+  // Own queue from the back, most recently pushed work is the hottest
+  {
+    Queue& queue = *queues_[index];
+    std::lock_guard<std::mutex> lock(queue.mutex);
+    if(!queue.tasks.empty()) {
+      task = queue.tasks.back();
+      queue.tasks.pop_back();
+      return true;
+    }
+  }
+  // Other queues from the front
+  for(size_t i = 1; i < queues_.size(); ++i) {
+    Queue& queue = *queues_[(index+i) % queues_.size()];
+    std::lock_guard<std::mutex> lock(queue.mutex);
+    if(!queue.tasks.empty()) {
+      task = queue.tasks.front();
+      queue.tasks.pop_front();
+      return true;
+    }
+  }
+  return false;
+}
+
+void ThreadPool::run(const Task& task)
+{
+  --pendingTasks_;
+  (*task.job->fn)(task.begin, task.end);
+  // Last access to the job, the thread waiting on it may return right after
+  --task.job->remaining;
+}
+
+size_t ThreadPool::currentQueue() const
+{
+  if(currentPool_ == this) return currentQueue_;
+  return queues_.size()-1;
+}
+
+} // namespace OglPlayground
@@ -1,18 +1,82 @@
 #include <oglplayground/transform.h>
 
+#include <atomic>
+#include <cassert>
+
+#include <glm/gtc/matrix_inverse.hpp>
 #include <glm/gtc/matrix_transform.hpp>
 #include <glm/gtc/type_ptr.hpp>
 #include <glm/gtx/quaternion.hpp>
 
 #include <oglplayground/debug.h>
+#include <oglplayground/transformhierarchy.h>
 
 namespace OglPlayground
 {
+namespace
+{
+
+std::atomic<uint64_t> lastVersion_{0};
+
+} // anonymous namespace
+
+uint64_t newTransformVersion() {
+  return lastVersion_.fetch_add(1, std::memory_order_relaxed) + 1;
+}
 
 const glm::vec3 Transform::worldForward = glm::vec3(0.f, 0.f, 1.f);
 const glm::vec3 Transform::worldUp = glm::vec3(0.f, 1.f, 0.f);
 const glm::vec3 Transform::worldRight = glm::vec3(1.f, 0.f, 0.f);
 
+glm::mat4 matrixFromTRS(const glm::vec3& position, const glm::quat& rotation, const glm::vec3& scale) {
+  glm::mat4 trs = glm::translate(glm::mat4(1.0f), position);
+  trs *= glm::mat4_cast(rotation);
+  trs *= glm::scale(glm::mat4(1.0f), scale);
+  return trs;
+}
+
+glm::mat4 inverseMatrixFromTRS(const glm::vec3& position, const glm::quat& rotation, const glm::vec3& scale) {
+  // Rows of the inverse are the rotation columns divided by their scale.
+  // Operation order is shared with the batched kernels of trskernels.h
+  const glm::mat3 r = glm::mat3_cast(rotation);
+  const glm::vec3 invScale = 1.f / scale;
+  glm::mat4 inverse(1.f);
+  for(int row = 0; row < 3; ++row) {
+    inverse[0][row] = r[row][0] * invScale[row];
+    inverse[1][row] = r[row][1] * invScale[row];
+    inverse[2][row] = r[row][2] * invScale[row];
+    inverse[3][row] = -(r[row][0] * position.x + r[row][1] * position.y + r[row][2] * position.z) * invScale[row];
+  }
+  return inverse;
+}
+
+Transform::Transform(TransformHierarchy* hierarchy, uint32_t node)
+    : hierarchy_(hierarchy)
+    , node_(node)
+{
+  assert(hierarchy_ != nullptr && hierarchy_->isValid(node_));
+}
+
+Transform& Transform::operator=(const Transform& other) {
+  hierarchy_ = other.hierarchy_;
+  node_ = other.node_;
+  position_ = other.position_;
+  rotation_ = other.rotation_;
+  scale_ = other.scale_;
+  version_ = newTransformVersion();
+  localToWorldVersion_ = UINT64_MAX;
+  worldToLocalVersion_ = UINT64_MAX;
+  return *this;
+}
+
+TransformHierarchy* Transform::hierarchy() const {
+  return hierarchy_;
+}
+
+uint32_t Transform::node() const {
+  return node_;
+}
+
 glm::vec3 Transform::forward() const {
   return glm::rotate(rotation(), worldForward);
 }
@@ -26,57 +90,99 @@ glm::vec3 Transform::right() const {
 }
 
 const glm::vec3& Transform::localPosition() const {
+  if(hierarchy_ != nullptr) return hierarchy_->localPosition(node_);
   return position_;
 }
 
 const glm::quat& Transform::localRotation() const {
+  if(hierarchy_ != nullptr) return hierarchy_->localRotation(node_);
   return rotation_;
 }
 
 const glm::vec3& Transform::localScale() const {
+  if(hierarchy_ != nullptr) return hierarchy_->localScale(node_);
   return scale_;
 }
 
 void Transform::setLocalPosition(const glm::vec3& position) {
+  if(hierarchy_ != nullptr) {
+    hierarchy_->setLocalPosition(node_, position);
+    return;
+  }
   position_ = position;
+  flagDirty();
 }
 
 void Transform::setLocalRotation(const glm::quat& rotation) {
+  if(hierarchy_ != nullptr) {
+    hierarchy_->setLocalRotation(node_, rotation);
+    return;
+  }
   rotation_ = rotation;
+  flagDirty();
 }
 
 void Transform::setLocalScale(const glm::vec3& scale) {
+  if(hierarchy_ != nullptr) {
+    hierarchy_->setLocalScale(node_, scale);
+    return;
+  }
   scale_ = scale;
+  flagDirty();
 }
 
 glm::vec3 Transform::position() const {
+  if(hierarchy_ != nullptr) return hierarchy_->position(node_);
   return localPosition();
 }
 
 glm::quat Transform::rotation() const {
+  if(hierarchy_ != nullptr) return hierarchy_->rotation(node_);
   return localRotation();
 }
 
 glm::vec3 Transform::scale() const {
+  if(hierarchy_ != nullptr) return hierarchy_->scale(node_);
   return localScale();
 }
 
+uint64_t Transform::version() const {
+  if(hierarchy_ != nullptr) return hierarchy_->version(node_);
+  return version_;
+}
+
 glm::mat4 Transform::localToWorldMatrix() const {
-  glm::mat4 trs = glm::translate(glm::mat4(1.0f), position_);
-  trs *= glm::mat4_cast(rotation_);
-  trs *= glm::scale(glm::mat4(1.0f), scale_);
-  return trs;
+  const uint64_t currentVersion = version();
+  if(localToWorldVersion_ != currentVersion) {
+    if(hierarchy_ != nullptr) {
+      localToWorld_ = hierarchy_->localToWorldMatrix(node_);
+    } else {
+      localToWorld_ = matrixFromTRS(position_, rotation_, scale_);
+    }
+    localToWorldVersion_ = currentVersion;
+  }
+  return localToWorld_;
 }
 
 glm::mat4 Transform::worldToLocalMatrix() const {
-  return glm::inverse(localToWorldMatrix());
+  const uint64_t currentVersion = version();
+  if(worldToLocalVersion_ != currentVersion) {
+    if(hierarchy_ != nullptr) {
+      // Parent scales can shear the world matrix, but it stays affine
+      worldToLocal_ = glm::affineInverse(localToWorldMatrix());
+    } else {
+      worldToLocal_ = inverseMatrixFromTRS(position_, rotation_, scale_);
+    }
+    worldToLocalVersion_ = currentVersion;
+  }
+  return worldToLocal_;
 }
 
 void Transform::translate(const glm::vec3& translation, Space space) {
   if(space == Space::Local) {
-    position_ += right()*translation.x+up()*translation.y+forward()*translation.z;
+    translateInWorld(right()*translation.x+up()*translation.y+forward()*translation.z);
   } else if(space == Space::World) {
-    position_ += translation;
+    translateInWorld(translation);
   } else {
     assert(false && "Unsupported space");
   }
@@ -84,9 +190,9 @@ void Transform::translate(const glm::vec3& translation, Space space) {
 
 void Transform::rotate(const glm::vec3& eulerAngles, Space space) {
   if(space == Space::Local) {
-    rotation_ = rotation_ * glm::quat(glm::radians(eulerAngles));
+    setLocalRotation(localRotation() * glm::quat(glm::radians(eulerAngles)));
   } else if(space == Space::World) {
-    rotation_ = rotation_ * glm::quat(glm::radians(eulerAngles));
+    setLocalRotation(localRotation() * glm::quat(glm::radians(eulerAngles)));
   } else {
     assert(false && "Unsupported space");
   }
@@ -99,11 +205,34 @@ void Transform::lookAt(const glm::vec3& target, glm::vec3 up) {
   up = glm::normalize(glm::cross(right, direction));
   auto newUp = r1 * worldUp;
   auto r2 = glm::rotation(newUp, up);
-  setLocalRotation(r2*r1);
+  glm::quat rotation = r2*r1;
+  if(hierarchy_ != nullptr) {
+    // Express the world rotation relatively to the parent
+    const auto parent = hierarchy_->parent(node_);
+    if(parent != TransformHierarchy::invalidNode) {
+      rotation = glm::inverse(hierarchy_->rotation(parent)) * rotation;
+    }
+  }
+  setLocalRotation(rotation);
 }
 
 void Transform::scale(const glm::vec3& scale) {
-  scale_ *= scale;
+  setLocalScale(localScale() * scale);
+}
+
+void Transform::flagDirty() {
+  version_ = newTransformVersion();
+}
+
+void Transform::translateInWorld(const glm::vec3& translation) {
+  if(hierarchy_ == nullptr) {
+    position_ += translation;
+    flagDirty();
+    return;
+  }
+  // The local position lives in the parent space
+  const glm::mat4 worldToParent = glm::inverse(hierarchy_->parentToWorldMatrix(node_));
+  setLocalPosition(localPosition() + glm::vec3(worldToParent * glm::vec4(translation, 0.f)));
 }
 
 } // namespace OglPlayground
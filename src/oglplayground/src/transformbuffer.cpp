@@ -0,0 +1,95 @@
+#include <oglplayground/transformbuffer.h>
+
+#include <algorithm>
+
+namespace OglPlayground
+{
+
+TransformBuffer::TransformBuffer(size_t capacity)
+    : buffer_(GL_SHADER_STORAGE_BUFFER, capacity, nullptr, GL_STREAM_DRAW)
+    , capacity_(capacity)
+{
+}
+
+void TransformBuffer::upload(const PackedTransform* transforms, size_t count)
+{
+  packed_.clear();
+  uploadBytes(transforms, count*sizeof(PackedTransform));
+}
+
+void TransformBuffer::upload(const PackedUniformTransform* transforms, size_t count)
+{
+  packed_.clear();
+  uploadBytes(transforms, count*sizeof(PackedUniformTransform));
+}
+
+void TransformBuffer::upload(const TransformHierarchy& hierarchy, uint32_t maxGap)
+{
+  const size_t count = hierarchy.size();
+  const glm::mat4* matrices = hierarchy.worldMatrices();
+
+  // Changed ranges only cover the last update
+  const uint64_t updateCount = hierarchy.updateCount();
+  if(!packed_.empty() && updateCount == uploadedUpdate_) return;
+  const bool missedUpdates = updateCount != uploadedUpdate_+1;
+  uploadedUpdate_ = updateCount;
+
+  // Nothing to start from, everything goes
+  if(packed_.empty() || missedUpdates) {
+    packed_.resize(count);
+    packTransforms(matrices, packed_.data(), count);
+    uploadBytes(packed_.data(), count*sizeof(PackedTransform));
+    return;
+  }
+
+  packed_.resize(count);
+  hierarchy.changedRanges(ranges_, maxGap);
+  for(const IndexRange& range : ranges_) {
+    packTransforms(matrices+range.first, &packed_[range.first], range.count);
+  }
+
+  const size_t size = count*sizeof(PackedTransform);
+  if(size > capacity_) {
+    reserve(size);
+    ranges_.assign(1, {0, (uint32_t)count});
+  }
+
+  for(const IndexRange& range : ranges_) {
+    buffer_.upload(
+        range.first*sizeof(PackedTransform),
+        range.count*sizeof(PackedTransform),
+        &packed_[range.first]);
+  }
+}
+
+void TransformBuffer::bind(GLuint binding) const
+{
+  glBindBufferBase(GL_SHADER_STORAGE_BUFFER, binding, buffer_.name());
+}
+
+size_t TransformBuffer::capacity() const
+{
+  return capacity_;
+}
+
+const BufferObject& TransformBuffer::buffer() const
+{
+  return buffer_;
+}
+
+void TransformBuffer::uploadBytes(const void* data, size_t size)
+{
+  if(size > capacity_) reserve(size);
+
+  // Orphan the previous storage so the upload does not wait on draws still using it
+  buffer_.orphan();
+  buffer_.upload(0, size, data);
+}
+
+void TransformBuffer::reserve(size_t size)
+{
+  capacity_ = std::max(size, capacity_*2);
+  buffer_ = BufferObject(GL_SHADER_STORAGE_BUFFER, capacity_, nullptr, GL_STREAM_DRAW);
+}
+
+} // namespace OglPlayground
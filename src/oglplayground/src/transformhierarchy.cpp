@@ -0,0 +1,497 @@
+#include <oglplayground/transformhierarchy.h>
+#include <oglplayground/threadpool.h>
+
+#include <algorithm>
+#include <cassert>
+#include <limits>
+
+namespace OglPlayground
+{
+
+const TransformHierarchy::NodeId TransformHierarchy::invalidNode = std::numeric_limits<uint32_t>::max();
+const uint32_t TransformHierarchy::noParent = std::numeric_limits<uint32_t>::max();
+
+namespace
+{
+
+// Nodes per parallel update task, large enough to amortize the scheduling
+const size_t updateGrainSize_ = 1024;
+
+} // anonymous namespace
+
+void TransformHierarchy::reserve(size_t capacity)
+{
+  parents_.reserve(capacity);
+  positions_.reserve(capacity);
+  rotations_.reserve(capacity);
+  scales_.reserve(capacity);
+  worldMatrices_.reserve(capacity);
+  versions_.reserve(capacity);
+  worldVersions_.reserve(capacity);
+  nodes_.reserve(capacity);
+  indices_.reserve(capacity);
+}
+
+size_t TransformHierarchy::size() const
+{
+  return parents_.size();
+}
+
+TransformHierarchy::NodeId TransformHierarchy::create(NodeId parent)
+{
+  assert(parent == invalidNode || isValid(parent));
+
+  NodeId node = invalidNode;
+  if(freeNodes_.empty()) {
+    node = (NodeId)indices_.size();
+    indices_.push_back(noParent);
+  } else {
+    node = freeNodes_.back();
+    freeNodes_.pop_back();
+  }
+
+  // Appending keeps the parent-before-child order since the parent already exists
+  const uint32_t index = (uint32_t)parents_.size();
+
+  // Levels stay valid as long as the node lands in the deepest or a new level
+  if(levelsValid_) {
+    size_t depth = 0;
+    if(parent != invalidNode) {
+      const uint32_t parentIndex = indices_[parent];
+      depth = std::upper_bound(levels_.begin(), levels_.end(), parentIndex) - levels_.begin();
+    }
+    if(depth+2 == levels_.size()) ++levels_.back();
+    else if(depth+1 == levels_.size()) levels_.push_back(index+1);
+    else levelsValid_ = false;
+  }
+
+  indices_[node] = index;
+  nodes_.push_back(node);
+  parents_.push_back(parent == invalidNode ? noParent : indices_[parent]);
+  positions_.push_back(glm::vec3(0.f));
+  rotations_.push_back(glm::quat(1.0, 0.0, 0.0, 0.0));
+  scales_.push_back(glm::vec3(1.f));
+  worldMatrices_.push_back(glm::mat4(1.f));
+  versions_.push_back(newTransformVersion());
+  worldVersions_.push_back(0);
+  return node;
+}
+
+void TransformHierarchy::destroy(NodeId node)
+{
+  assert(isValid(node));
+  if(!isValid(node)) return;
+
+  // Children are stored after their parent, so one forward pass flags the whole subtree
+  const uint32_t first = indices_[node];
+  const size_t count = parents_.size();
+  std::vector<bool> removed(count, false);
+  removed[first] = true;
+  for(size_t i = first+1; i < count; ++i) {
+    removed[i] = parents_[i] != noParent && removed[parents_[i]];
+  }
+
+  // Stable compaction, remaining nodes keep their relative order
+  std::vector<uint32_t> remap(count, noParent);
+  uint32_t dst = first;
+  for(uint32_t i = first; i < count; ++i) {
+    if(removed[i]) {
+      indices_[nodes_[i]] = noParent;
+      freeNodes_.push_back(nodes_[i]);
+      continue;
+    }
+    remap[i] = dst;
+    const uint32_t parent = parents_[i];
+    parents_[dst] = (parent == noParent || parent < first) ? parent : remap[parent];
+    positions_[dst] = positions_[i];
+    rotations_[dst] = rotations_[i];
+    scales_[dst] = scales_[i];
+    worldMatrices_[dst] = worldMatrices_[i];
+    versions_[dst] = versions_[i];
+    worldVersions_[dst] = worldVersions_[i];
+    nodes_[dst] = nodes_[i];
+    indices_[nodes_[dst]] = dst;
+    ++dst;
+  }
+
+  parents_.resize(dst);
+  positions_.resize(dst);
+  rotations_.resize(dst);
+  scales_.resize(dst);
+  worldMatrices_.resize(dst);
+  versions_.resize(dst);
+  worldVersions_.resize(dst);
+  nodes_.resize(dst);
+  levelsValid_ = false;
+  movedFrom_ = std::min(movedFrom_, first);
+}
+
+bool TransformHierarchy::isValid(NodeId node) const
+{
+  return node < indices_.size() && indices_[node] != noParent;
+}
+
+void TransformHierarchy::setParent(NodeId node, NodeId parent)
+{
+  assert(isValid(node));
+  assert(parent == invalidNode || isValid(parent));
+
+  const uint32_t index = indices_[node];
+  if(parent == invalidNode) {
+    parents_[index] = noParent;
+    flagDirty(index);
+    levelsValid_ = false;
+    return;
+  }
+
+  // Refuse to create a cycle
+  const uint32_t parentIndex = indices_[parent];
+  for(uint32_t i = parentIndex; i != noParent; i = parents_[i]) {
+    assert(i != index && "A node cannot be parented to one of its descendants");
+    if(i == index) return;
+  }
+
+  parents_[index] = parentIndex;
+  flagDirty(index);
+  levelsValid_ = false;
+  if(parentIndex > index) sortByDepth();
+}
+
+TransformHierarchy::NodeId TransformHierarchy::parent(NodeId node) const
+{
+  assert(isValid(node));
+  const uint32_t parent = parents_[indices_[node]];
+  return parent == noParent ? invalidNode : nodes_[parent];
+}
+
+Transform TransformHierarchy::transform(NodeId node)
+{
+  assert(isValid(node));
+  return Transform(this, node);
+}
+
+const glm::vec3& TransformHierarchy::localPosition(NodeId node) const
+{
+  return positions_[indexOf(node)];
+}
+
+const glm::quat& TransformHierarchy::localRotation(NodeId node) const
+{
+  return rotations_[indexOf(node)];
+}
+
+const glm::vec3& TransformHierarchy::localScale(NodeId node) const
+{
+  return scales_[indexOf(node)];
+}
+
+void TransformHierarchy::setLocalPosition(NodeId node, const glm::vec3& position)
+{
+  const uint32_t index = indexOf(node);
+  positions_[index] = position;
+  flagDirty(index);
+}
+
+void TransformHierarchy::setLocalRotation(NodeId node, const glm::quat& rotation)
+{
+  const uint32_t index = indexOf(node);
+  rotations_[index] = rotation;
+  flagDirty(index);
+}
+
+void TransformHierarchy::setLocalScale(NodeId node, const glm::vec3& scale)
+{
+  const uint32_t index = indexOf(node);
+  scales_[index] = scale;
+  flagDirty(index);
+}
+
+void TransformHierarchy::setLocalPositions(const NodeId* nodes, const glm::vec3* positions, size_t count)
+{
+  const uint64_t version = newTransformVersion();
+  for(size_t i = 0; i < count; ++i) {
+    const uint32_t index = indexOf(nodes[i]);
+    positions_[index] = positions[i];
+    versions_[index] = version;
+  }
+}
+
+void TransformHierarchy::setLocalRotations(const NodeId* nodes, const glm::quat* rotations, size_t count)
+{
+  const uint64_t version = newTransformVersion();
+  for(size_t i = 0; i < count; ++i) {
+    const uint32_t index = indexOf(nodes[i]);
+    rotations_[index] = rotations[i];
+    versions_[index] = version;
+  }
+}
+
+void TransformHierarchy::setLocalScales(const NodeId* nodes, const glm::vec3* scales, size_t count)
+{
+  const uint64_t version = newTransformVersion();
+  for(size_t i = 0; i < count; ++i) {
+    const uint32_t index = indexOf(nodes[i]);
+    scales_[index] = scales[i];
+    versions_[index] = version;
+  }
+}
+
+glm::vec3 TransformHierarchy::position(NodeId node) const
+{
+  return glm::vec3(localToWorldMatrix(node)[3]);
+}
+
+glm::quat TransformHierarchy::rotation(NodeId node) const
+{
+  uint32_t index = indexOf(node);
+  glm::quat rotation = rotations_[index];
+  for(index = parents_[index]; index != noParent; index = parents_[index]) {
+    rotation = rotations_[index] * rotation;
+  }
+  return rotation;
+}
+
+glm::vec3 TransformHierarchy::scale(NodeId node) const
+{
+  // Lossy scale, shearing introduced by non uniform parent scales is ignored
+  uint32_t index = indexOf(node);
+  glm::vec3 scale = scales_[index];
+  for(index = parents_[index]; index != noParent; index = parents_[index]) {
+    scale *= scales_[index];
+  }
+  return scale;
+}
+
+uint64_t TransformHierarchy::version(NodeId node) const
+{
+  return chainVersion(indexOf(node));
+}
+
+glm::mat4 TransformHierarchy::localToWorldMatrix(NodeId node) const
+{
+  return worldMatrix(indexOf(node));
+}
+
+glm::mat4 TransformHierarchy::parentToWorldMatrix(NodeId node) const
+{
+  const uint32_t parent = parents_[indexOf(node)];
+  if(parent == noParent) return glm::mat4(1.f);
+  return worldMatrix(parent);
+}
+
+void TransformHierarchy::update()
+{
+  const uint32_t count = (uint32_t)parents_.size();
+  outdated_.resize(count);
+  updateRange(0, count);
+  flagMoved();
+  ++updateCount_;
+}
+
+void TransformHierarchy::update(ThreadPool& pool)
+{
+  if(!levelsValid_) sortByDepth();
+  outdated_.resize(parents_.size());
+
+  // Parents of a level are all in the previous ones, so its nodes are independent
+  for(size_t d = 0; d+1 < levels_.size(); ++d) {
+    const uint32_t first = levels_[d];
+    pool.parallelFor(levels_[d+1]-first, updateGrainSize_, [this, first](size_t begin, size_t end) {
+      updateRange(first+(uint32_t)begin, first+(uint32_t)end);
+    });
+  }
+  flagMoved();
+  ++updateCount_;
+}
+
+uint64_t TransformHierarchy::updateCount() const
+{
+  return updateCount_;
+}
+
+void TransformHierarchy::changedRanges(std::vector<IndexRange>& ranges, uint32_t maxGap) const
+{
+  ranges.clear();
+  const uint32_t count = (uint32_t)outdated_.size();
+  uint32_t i = 0;
+  while(i < count) {
+    if(!outdated_[i]) {
+      ++i;
+      continue;
+    }
+    uint32_t last = i+1;
+    while(last < count && outdated_[last]) ++last;
+    if(!ranges.empty() && i - (ranges.back().first + ranges.back().count) <= maxGap) {
+      ranges.back().count = last - ranges.back().first;
+    } else {
+      ranges.push_back({i, last-i});
+    }
+    i = last;
+  }
+}
+
+uint32_t TransformHierarchy::indexOf(NodeId node) const
+{
+  assert(isValid(node));
+  return indices_[node];
+}
+
+TransformHierarchy::NodeId TransformHierarchy::nodeAt(uint32_t index) const
+{
+  assert(index < nodes_.size());
+  return nodes_[index];
+}
+
+const uint32_t* TransformHierarchy::parentIndices() const
+{
+  return parents_.data();
+}
+
+const glm::vec3* TransformHierarchy::localPositions() const
+{
+  return positions_.data();
+}
+
+const glm::quat* TransformHierarchy::localRotations() const
+{
+  return rotations_.data();
+}
+
+const glm::vec3* TransformHierarchy::localScales() const
+{
+  return scales_.data();
+}
+
+const glm::mat4* TransformHierarchy::worldMatrices() const
+{
+  return worldMatrices_.data();
+}
+
+void TransformHierarchy::flagDirty(uint32_t index)
+{
+  versions_[index] = newTransformVersion();
+}
+
+uint64_t TransformHierarchy::chainVersion(uint32_t index) const
+{
+  // Reparenting stamps the node, so the max over the chain never decreases
+  uint64_t version = versions_[index];
+  for(index = parents_[index]; index != noParent; index = parents_[index]) {
+    version = std::max(version, versions_[index]);
+  }
+  return version;
+}
+
+glm::mat4 TransformHierarchy::worldMatrix(uint32_t index) const
+{
+  if(chainVersion(index) == worldVersions_[index]) return worldMatrices_[index];
+
+  // Same multiplication order as update() so both paths give identical results
+  const glm::mat4 local = matrixFromTRS(positions_[index], rotations_[index], scales_[index]);
+  const uint32_t parent = parents_[index];
+  if(parent == noParent) return local;
+  return worldMatrix(parent) * local;
+}
+
+void TransformHierarchy::updateRange(uint32_t first, uint32_t last)
+{
+  // Flag the nodes whose chain changed, parents are processed first so their
+  // chain version is already up to date
+  for(uint32_t i = first; i < last; ++i) {
+    const uint32_t parent = parents_[i];
+    uint64_t version = versions_[i];
+    if(parent != noParent) version = std::max(version, worldVersions_[parent]);
+    outdated_[i] = version != worldVersions_[i];
+    worldVersions_[i] = version;
+  }
+
+  // Compose local matrices of each outdated run in batch, then apply parents in order
+  uint32_t begin = first;
+  while(begin < last) {
+    if(!outdated_[begin]) {
+      ++begin;
+      continue;
+    }
+    uint32_t end = begin+1;
+    while(end < last && outdated_[end]) ++end;
+    composeMatrices(&positions_[begin], &rotations_[begin], &scales_[begin], &worldMatrices_[begin], end-begin);
+    for(uint32_t i = begin; i < end; ++i) {
+      const uint32_t parent = parents_[i];
+      if(parent != noParent) worldMatrices_[i] = worldMatrices_[parent] * worldMatrices_[i];
+    }
+    begin = end;
+  }
+}
+
+void TransformHierarchy::flagMoved()
+{
+  // Moved nodes keep their matrix but land at another index
+  const uint32_t count = (uint32_t)outdated_.size();
+  for(uint32_t i = movedFrom_; i < count; ++i) outdated_[i] = 1;
+  movedFrom_ = count;
+}
+
+void TransformHierarchy::sortByDepth()
+{
+  const size_t count = parents_.size();
+
+  // Compute depths, the order may be broken so walk up until a known depth
+  std::vector<uint32_t> depths(count, noParent);
+  std::vector<uint32_t> chain;
+  uint32_t maxDepth = 0;
+  for(uint32_t i = 0; i < count; ++i) {
+    uint32_t current = i;
+    while(current != noParent && depths[current] == noParent) {
+      chain.push_back(current);
+      current = parents_[current];
+    }
+    uint32_t depth = current == noParent ? 0 : depths[current]+1;
+    while(!chain.empty()) {
+      depths[chain.back()] = depth++;
+      chain.pop_back();
+    }
+    maxDepth = std::max(maxDepth, depths[i]);
+  }
+
+  // Stable counting sort by depth
+  std::vector<uint32_t> offsets(maxDepth+2, 0);
+  for(uint32_t depth : depths) ++offsets[depth+1];
+  for(size_t d = 1; d < offsets.size(); ++d) offsets[d] += offsets[d-1];
+  levels_ = offsets;
+  levelsValid_ = true;
+  movedFrom_ = 0;
+  std::vector<uint32_t> remap(count);
+  for(uint32_t i = 0; i < count; ++i) remap[i] = offsets[depths[i]]++;
+
+  std::vector<uint32_t> parents(count);
+  std::vector<glm::vec3> positions(count);
+  std::vector<glm::quat> rotations(count);
+  std::vector<glm::vec3> scales(count);
+  std::vector<glm::mat4> worldMatrices(count);
+  std::vector<uint64_t> versions(count);
+  std::vector<uint64_t> worldVersions(count);
+  std::vector<NodeId> nodes(count);
+  for(uint32_t i = 0; i < count; ++i) {
+    const uint32_t dst = remap[i];
+    parents[dst] = parents_[i] == noParent ? noParent : remap[parents_[i]];
+    positions[dst] = positions_[i];
+    rotations[dst] = rotations_[i];
+    scales[dst] = scales_[i];
+    worldMatrices[dst] = worldMatrices_[i];
+    versions[dst] = versions_[i];
+    worldVersions[dst] = worldVersions_[i];
+    nodes[dst] = nodes_[i];
+    indices_[nodes_[i]] = dst;
+  }
+
+  parents_.swap(parents);
+  positions_.swap(positions);
+  rotations_.swap(rotations);
+  scales_.swap(scales);
+  worldMatrices_.swap(worldMatrices);
+  versions_.swap(versions);
+  worldVersions_.swap(worldVersions);
+  nodes_.swap(nodes);
+}
+
+} // namespace OglPlayground
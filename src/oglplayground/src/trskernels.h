@@ -0,0 +1,118 @@
+#pragma once
+
+// Internal batched TRS kernels, written once over the wide float types of
+// simdfloat.h. Each kernel processes count rounded down to the lane width and
+// returns how many transforms it handled, callers finish the tail.
+
+#include "simdfloat.h"
+
+namespace OglPlayground
+{
+namespace detail
+{
+namespace
+{
+
+// r[column][row], same operations in the same order than glm::mat3_cast
+template<typename F>
+void rotationFromQuats(F qx, F qy, F qz, F qw, F (&r)[3][3])
+{
+  const F one = F::set1(1.f);
+  const F two = F::set1(2.f);
+  const F qxx = qx * qx;
+  const F qyy = qy * qy;
+  const F qzz = qz * qz;
+  const F qxz = qx * qz;
+  const F qxy = qx * qy;
+  const F qyz = qy * qz;
+  const F qwx = qw * qx;
+  const F qwy = qw * qy;
+  const F qwz = qw * qz;
+  r[0][0] = one - two * (qyy + qzz);
+  r[0][1] = two * (qxy + qwz);
+  r[0][2] = two * (qxz - qwy);
+  r[1][0] = two * (qxy - qwz);
+  r[1][1] = one - two * (qxx + qzz);
+  r[1][2] = two * (qyz + qwx);
+  r[2][0] = two * (qxz + qwy);
+  r[2][1] = two * (qyz - qwx);
+  r[2][2] = one - two * (qxx + qyy);
+}
+
+template<typename F>
+size_t composeMatricesKernel(
+    const glm::vec3* positions,
+    const glm::quat* rotations,
+    const glm::vec3* scales,
+    glm::mat4* matrices,
+    size_t count)
+{
+  const F zero = F::zero();
+  const F one = F::set1(1.f);
+  size_t i = 0;
+  for(; i+F::width <= count; i += F::width) {
+    F qx, qy, qz, qw;
+    F::loadQuats(rotations+i, qx, qy, qz, qw);
+    F r[3][3];
+    rotationFromQuats(qx, qy, qz, qw, r);
+
+    // translate * rotate * scale only scales the rotation columns
+    F m[4][4];
+    for(int c = 0; c < 3; ++c) {
+      const F s = F::gather(scales+i, c);
+      m[c][0] = r[c][0] * s;
+      m[c][1] = r[c][1] * s;
+      m[c][2] = r[c][2] * s;
+      m[c][3] = zero;
+    }
+    m[3][0] = F::gather(positions+i, 0);
+    m[3][1] = F::gather(positions+i, 1);
+    m[3][2] = F::gather(positions+i, 2);
+    m[3][3] = one;
+    F::storeMatrices(matrices+i, m);
+  }
+  return i;
+}
+
+// inverse(T*R*S) = inverse(S) * transpose(R) * inverse(T), must stay in sync
+// with inverseMatrixFromTRS
+template<typename F>
+size_t composeInverseMatricesKernel(
+    const glm::vec3* positions,
+    const glm::quat* rotations,
+    const glm::vec3* scales,
+    glm::mat4* matrices,
+    size_t count)
+{
+  const F zero = F::zero();
+  const F one = F::set1(1.f);
+  size_t i = 0;
+  for(; i+F::width <= count; i += F::width) {
+    F qx, qy, qz, qw;
+    F::loadQuats(rotations+i, qx, qy, qz, qw);
+    F r[3][3];
+    rotationFromQuats(qx, qy, qz, qw, r);
+    const F px = F::gather(positions+i, 0);
+    const F py = F::gather(positions+i, 1);
+    const F pz = F::gather(positions+i, 2);
+
+    F m[4][4];
+    for(int row = 0; row < 3; ++row) {
+      const F invScale = one / F::gather(scales+i, row);
+      m[0][row] = r[row][0] * invScale;
+      m[1][row] = r[row][1] * invScale;
+      m[2][row] = r[row][2] * invScale;
+      m[3][row] = -(r[row][0] * px + r[row][1] * py + r[row][2] * pz) * invScale;
+    }
+    m[0][3] = zero;
+    m[1][3] = zero;
+    m[2][3] = zero;
+    m[3][3] = one;
+    F::storeMatrices(matrices+i, m);
+  }
+  return i;
+}
+
+} // anonymous namespace
+} // namespace detail
+} // namespace OglPlayground
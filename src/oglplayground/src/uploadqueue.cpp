@@ -0,0 +1,206 @@
+#include <oglplayground/uploadqueue.h>
+
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+
+#include <oglplayground/bufferobject.h>
+
+namespace OglPlayground
+{
+namespace
+{
+
+// Staging offsets, enough for any pixel type and keeps small copies mergeable
+const size_t stagingAlignment_ = 4;
+
+} // anonymous namespace
+
+UploadQueue::UploadQueue(size_t frameBudget, uint32_t framesInFlight)
+    : staging_(GL_COPY_READ_BUFFER, frameBudget, framesInFlight)
+{
+}
+
+void UploadQueue::uploadBuffer(const BufferObject& destination, size_t offset, const void* data, size_t size)
+{
+  assert(offset+size <= destination.size());
+  uploadBuffer(destination.name(), offset, data, size);
+}
+
+void UploadQueue::uploadBuffer(GLuint destination, size_t offset, const void* data, size_t size)
+{
+  if(size == 0) return;
+  Upload upload = {};
+  upload.destination = destination;
+  upload.offset = offset;
+  upload.size = size;
+  upload.data = push(data, size);
+  uploads_.push_back(upload);
+}
+
+void UploadQueue::uploadTexture2D(
+    GLuint texture,
+    GLint level,
+    GLint x,
+    GLint y,
+    GLsizei width,
+    GLsizei height,
+    GLenum format,
+    GLenum type,
+    const void* data,
+    size_t size)
+{
+  Upload upload = {};
+  upload.destination = texture;
+  upload.size = size;
+  upload.data = push(data, size);
+  upload.texture = true;
+  upload.level = level;
+  upload.x = x;
+  upload.y = y;
+  upload.width = width;
+  upload.height = height;
+  upload.format = format;
+  upload.type = type;
+  uploads_.push_back(upload);
+}
+
+size_t UploadQueue::flush()
+{
+  lastCallCount_ = 0;
+  if(uploads_.empty()) return 0;
+
+  staging_.beginFrame();
+  size_t uploaded = 0;
+  while(!uploads_.empty()) {
+    Upload& upload = uploads_.front();
+    size_t source = 0;
+    if(upload.texture && upload.size > staging_.regionSize()) {
+      // Does not fit a staging region, uploaded from client memory on its
+      // own frame
+      if(uploaded > 0) break;
+      issueCopies();
+      // A bound pixel buffer would turn the pointer into an offset in it
+      glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+      glBindTexture(GL_TEXTURE_2D, upload.destination);
+      glTexSubImage2D(
+          GL_TEXTURE_2D, upload.level, upload.x, upload.y, upload.width, upload.height,
+          upload.format, upload.type, &bytes_[upload.data]);
+      glBindTexture(GL_TEXTURE_2D, 0);
+      ++lastCallCount_;
+      uploaded += upload.size;
+      pendingBytes_ -= upload.size;
+      bytesBegin_ = upload.data + upload.size;
+      uploads_.pop_front();
+      break;
+    }
+    if(upload.texture) {
+      void* staged = staging_.allocate(upload.size, stagingAlignment_, source);
+      if(!staged) break;
+      std::memcpy(staged, &bytes_[upload.data], upload.size);
+
+      // Earlier buffer copies first, in case the texture data depends on them
+      issueCopies();
+      glBindBuffer(GL_PIXEL_UNPACK_BUFFER, staging_.name());
+      glBindTexture(GL_TEXTURE_2D, upload.destination);
+      glTexSubImage2D(
+          GL_TEXTURE_2D, upload.level, upload.x, upload.y, upload.width, upload.height,
+          upload.format, upload.type, reinterpret_cast<const void*>(source));
+      glBindTexture(GL_TEXTURE_2D, 0);
+      glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+      ++lastCallCount_;
+      uploaded += upload.size;
+      pendingBytes_ -= upload.size;
+      bytesBegin_ = upload.data + upload.size;
+      uploads_.pop_front();
+      continue;
+    }
+
+    // Buffer uploads take what is left of the budget, the rest waits
+    const size_t size = std::min(upload.size, staging_.available(stagingAlignment_));
+    if(size == 0) break;
+    void* staged = staging_.allocate(size, stagingAlignment_, source);
+    std::memcpy(staged, &bytes_[upload.data], size);
+    if(!copies_.empty()
+        && copies_.back().destination == upload.destination
+        && copies_.back().source+copies_.back().size == source
+        && copies_.back().offset+copies_.back().size == upload.offset) {
+      copies_.back().size += size;
+    } else {
+      copies_.push_back({upload.destination, source, upload.offset, size});
+    }
+    uploaded += size;
+    pendingBytes_ -= size;
+    upload.offset += size;
+    upload.data += size;
+    upload.size -= size;
+    bytesBegin_ = upload.data;
+    if(upload.size == 0) uploads_.pop_front();
+  }
+  issueCopies();
+  staging_.endFrame();
+  return uploaded;
+}
+
+void UploadQueue::finish()
+{
+  // Stops when a flush makes no progress instead of spinning
+  while(!uploads_.empty()) {
+    const size_t count = uploads_.size();
+    if(flush() == 0 && uploads_.size() == count) break;
+  }
+}
+
+size_t UploadQueue::frameBudget() const
+{
+  return staging_.regionSize();
+}
+
+size_t UploadQueue::pendingBytes() const
+{
+  return pendingBytes_;
+}
+
+size_t UploadQueue::pendingCount() const
+{
+  return uploads_.size();
+}
+
+uint32_t UploadQueue::lastCallCount() const
+{
+  return lastCallCount_;
+}
+
+size_t UploadQueue::push(const void* data, size_t size)
+{
+  // Drop the flushed bytes once they are most of the storage
+  if(uploads_.empty()) {
+    bytes_.clear();
+    bytesBegin_ = 0;
+  } else if(bytesBegin_ > bytes_.size()/2) {
+    bytes_.erase(bytes_.begin(), bytes_.begin()+bytesBegin_);
+    for(auto& upload : uploads_) upload.data -= bytesBegin_;
+    bytesBegin_ = 0;
+  }
+  const size_t offset = bytes_.size();
+  const uint8_t* begin = static_cast<const uint8_t*>(data);
+  bytes_.insert(bytes_.end(), begin, begin+size);
+  pendingBytes_ += size;
+  return offset;
+}
+
+void UploadQueue::issueCopies()
+{
+  if(copies_.empty()) return;
+  glBindBuffer(GL_COPY_READ_BUFFER, staging_.name());
+  for(const Copy& copy : copies_) {
+    glBindBuffer(GL_COPY_WRITE_BUFFER, copy.destination);
+    glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, copy.source, copy.offset, copy.size);
+  }
+  glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+  glBindBuffer(GL_COPY_READ_BUFFER, 0);
+  lastCallCount_ += (uint32_t)copies_.size();
+  copies_.clear();
+}
+
+} // namespace OglPlayground
@@ -0,0 +1,161 @@
+#include <oglplayground/vertexformat.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#include "vertexkernels.h"
+
+namespace OglPlayground
+{
+
+#ifdef OGLPLAYGROUND_AVX2
+// Defined in vertexformat_avx2.cpp, built with avx2 enabled
+size_t packHalfAVX2(const float* src, uint16_t* dst, size_t count);
+size_t packSnorm8AVX2(const float* src, int8_t* dst, size_t count);
+size_t packUnorm8AVX2(const float* src, uint8_t* dst, size_t count);
+size_t packSnorm16AVX2(const float* src, int16_t* dst, size_t count);
+size_t packUnorm16AVX2(const float* src, uint16_t* dst, size_t count);
+#define AVX2_KERNEL(f) f
+#else
+#define AVX2_KERNEL(f) nullptr
+#endif
+
+namespace
+{
+
+template<typename T>
+T packNorm_(float f, float minimum, float scale)
+{
+  return (T)std::nearbyint(std::min(std::max(f, minimum), 1.f) * scale);
+}
+
+template<typename T>
+using PackNormAVX2_ = size_t (*)(const float*, T*, size_t);
+
+template<typename T>
+void packNorm_(const float* src, T* dst, size_t count, SimdLevel level, float minimum, float scale, PackNormAVX2_<T> avx2)
+{
+  size_t done = 0;
+  switch(supportedSimdLevel(level)) {
+#ifdef OGLPLAYGROUND_AVX2
+  case SimdLevel::AVX2:
+    done = avx2(src, dst, count);
+    // fallthrough, the 4 wide kernel handles part of the tail
+#endif
+#ifdef OGLPLAYGROUND_SSE2
+  case SimdLevel::SSE2:
+    done = detail::packNormKernel<detail::Float4>(src, dst, done, count, minimum, scale);
+#endif
+  default:
+    break;
+  }
+  // Clamping and rounding to nearest even, same as the kernels
+  for(size_t i = done; i < count; ++i) dst[i] = packNorm_<T>(src[i], minimum, scale);
+}
+
+} // anonymous namespace
+
+void packHalf(const float* src, uint16_t* dst, size_t count, SimdLevel level)
+{
+  size_t done = 0;
+  switch(supportedSimdLevel(level)) {
+#ifdef OGLPLAYGROUND_AVX2
+  case SimdLevel::AVX2:
+    done = packHalfAVX2(src, dst, count);
+    // fallthrough, the 4 wide kernel handles part of the tail
+#endif
+#ifdef OGLPLAYGROUND_SSE2
+  case SimdLevel::SSE2:
+    done = detail::packHalfKernel<detail::Float4>(src, dst, done, count);
+#endif
+  default:
+    break;
+  }
+  for(size_t i = done; i < count; ++i) dst[i] = floatToHalf(src[i]);
+}
+
+void packSnorm8(const float* src, int8_t* dst, size_t count, SimdLevel level)
+{
+  packNorm_(src, dst, count, level, -1.f, 127.f, AVX2_KERNEL(packSnorm8AVX2));
+}
+
+void packUnorm8(const float* src, uint8_t* dst, size_t count, SimdLevel level)
+{
+  packNorm_(src, dst, count, level, 0.f, 255.f, AVX2_KERNEL(packUnorm8AVX2));
+}
+
+void packSnorm16(const float* src, int16_t* dst, size_t count, SimdLevel level)
+{
+  packNorm_(src, dst, count, level, -1.f, 32767.f, AVX2_KERNEL(packSnorm16AVX2));
+}
+
+void packUnorm16(const float* src, uint16_t* dst, size_t count, SimdLevel level)
+{
+  packNorm_(src, dst, count, level, 0.f, 65535.f, AVX2_KERNEL(packUnorm16AVX2));
+}
+
+uint32_t packSnorm2101010(const glm::vec4& v)
+{
+  const uint32_t x = (uint32_t)packNorm_<int32_t>(v.x, -1.f, 511.f) & 0x3ff;
+  const uint32_t y = (uint32_t)packNorm_<int32_t>(v.y, -1.f, 511.f) & 0x3ff;
+  const uint32_t z = (uint32_t)packNorm_<int32_t>(v.z, -1.f, 511.f) & 0x3ff;
+  const uint32_t w = (uint32_t)packNorm_<int32_t>(v.w, -1.f, 1.f) & 0x3;
+  return x | (y << 10) | (z << 20) | (w << 30);
+}
+
+void packSnorm2101010(const glm::vec4* src, uint32_t* dst, size_t count)
+{
+  for(size_t i = 0; i < count; ++i) dst[i] = packSnorm2101010(src[i]);
+}
+
+uint16_t floatToHalf(float f)
+{
+  // Round to nearest even through float addition, as the simd kernels do
+  uint32_t u;
+  std::memcpy(&u, &f, 4);
+  const uint32_t sign = u & 0x80000000u;
+  u ^= sign;
+
+  uint32_t h;
+  if(u >= ((127 + 16) << 23)) {
+    // Infinity, or quiet NaN
+    h = u > (255 << 23) ? 0x7e00 : 0x7c00;
+  } else if(u < (113 << 23)) {
+    // Denormal or zero, the magic addition aligns the mantissa bits
+    const uint32_t magic = ((127 - 15) + (23 - 10) + 1) << 23;
+    float magicFloat, value;
+    std::memcpy(&magicFloat, &magic, 4);
+    std::memcpy(&value, &u, 4);
+    value += magicFloat;
+    std::memcpy(&h, &value, 4);
+    h -= magic;
+  } else {
+    const uint32_t mantissaOdd = (u >> 13) & 1;
+    h = (u + 0xc8000fffu + mantissaOdd) >> 13;
+  }
+  return (uint16_t)(h | (sign >> 16));
+}
+
+float halfToFloat(uint16_t h)
+{
+  const uint32_t sign = uint32_t(h & 0x8000) << 16;
+  const uint32_t exponent = (h >> 10) & 0x1f;
+  const uint32_t mantissa = h & 0x3ff;
+  uint32_t u;
+  if(exponent == 0x1f) {
+    u = sign | 0x7f800000u | (mantissa << 13);
+  } else if(exponent == 0) {
+    // Denormals are exact in float
+    const float value = std::ldexp((float)mantissa, -24);
+    std::memcpy(&u, &value, 4);
+    u |= sign;
+  } else {
+    u = sign | ((exponent + 127 - 15) << 23) | (mantissa << 13);
+  }
+  float f;
+  std::memcpy(&f, &u, 4);
+  return f;
+}
+
+} // namespace OglPlayground
@@ -0,0 +1,37 @@
+#include <oglplayground/vertexformat.h>
+
+#if defined(OGLPLAYGROUND_AVX2) && defined(__AVX2__)
+
+#include "vertexkernels.h"
+
+namespace OglPlayground
+{
+
+size_t packHalfAVX2(const float* src, uint16_t* dst, size_t count)
+{
+  return detail::packHalfKernel<detail::Float8>(src, dst, 0, count);
+}
+
+size_t packSnorm8AVX2(const float* src, int8_t* dst, size_t count)
+{
+  return detail::packNormKernel<detail::Float8>(src, dst, 0, count, -1.f, 127.f);
+}
+
+size_t packUnorm8AVX2(const float* src, uint8_t* dst, size_t count)
+{
+  return detail::packNormKernel<detail::Float8>(src, dst, 0, count, 0.f, 255.f);
+}
+
+size_t packSnorm16AVX2(const float* src, int16_t* dst, size_t count)
+{
+  return detail::packNormKernel<detail::Float8>(src, dst, 0, count, -1.f, 32767.f);
+}
+
+size_t packUnorm16AVX2(const float* src, uint16_t* dst, size_t count)
+{
+  return detail::packNormKernel<detail::Float8>(src, dst, 0, count, 0.f, 65535.f);
+}
+
+} // namespace OglPlayground
+
+#endif
@@ -0,0 +1,150 @@
+#pragma once
+
+// Internal batched vertex packing kernels over the wide float types of
+// simdfloat.h. Each kernel starts at begin, stops before a partial lane group
+// and returns where it stopped, callers finish the tail.
+
+#include <cstring>
+
+#include "simdfloat.h"
+
+namespace OglPlayground
+{
+namespace detail
+{
+namespace
+{
+
+// Half float bits of each lane in the low 16 bits of 32 bit lanes, rounded
+// to nearest even. Same steps as floatToHalf: values past the half range
+// become infinity, NaN stays NaN, small values become denormals.
+#ifdef OGLPLAYGROUND_SSE2
+inline __m128i halfBits(Float4 x)
+{
+  __m128i u = _mm_castps_si128(x.v);
+  const __m128i sign = _mm_and_si128(u, _mm_set1_epi32(int(0x80000000u)));
+  u = _mm_xor_si128(u, sign);
+
+  const __m128i infNan = _mm_or_si128(
+      _mm_set1_epi32(0x7c00),
+      _mm_and_si128(_mm_cmpgt_epi32(u, _mm_set1_epi32(255 << 23)), _mm_set1_epi32(0x0200)));
+  const __m128i isInfNan = _mm_cmpgt_epi32(u, _mm_set1_epi32(((127 + 16) << 23) - 1));
+
+  const __m128i denormMagic = _mm_set1_epi32(((127 - 15) + (23 - 10) + 1) << 23);
+  const __m128i denorm = _mm_sub_epi32(
+      _mm_castps_si128(_mm_add_ps(_mm_castsi128_ps(u), _mm_castsi128_ps(denormMagic))), denormMagic);
+  const __m128i isDenorm = _mm_cmplt_epi32(u, _mm_set1_epi32(113 << 23));
+
+  const __m128i mantissaOdd = _mm_and_si128(_mm_srli_epi32(u, 13), _mm_set1_epi32(1));
+  const __m128i normal = _mm_srli_epi32(
+      _mm_add_epi32(_mm_add_epi32(u, _mm_set1_epi32(int(0xc8000fffu))), mantissaOdd), 13);
+
+  __m128i h = _mm_or_si128(_mm_and_si128(isDenorm, denorm), _mm_andnot_si128(isDenorm, normal));
+  h = _mm_or_si128(_mm_and_si128(isInfNan, infNan), _mm_andnot_si128(isInfNan, h));
+  return _mm_or_si128(h, _mm_srli_epi32(sign, 16));
+}
+
+// Low 16 bits of 32 bit lanes in [0, 65535], sse2 only packs signed
+inline __m128i packUnsigned16(__m128i a, __m128i b)
+{
+  const __m128i bias = _mm_set1_epi32(0x8000);
+  const __m128i packed = _mm_packs_epi32(_mm_sub_epi32(a, bias), _mm_sub_epi32(b, bias));
+  return _mm_xor_si128(packed, _mm_set1_epi16(short(0x8000)));
+}
+
+inline void storeHalf(Float4 x, uint16_t* p)
+{
+  const __m128i h = halfBits(x);
+  _mm_storel_epi64(reinterpret_cast<__m128i*>(p), packUnsigned16(h, h));
+}
+
+// Lanes already scaled and clamped to the range of the type
+inline void storeRounded(Float4 x, int16_t* p)
+{
+  const __m128i i = _mm_cvtps_epi32(x.v);
+  _mm_storel_epi64(reinterpret_cast<__m128i*>(p), _mm_packs_epi32(i, i));
+}
+
+inline void storeRounded(Float4 x, uint16_t* p)
+{
+  const __m128i i = _mm_cvtps_epi32(x.v);
+  _mm_storel_epi64(reinterpret_cast<__m128i*>(p), packUnsigned16(i, i));
+}
+
+inline void storeRounded(Float4 x, int8_t* p)
+{
+  const __m128i i = _mm_packs_epi32(_mm_cvtps_epi32(x.v), _mm_setzero_si128());
+  const int packed = _mm_cvtsi128_si32(_mm_packs_epi16(i, i));
+  std::memcpy(p, &packed, 4);
+}
+
+inline void storeRounded(Float4 x, uint8_t* p)
+{
+  const __m128i i = _mm_packs_epi32(_mm_cvtps_epi32(x.v), _mm_setzero_si128());
+  const int packed = _mm_cvtsi128_si32(_mm_packus_epi16(i, i));
+  std::memcpy(p, &packed, 4);
+}
+#endif
+
+#ifdef __AVX2__
+// Both halves go through the Float4 steps, packing stays within 128 bits
+inline __m128i low_(Float8 x) { return _mm256_castsi256_si128(_mm256_cvtps_epi32(x.v)); }
+inline __m128i high_(Float8 x) { return _mm256_extracti128_si256(_mm256_cvtps_epi32(x.v), 1); }
+
+inline void storeHalf(Float8 x, uint16_t* p)
+{
+  const __m128i lo = halfBits(Float4{_mm256_castps256_ps128(x.v)});
+  const __m128i hi = halfBits(Float4{_mm256_extractf128_ps(x.v, 1)});
+  _mm_storeu_si128(reinterpret_cast<__m128i*>(p), packUnsigned16(lo, hi));
+}
+
+inline void storeRounded(Float8 x, int16_t* p)
+{
+  _mm_storeu_si128(reinterpret_cast<__m128i*>(p), _mm_packs_epi32(low_(x), high_(x)));
+}
+
+inline void storeRounded(Float8 x, uint16_t* p)
+{
+  _mm_storeu_si128(reinterpret_cast<__m128i*>(p), packUnsigned16(low_(x), high_(x)));
+}
+
+inline void storeRounded(Float8 x, int8_t* p)
+{
+  const __m128i i = _mm_packs_epi32(low_(x), high_(x));
+  _mm_storel_epi64(reinterpret_cast<__m128i*>(p), _mm_packs_epi16(i, i));
+}
+
+inline void storeRounded(Float8 x, uint8_t* p)
+{
+  const __m128i i = _mm_packs_epi32(low_(x), high_(x));
+  _mm_storel_epi64(reinterpret_cast<__m128i*>(p), _mm_packus_epi16(i, i));
+}
+#endif
+
+template<typename F>
+size_t packHalfKernel(const float* src, uint16_t* dst, size_t begin, size_t count)
+{
+  size_t i = begin;
+  for(; i + F::width <= count; i += F::width) {
+    storeHalf(F::load(src+i), dst+i);
+  }
+  return i;
+}
+
+// dst = round(clamp(src, minimum, 1) * scale)
+template<typename F, typename T>
+size_t packNormKernel(const float* src, T* dst, size_t begin, size_t count, float minimum, float scale)
+{
+  const F low = F::set1(minimum);
+  const F high = F::set1(1.f);
+  const F s = F::set1(scale);
+  size_t i = begin;
+  for(; i + F::width <= count; i += F::width) {
+    storeRounded(min(max(F::load(src+i), low), high) * s, dst+i);
+  }
+  return i;
+}
+
+} // anonymous namespace
+} // namespace detail
+} // namespace OglPlayground
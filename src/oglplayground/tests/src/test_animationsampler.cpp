@@ -0,0 +1,112 @@
+#include <cmath>
+#include <cstdlib>
+#include <vector>
+
+#include <gtest/gtest.h>
+#include <oglplayground/animationsampler.h>
+
+using OglPlayground::AnimationSampler;
+using OglPlayground::SimdLevel;
+using OglPlayground::TransformHierarchy;
+
+namespace
+{
+
+bool nearEqualVec3(const glm::vec3& a, const glm::vec3& b) {
+  return std::abs(a.x - b.x) < 1e-5f && std::abs(a.y - b.y) < 1e-5f && std::abs(a.z - b.z) < 1e-5f;
+}
+
+bool nearEqualQuat(const glm::quat& a, const glm::quat& b) {
+  return std::abs(a.x - b.x) < 1e-5f && std::abs(a.y - b.y) < 1e-5f
+      && std::abs(a.z - b.z) < 1e-5f && std::abs(a.w - b.w) < 1e-5f;
+}
+
+} // anonymous namespace
+
+TEST(AnimationSamplerTest, Interpolation) {
+  TransformHierarchy hierarchy;
+  const auto node = hierarchy.create();
+
+  AnimationSampler sampler;
+  const float times[] = {0.f, 1.f, 3.f};
+  const glm::vec3 positions[] = {glm::vec3(0.f), glm::vec3(2.f, 0.f, 0.f), glm::vec3(2.f, 4.f, 0.f)};
+  const glm::vec3 scales[] = {glm::vec3(1.f), glm::vec3(3.f)};
+  const glm::quat rotations[] = {glm::quat(1.f, 0.f, 0.f, 0.f), glm::quat(0.f, 0.f, 1.f, 0.f)};
+  sampler.addPositionTrack(node, times, positions, 3);
+  sampler.addScaleTrack(node, times, scales, 2);
+  sampler.addRotationTrack(node, times, rotations, 2);
+  EXPECT_EQ(3u, sampler.trackCount());
+  EXPECT_EQ(3.f, sampler.duration());
+
+  sampler.sample(0.5f, hierarchy);
+  EXPECT_PRED2(nearEqualVec3, glm::vec3(1.f, 0.f, 0.f), hierarchy.localPosition(node));
+  EXPECT_PRED2(nearEqualVec3, glm::vec3(2.f), hierarchy.localScale(node));
+  const float h = std::sqrt(0.5f);
+  EXPECT_PRED2(nearEqualQuat, glm::quat(h, 0.f, h, 0.f), hierarchy.localRotation(node));
+
+  sampler.sample(2.f, hierarchy);
+  EXPECT_PRED2(nearEqualVec3, glm::vec3(2.f, 2.f, 0.f), hierarchy.localPosition(node));
+
+  // Clamped outside of the keys, and seeking backward
+  sampler.sample(10.f, hierarchy);
+  EXPECT_PRED2(nearEqualVec3, glm::vec3(2.f, 4.f, 0.f), hierarchy.localPosition(node));
+  EXPECT_PRED2(nearEqualVec3, glm::vec3(3.f), hierarchy.localScale(node));
+  sampler.sample(-1.f, hierarchy);
+  EXPECT_PRED2(nearEqualVec3, glm::vec3(0.f), hierarchy.localPosition(node));
+}
+
+TEST(AnimationSamplerTest, ShortestRotationPath) {
+  TransformHierarchy hierarchy;
+  const auto node = hierarchy.create();
+
+  // Same orientation with opposite signs, nlerp must not go through zero
+  AnimationSampler sampler;
+  const float times[] = {0.f, 1.f};
+  const glm::quat rotations[] = {glm::quat(1.f, 0.f, 0.f, 0.f), glm::quat(-1.f, 0.f, 0.f, 0.f)};
+  sampler.addRotationTrack(node, times, rotations, 2);
+  sampler.sample(0.5f, hierarchy);
+  EXPECT_PRED2(nearEqualQuat, glm::quat(1.f, 0.f, 0.f, 0.f), hierarchy.localRotation(node));
+}
+
+TEST(AnimationSamplerTest, SimdLevels) {
+  // Odd track count so every kernel leaves a tail
+  const size_t trackCount = 37;
+  TransformHierarchy hierarchy;
+  AnimationSampler sampler;
+  srand(42);
+  auto random = [](float range) { return (float(rand()) / float(RAND_MAX) - 0.5f) * range; };
+  std::vector<TransformHierarchy::NodeId> nodes;
+  for(size_t i = 0; i < trackCount; ++i) {
+    nodes.push_back(hierarchy.create());
+    std::vector<float> times;
+    std::vector<glm::vec3> vectors;
+    std::vector<glm::quat> rotations;
+    for(size_t k = 0; k < 1 + i % 5; ++k) {
+      times.push_back(float(k) + random(0.5f));
+      vectors.push_back(glm::vec3(random(10.f), random(10.f), random(10.f)));
+      rotations.push_back(glm::normalize(glm::quat(random(2.f), random(2.f), random(2.f), random(2.f))));
+    }
+    sampler.addPositionTrack(nodes.back(), times.data(), vectors.data(), times.size());
+    sampler.addRotationTrack(nodes.back(), times.data(), rotations.data(), times.size());
+    sampler.addScaleTrack(nodes.back(), times.data(), vectors.data(), times.size());
+  }
+
+  for(float time : {-1.f, 0.3f, 1.7f, 2.2f, 0.9f, 6.f}) {
+    sampler.sample(time, hierarchy, SimdLevel::Scalar);
+    std::vector<glm::vec3> positions, scales;
+    std::vector<glm::quat> rotations;
+    for(auto node : nodes) {
+      positions.push_back(hierarchy.localPosition(node));
+      rotations.push_back(hierarchy.localRotation(node));
+      scales.push_back(hierarchy.localScale(node));
+    }
+    for(SimdLevel level : {SimdLevel::SSE2, SimdLevel::AVX2}) {
+      sampler.sample(time, hierarchy, level);
+      for(size_t i = 0; i < trackCount; ++i) {
+        EXPECT_PRED2(nearEqualVec3, positions[i], hierarchy.localPosition(nodes[i]));
+        EXPECT_PRED2(nearEqualQuat, rotations[i], hierarchy.localRotation(nodes[i]));
+        EXPECT_PRED2(nearEqualVec3, scales[i], hierarchy.localScale(nodes[i]));
+      }
+    }
+  }
+}
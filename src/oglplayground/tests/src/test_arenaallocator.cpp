@@ -0,0 +1,177 @@
+#include <algorithm>
+#include <random>
+#include <vector>
+
+#include <gtest/gtest.h>
+#include <oglplayground/arenaallocator.h>
+#include <oglplayground/bufferarena.h>
+
+#include "glcontext.h"
+
+using OglPlayground::ArenaAllocator;
+
+namespace
+{
+
+// Live allocations never overlap and stay in the arena
+void expectDisjoint(const ArenaAllocator& arena, const std::vector<ArenaAllocator::Allocation>& allocations)
+{
+  std::vector<std::pair<uint32_t, uint32_t>> ranges;
+  for(auto allocation : allocations) {
+    ranges.emplace_back(arena.offset(allocation), arena.size(allocation));
+  }
+  std::sort(ranges.begin(), ranges.end());
+  for(size_t i = 0; i < ranges.size(); ++i) {
+    EXPECT_LE(ranges[i].first + ranges[i].second, arena.capacity());
+    if(i > 0) {
+      EXPECT_LE(ranges[i-1].first + ranges[i-1].second, ranges[i].first);
+    }
+  }
+}
+
+} // anonymous namespace
+
+TEST(ArenaAllocatorTest, AllocateFree) {
+  ArenaAllocator arena(1000);
+  auto a = arena.allocate(100);
+  auto b = arena.allocate(300);
+  auto c = arena.allocate(200);
+  ASSERT_NE(ArenaAllocator::invalid, a);
+  ASSERT_NE(ArenaAllocator::invalid, b);
+  ASSERT_NE(ArenaAllocator::invalid, c);
+  EXPECT_EQ(300u, arena.size(b));
+  expectDisjoint(arena, {a, b, c});
+
+  auto stats = arena.stats();
+  EXPECT_EQ(600u, stats.used);
+  EXPECT_EQ(3u, stats.allocations);
+  EXPECT_EQ(1u, stats.freeBlocks);
+  EXPECT_EQ(400u, stats.largestFree);
+
+  // Too large for what is left
+  EXPECT_EQ(ArenaAllocator::invalid, arena.allocate(401));
+
+  // Freeing the middle then its neighbours merges everything back
+  arena.free(b);
+  EXPECT_EQ(2u, arena.stats().freeBlocks);
+  arena.free(a);
+  EXPECT_EQ(2u, arena.stats().freeBlocks);
+  EXPECT_EQ(400u, arena.stats().largestFree);
+  arena.free(c);
+  stats = arena.stats();
+  EXPECT_EQ(0u, stats.used);
+  EXPECT_EQ(1u, stats.freeBlocks);
+  EXPECT_EQ(1000u, stats.largestFree);
+
+  // The whole arena in one allocation
+  auto all = arena.allocate(1000);
+  ASSERT_NE(ArenaAllocator::invalid, all);
+  EXPECT_EQ(0u, arena.offset(all));
+  EXPECT_EQ(0u, arena.stats().freeBlocks);
+}
+
+TEST(ArenaAllocatorTest, Defragment) {
+  ArenaAllocator arena(100);
+  std::vector<ArenaAllocator::Allocation> allocations;
+  for(int i = 0; i < 10; ++i) allocations.push_back(arena.allocate(10));
+  arena.free(allocations[0]);
+  arena.free(allocations[4]);
+  arena.free(allocations[5]);
+  EXPECT_EQ(ArenaAllocator::invalid, arena.allocate(25));
+
+  std::vector<ArenaAllocator::Move> moves;
+  arena.defragment(moves);
+  // Every remaining allocation below a hole moves down once, in order
+  ASSERT_EQ(7u, moves.size());
+  for(const auto& move : moves) EXPECT_LT(move.to, move.from);
+  EXPECT_EQ(10u, moves[0].from);
+  EXPECT_EQ(0u, moves[0].to);
+  EXPECT_EQ(0u, arena.offset(allocations[1]));
+  EXPECT_EQ(60u, arena.offset(allocations[9]));
+
+  auto stats = arena.stats();
+  EXPECT_EQ(1u, stats.freeBlocks);
+  EXPECT_EQ(30u, stats.largestFree);
+  EXPECT_NE(ArenaAllocator::invalid, arena.allocate(25));
+
+  // Packed already
+  arena.defragment(moves);
+  EXPECT_TRUE(moves.empty());
+}
+
+TEST(ArenaAllocatorTest, Random) {
+  std::mt19937 rng(7);
+  std::uniform_int_distribution<uint32_t> sizes(1, 5000);
+  ArenaAllocator arena(1 << 20);
+  std::vector<ArenaAllocator::Allocation> allocations;
+  std::vector<ArenaAllocator::Move> moves;
+  uint32_t used = 0;
+  for(int round = 0; round < 4; ++round) {
+    for(int i = 0; i < 2000; ++i) {
+      if(!allocations.empty() && rng() % 3 == 0) {
+        const size_t index = rng() % allocations.size();
+        used -= arena.size(allocations[index]);
+        arena.free(allocations[index]);
+        allocations[index] = allocations.back();
+        allocations.pop_back();
+      } else {
+        const uint32_t size = sizes(rng);
+        auto allocation = arena.allocate(size);
+        if(allocation == ArenaAllocator::invalid) continue;
+        EXPECT_EQ(size, arena.size(allocation));
+        used += size;
+        allocations.push_back(allocation);
+      }
+    }
+    expectDisjoint(arena, allocations);
+    EXPECT_EQ(used, arena.stats().used);
+    EXPECT_EQ(allocations.size(), arena.stats().allocations);
+
+    arena.defragment(moves);
+    expectDisjoint(arena, allocations);
+    const auto stats = arena.stats();
+    EXPECT_LE(stats.freeBlocks, 1u);
+    EXPECT_EQ(arena.capacity() - used, stats.freeBlocks ? stats.largestFree : 0u);
+  }
+}
+
+// Needs an opengl 4.4 context, Mesa llvmpipe is enough. Passes without
+// checking anything on machines without one.
+
+TEST(BufferArenaTest, Defragment) {
+  if(!OglPlayground::makeHiddenGLContextCurrent()) return;
+  using OglPlayground::BufferArena;
+  BufferArena arena({{OglPlayground::AttributeUsage::Position, 3}}, 16, 32);
+
+  std::vector<float> vertices(3*8);
+  for(size_t i = 0; i < vertices.size(); ++i) vertices[i] = float(i);
+  std::vector<uint32_t> indices(12);
+  for(size_t i = 0; i < indices.size(); ++i) indices[i] = uint32_t(100+i);
+
+  auto firstVertices = arena.allocateVertices(vertices.data(), 4);
+  auto firstIndices = arena.allocateIndices(indices.data(), 6);
+  auto vertexAllocation = arena.allocateVertices(vertices.data(), 8);
+  auto indexAllocation = arena.allocateIndices(indices.data(), 12);
+  ASSERT_NE(ArenaAllocator::invalid, vertexAllocation);
+  ASSERT_NE(ArenaAllocator::invalid, indexAllocation);
+  EXPECT_EQ(ArenaAllocator::invalid, arena.allocateVertices(vertices.data(), 8));
+
+  arena.freeVertices(firstVertices);
+  arena.freeIndices(firstIndices);
+  const GLuint vertexName = arena.vertexBuffer().name();
+  arena.defragment();
+  EXPECT_EQ(vertexName, arena.vertexBuffer().name());
+  EXPECT_EQ(0u, arena.vertexOffset(vertexAllocation));
+  EXPECT_EQ(0u, arena.indexOffset(indexAllocation));
+
+  // The data moved with the ranges
+  std::vector<float> readVertices(vertices.size());
+  glBindBuffer(GL_COPY_READ_BUFFER, arena.vertexBuffer().name());
+  glGetBufferSubData(GL_COPY_READ_BUFFER, 0, readVertices.size()*sizeof(float), readVertices.data());
+  std::vector<uint32_t> readIndices(indices.size());
+  glBindBuffer(GL_COPY_READ_BUFFER, arena.indexBuffer().name());
+  glGetBufferSubData(GL_COPY_READ_BUFFER, 0, readIndices.size()*sizeof(uint32_t), readIndices.data());
+  glBindBuffer(GL_COPY_READ_BUFFER, 0);
+  EXPECT_EQ(vertices, readVertices);
+  EXPECT_EQ(indices, readIndices);
+}
@@ -0,0 +1,84 @@
+#include <cstring>
+#include <vector>
+
+#include <gtest/gtest.h>
+#include <oglplayground/bufferobject.h>
+#include <oglplayground/directstateaccess.h>
+
+#include "glcontext.h"
+
+using OglPlayground::BufferMapping;
+using OglPlayground::BufferObject;
+
+// Needs an opengl 4.4 context, Mesa llvmpipe is enough. Passes without
+// checking anything on machines without one.
+
+namespace
+{
+
+void testMapRange_()
+{
+  std::vector<uint32_t> data(64, 7);
+  BufferObject buffer(GL_ARRAY_BUFFER, data.size()*sizeof(uint32_t), data.data(), GL_DYNAMIC_DRAW);
+  EXPECT_EQ(data.size()*sizeof(uint32_t), buffer.size());
+
+  // Invalidated range, rest of the buffer is kept
+  {
+    BufferMapping mapping(buffer, 16*sizeof(uint32_t), 16*sizeof(uint32_t), GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT);
+    ASSERT_TRUE(mapping.isValid());
+    for(uint32_t i = 0; i < 16; ++i) mapping.as<uint32_t>()[i] = i;
+  }
+  // Explicit flush of part of the mapping
+  {
+    BufferMapping mapping(buffer, 32*sizeof(uint32_t), 16*sizeof(uint32_t), GL_MAP_WRITE_BIT | GL_MAP_FLUSH_EXPLICIT_BIT);
+    ASSERT_TRUE(mapping.isValid());
+    for(uint32_t i = 0; i < 16; ++i) mapping.as<uint32_t>()[i] = 100+i;
+    mapping.flush(0, 16*sizeof(uint32_t));
+  }
+  for(uint32_t i = 0; i < 16; ++i) {
+    data[16+i] = i;
+    data[32+i] = 100+i;
+  }
+
+  BufferMapping mapping(buffer, GL_MAP_READ_BIT);
+  ASSERT_TRUE(mapping.isValid());
+  EXPECT_EQ(0, memcmp(data.data(), mapping.data(), mapping.length()));
+}
+
+} // anonymous namespace
+
+TEST(BufferObjectTest, MapRange) {
+  if(!OglPlayground::makeHiddenGLContextCurrent()) return;
+  // Both paths when the context has direct state access
+  const bool dsa = OglPlayground::directStateAccess();
+  OglPlayground::setDirectStateAccess(false);
+  testMapRange_();
+  OglPlayground::setDirectStateAccess(true);
+  if(OglPlayground::directStateAccess()) testMapRange_();
+  OglPlayground::setDirectStateAccess(dsa);
+}
+
+TEST(BufferObjectTest, UploadCopy) {
+  if(!OglPlayground::makeHiddenGLContextCurrent()) return;
+  const uint32_t data[] = {1, 2, 3, 4};
+  BufferObject source(GL_ARRAY_BUFFER, sizeof(data), data, GL_STATIC_DRAW);
+  BufferObject destination(GL_ELEMENT_ARRAY_BUFFER, sizeof(data), nullptr, GL_STATIC_DRAW);
+  destination.upload(0, sizeof(uint32_t), &data[3]);
+  destination.copyFrom(source, 0, sizeof(uint32_t), 3*sizeof(uint32_t));
+
+  const uint32_t expected[] = {4, 1, 2, 3};
+  BufferMapping mapping(destination, GL_MAP_READ_BIT);
+  ASSERT_TRUE(mapping.isValid());
+  EXPECT_EQ(0, memcmp(expected, mapping.data(), sizeof(expected)));
+}
+
+TEST(BufferObjectTest, Orphan) {
+  if(!OglPlayground::makeHiddenGLContextCurrent()) return;
+  BufferObject buffer(GL_PIXEL_UNPACK_BUFFER, 256, nullptr, GL_STREAM_DRAW);
+  buffer.orphan();
+  GLint size = 0;
+  buffer.bind();
+  glGetBufferParameteriv(GL_PIXEL_UNPACK_BUFFER, GL_BUFFER_SIZE, &size);
+  buffer.unbind();
+  EXPECT_EQ(256, size);
+}
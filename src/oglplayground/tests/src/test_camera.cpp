@@ -0,0 +1,85 @@
+#include <cmath>
+
+#include <gtest/gtest.h>
+#include <oglplayground/camera.h>
+
+using OglPlayground::Camera;
+using OglPlayground::Space;
+using OglPlayground::Transform;
+
+namespace
+{
+
+bool nearEqualMat4(const glm::mat4& a, const glm::mat4& b) {
+  for(int c = 0; c < 4; ++c) {
+    for(int r = 0; r < 4; ++r) {
+      if(std::abs(a[c][r] - b[c][r]) > 1e-4f) return false;
+    }
+  }
+  return true;
+}
+
+} // anonymous namespace
+
+TEST(CameraTest, CachedMatrices) {
+  Camera camera;
+  camera.setClippingPlanes(0.1f, 100.f);
+  camera.transform().translate(glm::vec3(1.f, 2.f, -5.f), Space::World);
+  EXPECT_EQ(camera.transform().worldToLocalMatrix(), camera.view());
+  EXPECT_EQ(camera.projection() * camera.view(), camera.viewProjection());
+  EXPECT_PRED2(nearEqualMat4, glm::mat4(1.f), camera.inverseViewProjection() * camera.viewProjection());
+
+  // Transform changes invalidate the view
+  const glm::mat4 viewProjection = camera.viewProjection();
+  camera.transform().rotate(glm::vec3(0.f, 30.f, 0.f), Space::Local);
+  EXPECT_NE(viewProjection, camera.viewProjection());
+  EXPECT_EQ(camera.projection() * camera.transform().worldToLocalMatrix(), camera.viewProjection());
+
+  // Projection changes too, setting the same value does not
+  const uint64_t version = camera.version();
+  camera.setAspect(camera.aspect());
+  EXPECT_EQ(version, camera.version());
+  camera.setFov(camera.fov() * 0.5f);
+  EXPECT_LT(version, camera.version());
+  EXPECT_EQ(camera.projection() * camera.view(), camera.viewProjection());
+  EXPECT_PRED2(nearEqualMat4, glm::mat4(1.f), camera.inverseViewProjection() * camera.viewProjection());
+}
+
+TEST(CameraTest, AssignedTransform) {
+  // Projection version up by one, transform version down by one: the sum
+  // of the two is the same, the caches must still see the change
+  Camera camera;
+  camera.setClippingPlanes(0.1f, 100.f);
+  for(int i = 0; i < 3; ++i) camera.transform().translate(glm::vec3(1.f, 0.f, 0.f), Space::World);
+  const glm::mat4 viewProjection = camera.viewProjection();
+  camera.frustum();
+  camera.inverseViewProjection();
+
+  Transform other;
+  for(int i = 0; i < 2; ++i) other.translate(glm::vec3(0.f, 0.f, 4.f), Space::World);
+  camera.setFov(0.5f);
+  camera.transform() = other;
+  EXPECT_NE(viewProjection, camera.viewProjection());
+  EXPECT_EQ(camera.projection() * other.worldToLocalMatrix(), camera.viewProjection());
+  EXPECT_PRED2(nearEqualMat4, glm::mat4(1.f), camera.inverseViewProjection() * camera.viewProjection());
+  const OglPlayground::Frustum expected = OglPlayground::frustumFromMatrix(camera.viewProjection());
+  for(size_t i = 0; i < 6; ++i) EXPECT_EQ(expected.planes[i], camera.frustum().planes[i]);
+}
+
+TEST(CameraTest, AssignedEqualVersion) {
+  // Both transforms modified the same number of times, the caches must
+  // still see the new content
+  Camera camera;
+  camera.setClippingPlanes(0.1f, 100.f);
+  camera.transform().translate(glm::vec3(1.f, 0.f, 0.f), Space::World);
+  const glm::mat4 view = camera.view();
+  const glm::mat4 viewProjection = camera.viewProjection();
+
+  Transform other;
+  other.translate(glm::vec3(0.f, 3.f, 0.f), Space::World);
+  camera.transform() = other;
+  EXPECT_NE(view, camera.view());
+  EXPECT_NE(viewProjection, camera.viewProjection());
+  EXPECT_EQ(other.worldToLocalMatrix(), camera.view());
+  EXPECT_EQ(camera.projection() * other.worldToLocalMatrix(), camera.viewProjection());
+}
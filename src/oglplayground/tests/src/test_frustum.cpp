@@ -0,0 +1,141 @@
+#include <cstdlib>
+#include <vector>
+
+#include <glm/gtc/matrix_transform.hpp>
+#include <gtest/gtest.h>
+#include <oglplayground/camera.h>
+#include <oglplayground/frustum.h>
+
+using OglPlayground::BoxArrays;
+using OglPlayground::Camera;
+using OglPlayground::Frustum;
+using OglPlayground::SimdLevel;
+using OglPlayground::SphereArrays;
+
+namespace
+{
+
+struct Boxes
+{
+  void add(glm::vec3 center, glm::vec3 extent) {
+    cx.push_back(center.x);
+    cy.push_back(center.y);
+    cz.push_back(center.z);
+    ex.push_back(extent.x);
+    ey.push_back(extent.y);
+    ez.push_back(extent.z);
+  }
+  BoxArrays arrays() const { return {cx.data(), cy.data(), cz.data(), ex.data(), ey.data(), ez.data()}; }
+  SphereArrays spheres() const { return {cx.data(), cy.data(), cz.data(), ex.data()}; }
+  size_t size() const { return cx.size(); }
+
+  std::vector<float> cx, cy, cz, ex, ey, ez;
+};
+
+// Camera at the origin looking along +z, 90 degrees fov, planes at 1 and 100
+Frustum frustum_() {
+  return OglPlayground::frustumFromMatrix(glm::perspective(glm::radians(90.f), 1.f, 1.f, 100.f));
+}
+
+std::vector<uint32_t> cull_(const Frustum& frustum, const Boxes& boxes, SimdLevel level, bool spheres) {
+  std::vector<uint32_t> visible(boxes.size());
+  const size_t count = spheres
+      ? OglPlayground::cullSpheres(frustum, boxes.spheres(), boxes.size(), visible.data(), level)
+      : OglPlayground::cullBoxes(frustum, boxes.arrays(), boxes.size(), visible.data(), level);
+  visible.resize(count);
+  return visible;
+}
+
+} // anonymous namespace
+
+TEST(FrustumTest, Planes) {
+  const Frustum frustum = frustum_();
+  auto inside = [&](glm::vec3 p) {
+    for(const glm::vec4& plane : frustum.planes) {
+      if(glm::dot(glm::vec3(plane), p) + plane.w < 0.f) return false;
+    }
+    return true;
+  };
+  EXPECT_TRUE(inside(glm::vec3(0.f, 0.f, 10.f)));
+  EXPECT_TRUE(inside(glm::vec3(9.f, -9.f, 10.f)));
+  EXPECT_FALSE(inside(glm::vec3(11.f, 0.f, 10.f)));
+  EXPECT_FALSE(inside(glm::vec3(0.f, 0.f, -10.f)));
+  EXPECT_FALSE(inside(glm::vec3(0.f, 0.f, 0.5f)));
+  EXPECT_FALSE(inside(glm::vec3(0.f, 0.f, 101.f)));
+  for(const glm::vec4& plane : frustum.planes) {
+    EXPECT_NEAR(1.f, glm::length(glm::vec3(plane)), 1e-5f);
+  }
+}
+
+TEST(FrustumTest, CullBoxes) {
+  Boxes boxes;
+  boxes.add(glm::vec3(0.f, 0.f, 10.f), glm::vec3(1.f)); // Inside
+  boxes.add(glm::vec3(0.f, 0.f, -10.f), glm::vec3(1.f)); // Behind
+  boxes.add(glm::vec3(-20.f, 0.f, 10.f), glm::vec3(1.f)); // Left
+  boxes.add(glm::vec3(11.f, 0.f, 10.f), glm::vec3(2.f)); // Straddling the right plane
+  boxes.add(glm::vec3(0.f, 0.f, 150.f), glm::vec3(10.f)); // Beyond far
+  boxes.add(glm::vec3(0.f, 0.f, 0.f), glm::vec3(0.2f)); // Before near
+
+  for(SimdLevel level : {SimdLevel::Scalar, SimdLevel::SSE2, SimdLevel::AVX2}) {
+    EXPECT_EQ(std::vector<uint32_t>({0, 3}), cull_(frustum_(), boxes, level, false));
+    EXPECT_EQ(std::vector<uint32_t>({0, 3}), cull_(frustum_(), boxes, level, true));
+  }
+}
+
+TEST(FrustumTest, SimdLevels) {
+  // Not a multiple of any lane width
+  Boxes boxes;
+  srand(42);
+  auto random = [](float range) { return (float(rand()) / float(RAND_MAX) - 0.5f) * range; };
+  for(int i = 0; i < 1001; ++i) {
+    boxes.add(glm::vec3(random(200.f), random(200.f), random(200.f)), glm::abs(glm::vec3(random(10.f), random(10.f), random(10.f))));
+  }
+
+  for(bool spheres : {false, true}) {
+    const auto expected = cull_(frustum_(), boxes, SimdLevel::Scalar, spheres);
+    EXPECT_FALSE(expected.empty());
+    EXPECT_LT(expected.size(), boxes.size());
+    EXPECT_EQ(expected, cull_(frustum_(), boxes, SimdLevel::SSE2, spheres));
+    EXPECT_EQ(expected, cull_(frustum_(), boxes, SimdLevel::AVX2, spheres));
+  }
+}
+
+TEST(FrustumTest, Camera) {
+  // Looking along -x from (10, 0, 0), the origin is in view and +x is behind
+  Camera camera;
+  camera.setClippingPlanes(0.1f, 100.f);
+  camera.transform().translate(glm::vec3(10.f, 0.f, 0.f), OglPlayground::Space::World);
+  camera.transform().lookAt(glm::vec3(0.f), OglPlayground::Transform::worldUp);
+
+  Boxes boxes;
+  boxes.add(glm::vec3(0.f), glm::vec3(1.f));
+  boxes.add(glm::vec3(20.f, 0.f, 0.f), glm::vec3(1.f));
+  EXPECT_EQ(std::vector<uint32_t>({0}), cull_(camera.frustum(), boxes, SimdLevel::Scalar, false));
+}
+
+TEST(FrustumTest, CullBoxesMulti) {
+  // Masks must match culling against each frustum alone
+  Boxes boxes;
+  srand(7);
+  auto random = [](float range) { return (float(rand()) / float(RAND_MAX) - 0.5f) * range; };
+  for(int i = 0; i < 1001; ++i) {
+    boxes.add(glm::vec3(random(200.f), random(200.f), random(200.f)), glm::abs(glm::vec3(random(10.f), random(10.f), random(10.f))));
+  }
+  const Frustum frustums[] = {
+    frustum_(),
+    OglPlayground::frustumFromMatrix(glm::perspective(glm::radians(30.f), 2.f, 1.f, 50.f)),
+    OglPlayground::frustumFromMatrix(glm::ortho(-50.f, 0.f, -20.f, 20.f, -100.f, 100.f))};
+
+  std::vector<uint32_t> expectedMasks(boxes.size(), 0);
+  for(uint32_t f = 0; f < 3; ++f) {
+    for(uint32_t i : cull_(frustums[f], boxes, SimdLevel::Scalar, false)) expectedMasks[i] |= 1u << f;
+  }
+  for(SimdLevel level : {SimdLevel::Scalar, SimdLevel::SSE2, SimdLevel::AVX2}) {
+    std::vector<uint32_t> visible(boxes.size());
+    std::vector<uint8_t> masks(boxes.size());
+    const size_t count = OglPlayground::cullBoxesMulti(frustums, 3, boxes.arrays(), boxes.size(), visible.data(), masks.data(), level);
+    std::vector<uint32_t> masksByBox(boxes.size(), 0);
+    for(size_t i = 0; i < count; ++i) masksByBox[visible[i]] = masks[i];
+    EXPECT_EQ(expectedMasks, masksByBox);
+  }
+}
@@ -0,0 +1,230 @@
+#include <type_traits>
+#include <vector>
+
+#include <gtest/gtest.h>
+#include <oglplayground/bufferarena.h>
+#include <oglplayground/geometry.h>
+#include <oglplayground/gpumemory.h>
+
+#include "glcontext.h"
+
+using OglPlayground::AttributeUsage;
+using OglPlayground::BufferArena;
+using OglPlayground::BufferObject;
+using OglPlayground::Geometry;
+using OglPlayground::GeometryBinder;
+using OglPlayground::IndexType;
+
+namespace
+{
+
+const OglPlayground::VertexDesc desc_ = {{AttributeUsage::Position, 3}};
+const float vertices_[] = {0.f, 0.f, 0.f, 1.f, 0.f, 0.f, 0.f, 1.f, 0.f};
+const uint32_t indices_[] = {0, 1, 2};
+
+} // anonymous namespace
+
+TEST(GeometryTest, IndexType) {
+  EXPECT_EQ(IndexType::UInt16, OglPlayground::indexTypeFromVertexCount(3));
+  EXPECT_EQ(IndexType::UInt8, OglPlayground::indexTypeFromVertexCount(256, IndexType::UInt8));
+  EXPECT_EQ(IndexType::UInt16, OglPlayground::indexTypeFromVertexCount(257, IndexType::UInt8));
+  EXPECT_EQ(IndexType::UInt16, OglPlayground::indexTypeFromVertexCount(65536));
+  EXPECT_EQ(IndexType::UInt32, OglPlayground::indexTypeFromVertexCount(65537));
+  EXPECT_EQ(IndexType::UInt32, OglPlayground::indexTypeFromVertexCount(3, IndexType::UInt32));
+
+  const std::vector<uint32_t> indices = {0, 255, 7, 3};
+  std::vector<uint8_t> bytes(indices.size());
+  OglPlayground::narrowIndices(indices.data(), indices.size(), IndexType::UInt8, bytes.data());
+  EXPECT_EQ(std::vector<uint8_t>({0, 255, 7, 3}), bytes);
+  const std::vector<uint32_t> wide = {0, 65535, 256};
+  std::vector<uint16_t> shorts(wide.size());
+  OglPlayground::narrowIndices(wide.data(), wide.size(), IndexType::UInt16, shorts.data());
+  EXPECT_EQ(std::vector<uint16_t>({0, 65535, 256}), shorts);
+}
+
+TEST(GeometryTest, NothrowMove) {
+  // Vectors move them when growing instead of copying
+  static_assert(std::is_nothrow_move_constructible<BufferObject>::value, "");
+  static_assert(std::is_nothrow_move_constructible<Geometry>::value, "");
+  static_assert(std::is_nothrow_move_constructible<GeometryBinder>::value, "");
+  static_assert(std::is_nothrow_move_assignable<BufferObject>::value, "");
+  static_assert(std::is_nothrow_move_assignable<Geometry>::value, "");
+  static_assert(std::is_nothrow_move_assignable<GeometryBinder>::value, "");
+}
+
+// Needs an opengl 4.4 context, Mesa llvmpipe is enough. Passes without
+// checking anything on machines without one.
+
+TEST(GeometryTest, MoveBufferObject) {
+  if(!OglPlayground::makeHiddenGLContextCurrent()) return;
+  BufferObject a(GL_ARRAY_BUFFER, sizeof(vertices_), vertices_, GL_STATIC_DRAW);
+  const GLuint name = a.name();
+  BufferObject b(std::move(a));
+  EXPECT_EQ(0u, a.name());
+  EXPECT_EQ(name, b.name());
+  EXPECT_EQ(sizeof(vertices_), b.size());
+
+  BufferObject c(GL_ARRAY_BUFFER, 4, nullptr, GL_STATIC_DRAW);
+  c = std::move(b);
+  EXPECT_EQ(name, c.name());
+  EXPECT_EQ(GL_TRUE, glIsBuffer(name));
+}
+
+TEST(GeometryTest, MoveInVector) {
+  if(!OglPlayground::makeHiddenGLContextCurrent()) return;
+  // Growing the vectors moves geometries and binders, binders draw the
+  // moved geometries. Moves neither leak nor count twice.
+  using OglPlayground::GpuResource;
+  const auto vertexArrays = OglPlayground::gpuResourceStats(GpuResource::VertexArray);
+  const auto vertexBuffers = OglPlayground::gpuResourceStats(GpuResource::VertexBuffer);
+  {
+    std::vector<Geometry> geometries;
+    std::vector<GeometryBinder> binders;
+    for(int i = 0; i < 16; ++i) {
+      geometries.emplace_back(vertices_, 3, indices_, 3, desc_);
+    }
+    for(const auto& geometry : geometries) {
+      binders.emplace_back(geometry, OglPlayground::AttributeBindDesc{{AttributeUsage::Position, 0}});
+    }
+    binders.reserve(64);
+    geometries.reserve(64);
+    for(size_t i = 0; i < binders.size(); ++i) {
+      binders[i].bind();
+      binders[i].draw(geometries[i]);
+      binders[i].unbind();
+    }
+    EXPECT_EQ(GLenum(GL_NO_ERROR), glGetError());
+    EXPECT_EQ(vertexArrays.objects + 16, OglPlayground::gpuResourceStats(GpuResource::VertexArray).objects);
+    EXPECT_EQ(
+        vertexBuffers.bytes + int64_t(16*sizeof(vertices_)),
+        OglPlayground::gpuResourceStats(GpuResource::VertexBuffer).bytes);
+  }
+  EXPECT_EQ(vertexArrays.objects, OglPlayground::gpuResourceStats(GpuResource::VertexArray).objects);
+  EXPECT_EQ(vertexBuffers.bytes, OglPlayground::gpuResourceStats(GpuResource::VertexBuffer).bytes);
+}
+
+TEST(GeometryTest, MoveArenaGeometry) {
+  if(!OglPlayground::makeHiddenGLContextCurrent()) return;
+  BufferArena arena(desc_, 64, 64);
+  {
+    Geometry a(arena, vertices_, 3, indices_, 3);
+    Geometry b(std::move(a));
+    EXPECT_EQ(nullptr, a.arena());
+    EXPECT_EQ(&arena, b.arena());
+    EXPECT_EQ(1u, arena.vertexStats().allocations);
+
+    // Assignment frees the ranges it replaces
+    Geometry c(arena, vertices_, 3, indices_, 3);
+    EXPECT_EQ(2u, arena.indexStats().allocations);
+    c = std::move(b);
+    EXPECT_EQ(1u, arena.indexStats().allocations);
+  }
+  EXPECT_EQ(0u, arena.vertexStats().allocations);
+  EXPECT_EQ(0u, arena.indexStats().allocations);
+}
+
+TEST(GeometryTest, FullArena) {
+  if(!OglPlayground::makeHiddenGLContextCurrent()) return;
+  // No room for the vertices, the index range that fit is given back and
+  // the geometry draws nothing
+  BufferArena arena(desc_, 4, 64);
+  Geometry a(arena, vertices_, 3, indices_, 3);
+  Geometry b(arena, vertices_, 3, indices_, 3);
+  EXPECT_TRUE(a.isValid());
+  EXPECT_FALSE(b.isValid());
+  EXPECT_EQ(1u, arena.vertexStats().allocations);
+  EXPECT_EQ(1u, arena.indexStats().allocations);
+
+  GeometryBinder binder(a, OglPlayground::AttributeBindDesc{{AttributeUsage::Position, 0}});
+  binder.bind();
+  binder.draw(b);
+  binder.unbind();
+  EXPECT_EQ(GLenum(GL_NO_ERROR), glGetError());
+}
+
+TEST(GeometryTest, SmallIndices) {
+  if(!OglPlayground::makeHiddenGLContextCurrent()) return;
+  using OglPlayground::GpuResource;
+  const auto indexBuffers = OglPlayground::gpuResourceStats(GpuResource::IndexBuffer);
+  Geometry a(vertices_, 3, indices_, 3, desc_);
+  Geometry b(vertices_, 3, indices_, 3, desc_, IndexType::UInt8);
+  Geometry c(vertices_, 3, indices_, 3, desc_, IndexType::UInt32);
+  EXPECT_EQ(IndexType::UInt16, a.indexType());
+  EXPECT_EQ(IndexType::UInt8, b.indexType());
+  EXPECT_EQ(IndexType::UInt32, c.indexType());
+  EXPECT_EQ(
+      indexBuffers.bytes + int64_t(3*(2+1+4)),
+      OglPlayground::gpuResourceStats(GpuResource::IndexBuffer).bytes);
+
+  BufferArena arena(desc_, 64, 64, IndexType::UInt16);
+  Geometry d(arena, vertices_, 3, indices_, 3);
+  Geometry e(arena, vertices_, 3, indices_, 3);
+  EXPECT_EQ(IndexType::UInt16, e.indexType());
+  for(const Geometry* geometry : {&a, &b, &c, &d}) {
+    GeometryBinder binder(*geometry, OglPlayground::AttributeBindDesc{{AttributeUsage::Position, 0}});
+    binder.bind();
+    binder.draw(*geometry);
+    if(geometry == &d) binder.draw(e);
+    binder.unbind();
+  }
+  EXPECT_EQ(GLenum(GL_NO_ERROR), glGetError());
+}
+
+TEST(GeometryTest, BindPackedFormats) {
+  if(!OglPlayground::makeHiddenGLContextCurrent()) return;
+  // The normal is not bound, the attributes after it keep their offsets and
+  // the color binding is not taken by it
+  using OglPlayground::AttributeMode;
+  using OglPlayground::AttributeType;
+  const OglPlayground::VertexDesc desc = {
+    {AttributeUsage::Position, 3},
+    {AttributeUsage::Normal, 4, AttributeType::Int2101010, AttributeMode::Normalized},
+    {AttributeUsage::UV0, 2, AttributeType::Half},
+    {AttributeUsage::Color, 4, AttributeType::UInt8, AttributeMode::Normalized},
+    {AttributeUsage::Joints, 4, AttributeType::UInt8, AttributeMode::Integer}};
+  const uint8_t vertices[3*28] = {};
+  Geometry geometry(vertices, 3, indices_, 3, desc);
+  GeometryBinder binder(geometry, {
+      {AttributeUsage::Joints, 3},
+      {AttributeUsage::Position, 0},
+      {AttributeUsage::Color, 2},
+      {AttributeUsage::UV0, 1}});
+
+  struct Expected
+  {
+    GLint size;
+    GLint type;
+    GLint normalized;
+    GLint integer;
+    size_t offset;
+  };
+  const Expected expected[] = {
+    {3, GL_FLOAT, GL_FALSE, GL_FALSE, 0},
+    {2, GL_HALF_FLOAT, GL_FALSE, GL_FALSE, 16},
+    {4, GL_UNSIGNED_BYTE, GL_TRUE, GL_FALSE, 20},
+    {4, GL_UNSIGNED_BYTE, GL_FALSE, GL_TRUE, 24}};
+  binder.bind();
+  for(GLuint index = 0; index < 4; ++index) {
+    GLint enabled = 0, size = 0, type = 0, normalized = 0, integer = 0, relativeOffset = 0;
+    GLvoid* pointer = nullptr;
+    glGetVertexAttribiv(index, GL_VERTEX_ATTRIB_ARRAY_ENABLED, &enabled);
+    glGetVertexAttribiv(index, GL_VERTEX_ATTRIB_ARRAY_SIZE, &size);
+    glGetVertexAttribiv(index, GL_VERTEX_ATTRIB_ARRAY_TYPE, &type);
+    glGetVertexAttribiv(index, GL_VERTEX_ATTRIB_ARRAY_NORMALIZED, &normalized);
+    glGetVertexAttribiv(index, GL_VERTEX_ATTRIB_ARRAY_INTEGER, &integer);
+    glGetVertexAttribiv(index, GL_VERTEX_ATTRIB_RELATIVE_OFFSET, &relativeOffset);
+    // Offset in the pointer without direct state access
+    glGetVertexAttribPointerv(index, GL_VERTEX_ATTRIB_ARRAY_POINTER, &pointer);
+    EXPECT_EQ(GL_TRUE, enabled) << index;
+    EXPECT_EQ(expected[index].size, size) << index;
+    EXPECT_EQ(expected[index].type, type) << index;
+    EXPECT_EQ(expected[index].normalized, normalized) << index;
+    EXPECT_EQ(expected[index].integer, integer) << index;
+    EXPECT_EQ(expected[index].offset, size_t(relativeOffset) + reinterpret_cast<size_t>(pointer)) << index;
+  }
+  GLint enabled = GL_TRUE;
+  glGetVertexAttribiv(4, GL_VERTEX_ATTRIB_ARRAY_ENABLED, &enabled);
+  EXPECT_EQ(GL_FALSE, enabled);
+  binder.unbind();
+  EXPECT_EQ(GLenum(GL_NO_ERROR), glGetError());
+}
@@ -0,0 +1,70 @@
+#include <gtest/gtest.h>
+#include <oglplayground/gpumemory.h>
+
+using OglPlayground::GpuResource;
+
+// The registry is global, tests only look at differences
+
+TEST(GpuMemoryTest, Track) {
+  const auto before = OglPlayground::gpuResourceStats(GpuResource::Texture);
+  OglPlayground::trackGpuAllocation(GpuResource::Texture, 1000);
+  OglPlayground::trackGpuAllocation(GpuResource::Texture, 500);
+  auto stats = OglPlayground::gpuResourceStats(GpuResource::Texture);
+  EXPECT_EQ(before.objects + 2, stats.objects);
+  EXPECT_EQ(before.bytes + 1500, stats.bytes);
+  EXPECT_GE(stats.peakBytes, stats.bytes);
+
+  OglPlayground::trackGpuFree(GpuResource::Texture, 1000);
+  stats = OglPlayground::gpuResourceStats(GpuResource::Texture);
+  EXPECT_EQ(before.objects + 1, stats.objects);
+  EXPECT_EQ(before.bytes + 500, stats.bytes);
+  // The high water mark stays until reset
+  EXPECT_GE(stats.peakBytes, before.bytes + 1500);
+  OglPlayground::resetGpuMemoryPeaks();
+  EXPECT_EQ(stats.bytes, OglPlayground::gpuResourceStats(GpuResource::Texture).peakBytes);
+  OglPlayground::trackGpuFree(GpuResource::Texture, 500);
+}
+
+TEST(GpuMemoryTest, Frames) {
+  const auto first = OglPlayground::endGpuMemoryFrame();
+  OglPlayground::trackGpuAllocation(GpuResource::VertexBuffer, 256);
+  OglPlayground::trackGpuAllocation(GpuResource::IndexBuffer, 64);
+  OglPlayground::trackGpuFree(GpuResource::VertexBuffer, 256);
+  const auto second = OglPlayground::endGpuMemoryFrame();
+  EXPECT_EQ(first.frame + 1, second.frame);
+  EXPECT_EQ(320, second.allocatedBytes);
+  EXPECT_EQ(256, second.freedBytes);
+  EXPECT_EQ(first.bytes + 64, second.bytes);
+  EXPECT_EQ(first.resources[size_t(GpuResource::IndexBuffer)].objects + 1,
+            second.resources[size_t(GpuResource::IndexBuffer)].objects);
+
+  const auto third = OglPlayground::endGpuMemoryFrame();
+  EXPECT_EQ(0, third.allocatedBytes);
+  OglPlayground::trackGpuFree(GpuResource::IndexBuffer, 64);
+}
+
+TEST(GpuMemoryTest, Textures) {
+  // Owners of raw textures track them with texture2DBytes
+  EXPECT_EQ(64u, OglPlayground::texture2DBytes(4, 4, 4, false));
+  EXPECT_EQ(84u, OglPlayground::texture2DBytes(4, 4, 4, true));
+  EXPECT_EQ(21u, OglPlayground::texture2DBytes(4, 1, 3, true));
+
+  const auto before = OglPlayground::gpuResourceStats(GpuResource::Texture);
+  const size_t bytes = OglPlayground::texture2DBytes(1024, 1024, 4, false);
+  OglPlayground::trackGpuAllocation(GpuResource::Texture, bytes);
+  auto stats = OglPlayground::gpuResourceStats(GpuResource::Texture);
+  EXPECT_EQ(before.objects + 1, stats.objects);
+  EXPECT_EQ(before.bytes + (4 << 20), stats.bytes);
+  OglPlayground::trackGpuFree(GpuResource::Texture, bytes);
+  stats = OglPlayground::gpuResourceStats(GpuResource::Texture);
+  EXPECT_EQ(before.objects, stats.objects);
+  EXPECT_EQ(before.bytes, stats.bytes);
+}
+
+TEST(GpuMemoryTest, Targets) {
+  EXPECT_EQ(GpuResource::VertexBuffer, OglPlayground::gpuResourceFromTarget(GL_ARRAY_BUFFER));
+  EXPECT_EQ(GpuResource::IndexBuffer, OglPlayground::gpuResourceFromTarget(GL_ELEMENT_ARRAY_BUFFER));
+  EXPECT_EQ(GpuResource::PixelUnpackBuffer, OglPlayground::gpuResourceFromTarget(GL_PIXEL_UNPACK_BUFFER));
+  EXPECT_EQ(GpuResource::UniformBuffer, OglPlayground::gpuResourceFromTarget(GL_UNIFORM_BUFFER));
+  EXPECT_EQ(GpuResource::OtherBuffer, OglPlayground::gpuResourceFromTarget(GL_COPY_READ_BUFFER));
+}
@@ -0,0 +1,120 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <vector>
+
+#include <gtest/gtest.h>
+#include <oglplayground/lightgrid.h>
+#include <oglplayground/threadpool.h>
+
+using OglPlayground::Camera;
+using OglPlayground::ClusterLight;
+using OglPlayground::ClusterRange;
+using OglPlayground::LightGrid;
+
+namespace
+{
+
+// Camera at the origin looking along +z
+Camera camera_() {
+  Camera camera;
+  camera.setFov(glm::radians(60.f));
+  camera.setAspect(16.f/9.f);
+  camera.setClippingPlanes(0.5f, 100.f);
+  return camera;
+}
+
+// Cluster of a view space point, the way the shader finds it
+uint32_t clusterOf_(const LightGrid& grid, const Camera& camera, const glm::vec3& p) {
+  const glm::vec4 clip = camera.projection() * glm::vec4(p, 1.f);
+  const glm::vec2 uv = (glm::vec2(clip.x, clip.y) / clip.w) * 0.5f + 0.5f;
+  const uint32_t x = std::min(grid.tilesX()-1, uint32_t(std::max(0.f, uv.x * grid.tilesX())));
+  const uint32_t y = std::min(grid.tilesY()-1, uint32_t(std::max(0.f, uv.y * grid.tilesY())));
+  return grid.clusterIndex(x, y, grid.sliceFromDepth(p.z));
+}
+
+bool clusterHasLight_(const LightGrid& grid, uint32_t cluster, uint32_t light) {
+  const ClusterRange& range = grid.clusters()[cluster];
+  const auto begin = grid.lightIndices().begin() + range.offset;
+  return std::find(begin, begin + range.count, light) != begin + range.count;
+}
+
+} // anonymous namespace
+
+TEST(LightGridTest, Slices) {
+  const Camera camera = camera_();
+  LightGrid grid(16, 9, 24);
+  grid.build(camera, nullptr, 0);
+  EXPECT_EQ(16u*9u*24u, grid.clusterCount());
+  EXPECT_EQ(grid.clusterCount(), grid.clusters().size());
+  EXPECT_TRUE(grid.lightIndices().empty());
+
+  EXPECT_EQ(0u, grid.sliceFromDepth(0.5f));
+  EXPECT_EQ(0u, grid.sliceFromDepth(0.1f));
+  EXPECT_EQ(23u, grid.sliceFromDepth(99.f));
+  EXPECT_EQ(23u, grid.sliceFromDepth(1000.f));
+  EXPECT_EQ(12u, grid.sliceFromDepth(std::sqrt(0.5f*100.f) * 1.01f));
+}
+
+TEST(LightGridTest, PointAndSpotLights) {
+  const Camera camera = camera_();
+  std::vector<ClusterLight> lights(4);
+  lights[0].position = glm::vec3(0.f, 0.f, 10.f);
+  lights[0].radius = 1.f;
+  lights[1].position = glm::vec3(0.f, 0.f, -10.f); // Behind the camera
+  lights[1].radius = 1.f;
+  lights[2].position = glm::vec3(0.f, 0.f, 5.f); // Spot facing away from light 0
+  lights[2].radius = 20.f;
+  lights[2].direction = glm::vec3(0.f, 0.f, -1.f);
+  lights[2].spotAngle = glm::radians(20.f);
+  lights[3].position = glm::vec3(0.f, 0.f, 5.f); // Same spot toward light 0
+  lights[3].radius = 20.f;
+  lights[3].spotAngle = glm::radians(20.f);
+
+  LightGrid grid;
+  grid.build(camera, lights.data(), lights.size());
+  const uint32_t center = clusterOf_(grid, camera, lights[0].position);
+  EXPECT_TRUE(clusterHasLight_(grid, center, 0));
+  EXPECT_FALSE(clusterHasLight_(grid, center, 2));
+  EXPECT_TRUE(clusterHasLight_(grid, center, 3));
+  EXPECT_EQ(center, clusterOf_(grid, camera, glm::vec3(0.f, 0.f, 10.f)));
+  EXPECT_FALSE(clusterHasLight_(grid, clusterOf_(grid, camera, glm::vec3(0.f, 0.f, 30.f)), 0));
+  EXPECT_EQ(grid.lightIndices().end(), std::find(grid.lightIndices().begin(), grid.lightIndices().end(), 1u));
+}
+
+TEST(LightGridTest, ConservativeAndThreaded) {
+  // Points inside random lights must find them in their cluster, with the
+  // same result on a pool
+  Camera camera = camera_();
+  camera.transform().translate(glm::vec3(3.f, 1.f, -2.f), OglPlayground::Space::World);
+  srand(42);
+  auto random = [](float range) { return (float(rand()) / float(RAND_MAX) - 0.5f) * range; };
+  std::vector<ClusterLight> lights(500);
+  for(auto& light : lights) {
+    light.position = glm::vec3(random(60.f), random(30.f), 30.f + random(60.f));
+    light.radius = 0.5f + std::abs(random(8.f));
+  }
+
+  LightGrid grid;
+  grid.build(camera, lights.data(), lights.size());
+  const glm::mat4& view = camera.view();
+  for(uint32_t i = 0; i < lights.size(); ++i) {
+    for(int k = 0; k < 8; ++k) {
+      const glm::vec3 offset(random(1.f), random(1.f), random(1.f));
+      const glm::vec3 p = glm::vec3(view * glm::vec4(lights[i].position + offset * lights[i].radius, 1.f));
+      if(p.z < camera.nearPlane() || p.z > camera.farPlane()) continue;
+      const glm::vec4 clip = camera.projection() * glm::vec4(p, 1.f);
+      if(std::abs(clip.x) > clip.w || std::abs(clip.y) > clip.w) continue;
+      EXPECT_TRUE(clusterHasLight_(grid, clusterOf_(grid, camera, p), i));
+    }
+  }
+
+  OglPlayground::ThreadPool pool(3);
+  LightGrid parallelGrid;
+  parallelGrid.build(pool, camera, lights.data(), lights.size());
+  EXPECT_EQ(grid.lightIndices(), parallelGrid.lightIndices());
+  for(uint32_t c = 0; c < grid.clusterCount(); ++c) {
+    EXPECT_EQ(grid.clusters()[c].offset, parallelGrid.clusters()[c].offset);
+    EXPECT_EQ(grid.clusters()[c].count, parallelGrid.clusters()[c].count);
+  }
+}
@@ -0,0 +1,203 @@
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+#include <gtest/gtest.h>
+#include <oglplayground/meshoptimizer.h>
+#include <oglplayground/threadpool.h>
+#include <oglplayground/vertexformat.h>
+
+using OglPlayground::AttributeType;
+using OglPlayground::AttributeUsage;
+using OglPlayground::MeshData;
+
+namespace
+{
+
+// Sphere of position and uv vertices, triangles shuffled so there is
+// something to optimize, and one unused vertex at the end
+MeshData sphere_(uint32_t rings, uint32_t segments, unsigned seed)
+{
+  MeshData mesh;
+  mesh.desc = {{AttributeUsage::Position, 3}, {AttributeUsage::UV0, 2}};
+  std::vector<float> vertices;
+  for(uint32_t r = 0; r <= rings; ++r) {
+    const float theta = 3.14159265f * float(r) / float(rings);
+    for(uint32_t s = 0; s <= segments; ++s) {
+      const float phi = 6.2831853f * float(s) / float(segments);
+      vertices.insert(
+          vertices.end(),
+          {std::sin(theta)*std::cos(phi), std::cos(theta), std::sin(theta)*std::sin(phi),
+           float(s) / float(segments), float(r) / float(rings)});
+    }
+  }
+  vertices.insert(vertices.end(), {0.f, 0.f, 0.f, 0.f, 0.f});
+  mesh.vertices.resize(vertices.size()*sizeof(float));
+  std::memcpy(mesh.vertices.data(), vertices.data(), mesh.vertices.size());
+
+  std::vector<std::array<uint32_t, 3>> triangles;
+  for(uint32_t r = 0; r < rings; ++r) {
+    for(uint32_t s = 0; s < segments; ++s) {
+      const uint32_t a = r*(segments+1) + s;
+      const uint32_t b = a + segments+1;
+      triangles.push_back({a, a+1, b});
+      triangles.push_back({a+1, b+1, b});
+    }
+  }
+  srand(seed);
+  for(size_t i = triangles.size()-1; i > 0; --i) std::swap(triangles[i], triangles[size_t(rand()) % (i+1)]);
+  for(const auto& triangle : triangles) mesh.indices.insert(mesh.indices.end(), triangle.begin(), triangle.end());
+  return mesh;
+}
+
+// Triangles rotated to start with their smallest index then sorted, to
+// compare lists that only differ in order
+std::vector<std::array<uint32_t, 3>> triangles_(const std::vector<uint32_t>& indices)
+{
+  std::vector<std::array<uint32_t, 3>> triangles;
+  for(size_t i = 0; i < indices.size(); i += 3) {
+    std::array<uint32_t, 3> t = {indices[i], indices[i+1], indices[i+2]};
+    while(t[0] != std::min({t[0], t[1], t[2]})) std::rotate(t.begin(), t.begin()+1, t.end());
+    triangles.push_back(t);
+  }
+  std::sort(triangles.begin(), triangles.end());
+  return triangles;
+}
+
+} // anonymous namespace
+
+TEST(MeshOptimizerTest, AnalyzeVertexCache) {
+  const uint32_t indices[] = {0, 1, 2, 0, 2, 3};
+  const auto stats = OglPlayground::analyzeVertexCache(indices, 6, 4);
+  EXPECT_EQ(4u, stats.transformed);
+  EXPECT_FLOAT_EQ(2.f, stats.acmr);
+  EXPECT_FLOAT_EQ(1.f, stats.atvr);
+  // 0 leaves a cache of 2 when 2 comes in
+  EXPECT_EQ(5u, OglPlayground::analyzeVertexCache(indices, 6, 4, 2).transformed);
+}
+
+TEST(MeshOptimizerTest, VertexCache) {
+  const MeshData mesh = sphere_(32, 64, 42);
+  const size_t verticesCount = mesh.verticesCount();
+  std::vector<uint32_t> optimized(mesh.indices.size());
+  OglPlayground::optimizeVertexCache(optimized.data(), mesh.indices.data(), mesh.indices.size(), verticesCount);
+  EXPECT_EQ(triangles_(mesh.indices), triangles_(optimized));
+
+  const auto before = OglPlayground::analyzeVertexCache(mesh.indices.data(), mesh.indices.size(), verticesCount);
+  const auto after = OglPlayground::analyzeVertexCache(optimized.data(), optimized.size(), verticesCount);
+  EXPECT_GT(before.acmr, 2.5f);
+  EXPECT_LT(after.acmr, 0.8f);
+  EXPECT_LT(after.atvr, 1.5f);
+}
+
+TEST(MeshOptimizerTest, Overdraw) {
+  const MeshData mesh = sphere_(32, 64, 42);
+  const size_t verticesCount = mesh.verticesCount();
+  std::vector<uint32_t> tipsified(mesh.indices.size());
+  OglPlayground::optimizeVertexCache(tipsified.data(), mesh.indices.data(), mesh.indices.size(), verticesCount);
+  const float tipsifyAcmr = OglPlayground::analyzeVertexCache(tipsified.data(), tipsified.size(), verticesCount).acmr;
+
+  for(float threshold : {1.f, 1.05f, 1.5f}) {
+    std::vector<uint32_t> optimized(mesh.indices.size());
+    OglPlayground::optimizeOverdraw(
+        optimized.data(),
+        mesh.indices.data(),
+        mesh.indices.size(),
+        mesh.vertices.data(),
+        verticesCount,
+        mesh.desc,
+        threshold);
+    EXPECT_EQ(triangles_(mesh.indices), triangles_(optimized));
+    // Clusters only split where the cache is cold or the running ACMR is
+    // below the target, moving them costs at most a little over it
+    const float acmr = OglPlayground::analyzeVertexCache(optimized.data(), optimized.size(), verticesCount).acmr;
+    EXPECT_LT(acmr, tipsifyAcmr * threshold * 1.1f);
+  }
+}
+
+TEST(MeshOptimizerTest, OverdrawPositionTypes) {
+  // Half positions sort like the same values as floats, other types keep
+  // the Tipsify order
+  const MeshData mesh = sphere_(16, 32, 3);
+  const size_t verticesCount = mesh.verticesCount();
+  MeshData half;
+  half.desc = {{AttributeUsage::Position, 3, AttributeType::Half}, {AttributeUsage::UV0, 2}};
+  half.vertices.resize(verticesCount*16);
+  std::vector<float> rounded(verticesCount*5);
+  std::memcpy(rounded.data(), mesh.vertices.data(), mesh.vertices.size());
+  for(size_t v = 0; v < verticesCount; ++v) {
+    uint16_t h[4] = {};
+    for(size_t k = 0; k < 3; ++k) {
+      h[k] = OglPlayground::floatToHalf(rounded[v*5+k]);
+      rounded[v*5+k] = OglPlayground::halfToFloat(h[k]);
+    }
+    std::memcpy(&half.vertices[v*16], h, sizeof(h));
+    std::memcpy(&half.vertices[v*16+8], &rounded[v*5+3], 2*sizeof(float));
+  }
+
+  std::vector<uint32_t> expected(mesh.indices.size());
+  OglPlayground::optimizeOverdraw(
+      expected.data(), mesh.indices.data(), mesh.indices.size(), rounded.data(), verticesCount, mesh.desc);
+  std::vector<uint32_t> optimized(mesh.indices.size());
+  OglPlayground::optimizeOverdraw(
+      optimized.data(), mesh.indices.data(), mesh.indices.size(), half.vertices.data(), verticesCount, half.desc);
+  EXPECT_EQ(expected, optimized);
+
+  OglPlayground::optimizeVertexCache(expected.data(), mesh.indices.data(), mesh.indices.size(), verticesCount);
+  half.desc[0].type = AttributeType::Int16;
+  half.desc[0].mode = OglPlayground::AttributeMode::Normalized;
+  OglPlayground::optimizeOverdraw(
+      optimized.data(), mesh.indices.data(), mesh.indices.size(), half.vertices.data(), verticesCount, half.desc);
+  EXPECT_EQ(expected, optimized);
+  const OglPlayground::VertexDesc noPosition = {{AttributeUsage::UV0, 4}};
+  std::fill(optimized.begin(), optimized.end(), 0u);
+  OglPlayground::optimizeOverdraw(
+      optimized.data(), mesh.indices.data(), mesh.indices.size(), half.vertices.data(), verticesCount, noPosition);
+  EXPECT_EQ(expected, optimized);
+}
+
+TEST(MeshOptimizerTest, VertexFetch) {
+  const MeshData mesh = sphere_(8, 16, 7);
+  const size_t stride = OglPlayground::strideFromVertexDesc(mesh.desc);
+  const size_t verticesCount = mesh.verticesCount();
+  std::vector<uint32_t> indices = mesh.indices;
+  std::vector<uint8_t> vertices(mesh.vertices.size());
+  const size_t used = OglPlayground::optimizeVertexFetch(
+      vertices.data(), indices.data(), indices.size(), mesh.vertices.data(), verticesCount, stride);
+  EXPECT_EQ(verticesCount-1, used);
+
+  uint32_t next = 0;
+  for(size_t i = 0; i < indices.size(); ++i) {
+    ASSERT_LE(indices[i], next);
+    if(indices[i] == next) ++next;
+    EXPECT_EQ(0, std::memcmp(
+        vertices.data() + indices[i]*stride,
+        mesh.vertices.data() + mesh.indices[i]*stride,
+        stride));
+  }
+  EXPECT_EQ(used, next);
+}
+
+TEST(MeshOptimizerTest, OptimizeMeshes) {
+  std::vector<MeshData> meshes;
+  for(unsigned i = 0; i < 8; ++i) meshes.push_back(sphere_(8 + i*4, 16 + i*8, i));
+  std::vector<MeshData> expected = meshes;
+  std::vector<OglPlayground::MeshOptimizeStats> expectedStats;
+  for(auto& mesh : expected) expectedStats.push_back(OglPlayground::optimizeMesh(mesh));
+
+  OglPlayground::ThreadPool pool(4);
+  const auto stats = OglPlayground::optimizeMeshes(pool, meshes);
+  ASSERT_EQ(meshes.size(), stats.size());
+  for(size_t i = 0; i < meshes.size(); ++i) {
+    EXPECT_EQ(expected[i].vertices, meshes[i].vertices);
+    EXPECT_EQ(expected[i].indices, meshes[i].indices);
+    EXPECT_EQ(expectedStats[i].after.transformed, stats[i].after.transformed);
+    EXPECT_LT(stats[i].after.acmr, stats[i].before.acmr);
+    // The unused vertex is gone
+    EXPECT_EQ(stats[i].before.transformed, expectedStats[i].before.transformed);
+    EXPECT_LT(stats[i].after.atvr, stats[i].before.atvr);
+  }
+}
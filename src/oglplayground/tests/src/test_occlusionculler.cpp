@@ -0,0 +1,107 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <vector>
+
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/quaternion.hpp>
+#include <gtest/gtest.h>
+#include <oglplayground/occlusionculler.h>
+#include <oglplayground/threadpool.h>
+
+using OglPlayground::OccluderMesh;
+using OglPlayground::OcclusionCuller;
+using OglPlayground::SimdLevel;
+
+namespace
+{
+
+// Camera at the origin looking along +z
+glm::mat4 viewProjection_() {
+  return glm::perspective(glm::radians(90.f), 2.f, 0.1f, 100.f);
+}
+
+// Quad facing the camera, from -1 to 1 on x and y at z = 0
+OccluderMesh quad_() {
+  const float vertices[] = {
+    -1.f, -1.f, 0.f, 0.f, 0.f,
+    1.f, -1.f, 0.f, 1.f, 0.f,
+    1.f, 1.f, 0.f, 1.f, 1.f,
+    -1.f, 1.f, 0.f, 0.f, 1.f};
+  const uint32_t indices[] = {0, 1, 2, 0, 2, 3};
+  const OglPlayground::VertexDesc desc = {
+    {OglPlayground::AttributeUsage::Position, 3},
+    {OglPlayground::AttributeUsage::UV0, 2}};
+  return OglPlayground::occluderFromVertices(vertices, 4, indices, 6, desc);
+}
+
+} // anonymous namespace
+
+TEST(OcclusionCullerTest, OccluderFromVertices) {
+  const OccluderMesh mesh = quad_();
+  ASSERT_EQ(4u, mesh.positions.size());
+  EXPECT_EQ(glm::vec3(1.f, 1.f, 0.f), mesh.positions[2]);
+  EXPECT_EQ(6u, mesh.indices.size());
+}
+
+TEST(OcclusionCullerTest, Visibility) {
+  // Wall of 10x10 at z = 10 hiding the center of the screen
+  OcclusionCuller culler;
+  culler.begin(viewProjection_());
+  const glm::mat4 model = glm::scale(glm::translate(glm::mat4(1.f), glm::vec3(0.f, 0.f, 10.f)), glm::vec3(5.f, 5.f, 1.f));
+  culler.addOccluder(quad_(), model);
+  culler.rasterize();
+
+  EXPECT_LT(culler.depth(culler.width()/2, culler.height()/2), 1.f);
+  EXPECT_EQ(1.f, culler.depth(0, 0));
+
+  const glm::vec3 unit(0.5f);
+  EXPECT_FALSE(culler.isVisible(glm::vec3(0.f, 0.f, 20.f), unit)); // Behind the wall
+  EXPECT_TRUE(culler.isVisible(glm::vec3(0.f, 0.f, 5.f), unit)); // In front
+  EXPECT_TRUE(culler.isVisible(glm::vec3(0.f, 0.f, 10.f), unit)); // Crossing it
+  EXPECT_TRUE(culler.isVisible(glm::vec3(15.f, 0.f, 20.f), unit)); // Beside it
+  EXPECT_TRUE(culler.isVisible(glm::vec3(12.f, 0.f, 20.f), glm::vec3(3.f))); // Partially hidden
+  EXPECT_TRUE(culler.isVisible(glm::vec3(0.f, 0.f, 0.f), unit)); // Around the eye
+  EXPECT_TRUE(culler.isVisible(glm::vec3(0.f, 0.f, -20.f), unit)); // Behind the eye, left to frustum culling
+  EXPECT_FALSE(culler.isVisible(glm::vec3(200.f, 0.f, 20.f), unit)); // Off screen
+
+  const float cx[] = {0.f, 0.f, 15.f}, cy[] = {0.f, 0.f, 0.f}, cz[] = {20.f, 5.f, 20.f};
+  const float e[] = {0.5f, 0.5f, 0.5f};
+  const OglPlayground::BoxArrays boxes = {cx, cy, cz, e, e, e};
+  uint32_t indices[] = {0, 1, 2};
+  EXPECT_EQ(2u, culler.testBoxes(boxes, indices, 3, indices));
+  EXPECT_EQ(1u, indices[0]);
+  EXPECT_EQ(2u, indices[1]);
+}
+
+TEST(OcclusionCullerTest, SimdLevelsAndThreads) {
+  // Random occluders, the depth must not depend on the simd level or the threads
+  srand(42);
+  auto random = [](float range) { return (float(rand()) / float(RAND_MAX) - 0.5f) * range; };
+  std::vector<glm::mat4> models;
+  for(int i = 0; i < 32; ++i) {
+    glm::mat4 model = glm::translate(glm::mat4(1.f), glm::vec3(random(40.f), random(20.f), 5.f + std::abs(random(40.f))));
+    model = model * glm::mat4_cast(glm::angleAxis(random(6.f), glm::normalize(glm::vec3(random(1.f), random(1.f), 1.f))));
+    models.push_back(glm::scale(model, glm::vec3(1.f + std::abs(random(6.f)))));
+  }
+
+  auto render = [&](OcclusionCuller& culler, OglPlayground::ThreadPool* pool, SimdLevel level) {
+    culler.begin(viewProjection_());
+    for(const glm::mat4& model : models) culler.addOccluder(quad_(), model);
+    if(pool) culler.rasterize(*pool, level);
+    else culler.rasterize(level);
+    std::vector<float> depth;
+    for(uint32_t y = 0; y < culler.height(); ++y) {
+      for(uint32_t x = 0; x < culler.width(); ++x) depth.push_back(culler.depth(x, y));
+    }
+    return depth;
+  };
+
+  OcclusionCuller culler(200, 100);
+  const std::vector<float> expected = render(culler, nullptr, SimdLevel::Scalar);
+  EXPECT_LT(std::count(expected.begin(), expected.end(), 1.f), (std::ptrdiff_t)expected.size());
+  EXPECT_EQ(expected, render(culler, nullptr, SimdLevel::SSE2));
+  EXPECT_EQ(expected, render(culler, nullptr, SimdLevel::AVX2));
+  OglPlayground::ThreadPool pool(3);
+  EXPECT_EQ(expected, render(culler, &pool, SimdLevel::AVX2));
+}
@@ -0,0 +1,80 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <vector>
+
+#include <gtest/gtest.h>
+#include <oglplayground/packedtransform.h>
+#include <oglplayground/transform.h>
+
+using OglPlayground::PackedTransform;
+using OglPlayground::PackedUniformTransform;
+
+namespace
+{
+
+bool nearEqualMat4(const glm::mat4& a, const glm::mat4& b) {
+  for(int c = 0; c < 4; ++c) {
+    for(int r = 0; r < 4; ++r) {
+      if(std::abs(a[c][r] - b[c][r]) > 1e-4f * std::max(1.f, std::abs(a[c][r]))) return false;
+    }
+  }
+  return true;
+}
+
+struct RandomTransforms
+{
+  explicit RandomTransforms(size_t count, bool uniformScale) {
+    srand(42);
+    auto random = [](float range) { return (float(rand()) / float(RAND_MAX) - 0.5f) * range; };
+    for(size_t i = 0; i < count; ++i) {
+      positions.push_back(glm::vec3(random(100.f), random(100.f), random(100.f)));
+      rotations.push_back(glm::normalize(glm::quat(random(2.f), random(2.f), random(2.f), random(2.f))));
+      glm::vec3 scale = glm::vec3(0.5f) + glm::abs(glm::vec3(random(4.f), random(4.f), random(4.f)));
+      if(uniformScale) scale = glm::vec3(scale.x);
+      if(i % 3 == 0) scale = -scale;
+      scales.push_back(scale);
+      matrices.push_back(OglPlayground::matrixFromTRS(positions.back(), rotations.back(), scales.back()));
+    }
+  }
+
+  std::vector<glm::vec3> positions;
+  std::vector<glm::quat> rotations;
+  std::vector<glm::vec3> scales;
+  std::vector<glm::mat4> matrices;
+};
+
+} // anonymous namespace
+
+TEST(PackedTransformTest, FromTRS) {
+  RandomTransforms t(64, false);
+  std::vector<PackedTransform> packed(t.positions.size());
+  OglPlayground::packTransforms(t.positions.data(), t.rotations.data(), t.scales.data(), packed.data(), packed.size());
+  for(size_t i = 0; i < packed.size(); ++i) {
+    EXPECT_PRED2(nearEqualMat4, t.matrices[i], OglPlayground::matrixFromPacked(packed[i]));
+  }
+
+  RandomTransforms u(64, true);
+  std::vector<PackedUniformTransform> packedUniform(u.positions.size());
+  OglPlayground::packTransforms(u.positions.data(), u.rotations.data(), u.scales.data(), packedUniform.data(), packedUniform.size());
+  for(size_t i = 0; i < packedUniform.size(); ++i) {
+    EXPECT_PRED2(nearEqualMat4, u.matrices[i], OglPlayground::matrixFromPacked(packedUniform[i]));
+  }
+}
+
+// Negative scales included, the decomposition may differ but not the matrix
+TEST(PackedTransformTest, FromMatrices) {
+  RandomTransforms t(64, false);
+  std::vector<PackedTransform> packed(t.matrices.size());
+  OglPlayground::packTransforms(t.matrices.data(), packed.data(), packed.size());
+  for(size_t i = 0; i < packed.size(); ++i) {
+    EXPECT_PRED2(nearEqualMat4, t.matrices[i], OglPlayground::matrixFromPacked(packed[i]));
+  }
+
+  RandomTransforms u(64, true);
+  std::vector<PackedUniformTransform> packedUniform(u.matrices.size());
+  OglPlayground::packTransforms(u.matrices.data(), packedUniform.data(), packedUniform.size());
+  for(size_t i = 0; i < packedUniform.size(); ++i) {
+    EXPECT_PRED2(nearEqualMat4, u.matrices[i], OglPlayground::matrixFromPacked(packedUniform[i]));
+  }
+}
@@ -0,0 +1,56 @@
+#include <cstring>
+#include <memory>
+#include <vector>
+
+#include <gtest/gtest.h>
+#include <oglplayground/bufferobject.h>
+#include <oglplayground/resourceloader.h>
+
+#include "glcontext.h"
+
+using OglPlayground::BufferMapping;
+using OglPlayground::BufferObject;
+using OglPlayground::ResourceLoader;
+
+TEST(ResourceLoaderTest, NoContext) {
+  // Loads are dropped without a context, nothing waits forever
+  bool loaded = false;
+  bool published = false;
+  ResourceLoader loader([] { return false; });
+  loader.enqueue([&] { loaded = true; }, [&] { published = true; });
+  loader.finish();
+  EXPECT_EQ(0u, loader.pendingCount());
+  EXPECT_EQ(0u, loader.poll());
+  EXPECT_FALSE(loaded);
+  EXPECT_FALSE(published);
+}
+
+// Needs an opengl 4.4 context, Mesa llvmpipe is enough. Passes without
+// checking anything on machines without one.
+
+TEST(ResourceLoaderTest, SharedContext) {
+  if(!OglPlayground::makeHiddenGLContextCurrent()) return;
+  ResourceLoader loader(OglPlayground::makeSharedGLContextCurrent, OglPlayground::doneGLContextCurrent);
+
+  // Buffers created on the loader thread are used here once published, in order
+  std::vector<std::shared_ptr<BufferObject>> buffers(8);
+  std::vector<int> publishOrder;
+  for(int i = 0; i < 8; ++i) {
+    auto& buffer = buffers[i];
+    loader.enqueue(
+        [&buffer, i] {
+          std::vector<int> data(1024, i);
+          buffer = std::make_shared<BufferObject>(GL_ARRAY_BUFFER, data.size()*sizeof(int), data.data(), GL_STATIC_DRAW);
+        },
+        [&publishOrder, i] { publishOrder.push_back(i); });
+  }
+  loader.finish();
+  EXPECT_EQ(0u, loader.pendingCount());
+  ASSERT_EQ(8u, publishOrder.size());
+  for(int i = 0; i < 8; ++i) {
+    EXPECT_EQ(i, publishOrder[i]);
+    BufferMapping mapping(*buffers[i], GL_MAP_READ_BIT);
+    ASSERT_TRUE(mapping.isValid());
+    EXPECT_EQ(i, mapping.as<int>()[1023]);
+  }
+}
@@ -0,0 +1,58 @@
+#include <cstring>
+#include <vector>
+
+#include <gtest/gtest.h>
+#include <oglplayground/ringbuffer.h>
+
+#include "glcontext.h"
+
+using OglPlayground::RingBuffer;
+
+// Needs an opengl 4.4 context, Mesa llvmpipe is enough. Passes without
+// checking anything on machines without one.
+
+TEST(RingBufferTest, Allocate) {
+  if(!OglPlayground::makeHiddenGLContextCurrent()) return;
+  RingBuffer ring(GL_ARRAY_BUFFER, 1000, 3);
+  EXPECT_EQ(1024u, ring.regionSize());
+  EXPECT_NE(0u, ring.name());
+
+  // Regions follow each other then wrap
+  for(uint32_t frame = 0; frame < 4; ++frame) {
+    ring.beginFrame();
+    size_t offset = 0;
+    ASSERT_NE(nullptr, ring.allocate(10, 4, offset));
+    EXPECT_EQ((frame % 3) * 1024u, offset);
+    ASSERT_NE(nullptr, ring.allocate(16, 256, offset));
+    EXPECT_EQ((frame % 3) * 1024u + 256u, offset);
+    EXPECT_EQ(nullptr, ring.allocate(1024, 4, offset));
+    ring.endFrame();
+  }
+}
+
+TEST(RingBufferTest, Streaming) {
+  // Every frame's data reaches the buffer, frames in flight never stall
+  // once the GPU caught up
+  if(!OglPlayground::makeHiddenGLContextCurrent()) return;
+  RingBuffer ring(GL_ARRAY_BUFFER, 256, 2);
+  std::vector<uint32_t> expected(64*2);
+  for(uint32_t frame = 0; frame < 6; ++frame) {
+    glFinish();
+    ring.beginFrame();
+    size_t offset = 0;
+    uint32_t* data = static_cast<uint32_t*>(ring.allocate(64*sizeof(uint32_t), 4, offset));
+    ASSERT_NE(nullptr, data);
+    for(uint32_t i = 0; i < 64; ++i) {
+      data[i] = frame*100 + i;
+      expected[offset/sizeof(uint32_t) + i] = frame*100 + i;
+    }
+    ring.endFrame();
+  }
+  EXPECT_EQ(0u, ring.stallCount());
+
+  std::vector<uint32_t> content(expected.size());
+  ring.bind();
+  glGetBufferSubData(GL_ARRAY_BUFFER, 0, content.size()*sizeof(uint32_t), content.data());
+  ring.unbind();
+  EXPECT_EQ(expected, content);
+}
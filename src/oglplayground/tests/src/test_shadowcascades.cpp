@@ -0,0 +1,161 @@
+#include <cmath>
+#include <cstdlib>
+#include <vector>
+
+#include <gtest/gtest.h>
+#include <oglplayground/shadowcascades.h>
+
+using OglPlayground::Camera;
+using OglPlayground::ShadowCascades;
+using OglPlayground::Space;
+
+namespace
+{
+
+Camera camera_() {
+  Camera camera;
+  camera.setFov(glm::radians(60.f));
+  camera.setAspect(16.f/9.f);
+  camera.setClippingPlanes(0.5f, 200.f);
+  return camera;
+}
+
+const glm::vec3 lightDirection_(0.3f, -1.f, 0.5f);
+
+// Shadow map coordinates of a world point in a cascade
+glm::vec3 shadowCoordinates_(const ShadowCascades& cascades, uint32_t index, const glm::vec3& p) {
+  const glm::vec4 clip = cascades.cascade(index).viewProjection * glm::vec4(p, 1.f);
+  return glm::vec3(clip) / clip.w;
+}
+
+} // anonymous namespace
+
+TEST(ShadowCascadesTest, PracticalSplits) {
+  float splits[5];
+  OglPlayground::practicalSplits(1.f, 100.f, 4, 0.f, splits);
+  EXPECT_FLOAT_EQ(1.f, splits[0]);
+  EXPECT_FLOAT_EQ(50.5f, splits[2]);
+  EXPECT_FLOAT_EQ(100.f, splits[4]);
+  OglPlayground::practicalSplits(1.f, 100.f, 4, 1.f, splits);
+  EXPECT_FLOAT_EQ(10.f, splits[2]);
+  OglPlayground::practicalSplits(1.f, 100.f, 4, 0.5f, splits);
+  EXPECT_FLOAT_EQ(30.25f, splits[2]);
+  for(int i = 0; i < 4; ++i) EXPECT_LT(splits[i], splits[i+1]);
+}
+
+TEST(ShadowCascadesTest, CoverSlices) {
+  // Points of each camera slice land inside their cascade
+  Camera camera = camera_();
+  camera.transform().translate(glm::vec3(5.f, 2.f, -3.f), Space::World);
+  camera.transform().rotate(glm::vec3(10.f, 40.f, 0.f), Space::Local);
+  ShadowCascades cascades;
+  cascades.setShadowDistance(100.f);
+  cascades.update(camera, lightDirection_);
+  EXPECT_FLOAT_EQ(0.5f, cascades.cascade(0).splitNear);
+  EXPECT_FLOAT_EQ(100.f, cascades.cascade(3).splitFar);
+
+  const glm::mat4 cameraToWorld = glm::inverse(camera.view());
+  const glm::mat4& projection = camera.projection();
+  srand(42);
+  auto random = [](float range) { return (float(rand()) / float(RAND_MAX) - 0.5f) * range; };
+  for(uint32_t c = 0; c < cascades.count(); ++c) {
+    for(int i = 0; i < 100; ++i) {
+      const float depth = cascades.cascade(c).splitNear + (0.5f + random(1.f)) * (cascades.cascade(c).splitFar - cascades.cascade(c).splitNear);
+      const glm::vec3 view(random(2.f) * depth / projection[0][0], random(2.f) * depth / projection[1][1], depth);
+      const glm::vec3 p = shadowCoordinates_(cascades, c, glm::vec3(cameraToWorld * glm::vec4(view, 1.f)));
+      EXPECT_LE(std::abs(p.x), 1.f);
+      EXPECT_LE(std::abs(p.y), 1.f);
+      EXPECT_LE(std::abs(p.z), 1.f);
+    }
+    // The slice corners are the farthest points from the sphere center
+    for(int i = 0; i < 8; ++i) {
+      const float depth = (i & 4) ? cascades.cascade(c).splitFar : cascades.cascade(c).splitNear;
+      const glm::vec3 view((i & 1 ? 1.f : -1.f) * depth / projection[0][0], (i & 2 ? 1.f : -1.f) * depth / projection[1][1], depth);
+      const glm::vec3 p = shadowCoordinates_(cascades, c, glm::vec3(cameraToWorld * glm::vec4(view, 1.f)));
+      EXPECT_LE(std::abs(p.x), 1.f);
+      EXPECT_LE(std::abs(p.y), 1.f);
+      EXPECT_LE(std::abs(p.z), 1.f);
+    }
+  }
+}
+
+TEST(ShadowCascadesTest, Stable) {
+  // Turning the camera keeps the cascade sizes, moving it moves the shadow
+  // map by whole texels
+  Camera camera = camera_();
+  ShadowCascades cascades(4, 1024);
+  cascades.update(camera, lightDirection_);
+  const glm::mat4 first = cascades.cascade(1).viewProjection;
+  const glm::vec3 p(1.f, 2.f, 30.f);
+  const glm::vec3 before = shadowCoordinates_(cascades, 1, p);
+
+  camera.transform().rotate(glm::vec3(0.f, 25.f, 0.f), Space::Local);
+  camera.transform().translate(glm::vec3(0.37f, 0.f, 1.21f), Space::World);
+  cascades.update(camera, lightDirection_);
+  EXPECT_FLOAT_EQ(first[0][0], cascades.cascade(1).viewProjection[0][0]);
+  EXPECT_FLOAT_EQ(first[1][1], cascades.cascade(1).viewProjection[1][1]);
+
+  const glm::vec3 after = shadowCoordinates_(cascades, 1, p);
+  const glm::vec2 texels = (glm::vec2(after.x, after.y) - glm::vec2(before.x, before.y)) * 0.5f * 1024.f;
+  EXPECT_NEAR(texels.x, std::round(texels.x), 1e-2f);
+  EXPECT_NEAR(texels.y, std::round(texels.y), 1e-2f);
+}
+
+TEST(ShadowCascadesTest, CullCasters) {
+  Camera camera = camera_();
+  ShadowCascades cascades;
+  cascades.setShadowDistance(100.f);
+  cascades.update(camera, lightDirection_);
+
+  // Near the camera, far away, behind the camera toward the light, and
+  // far from everything
+  const float cx[] = {0.f, 0.f, -3.f, 500.f};
+  const float cy[] = {0.f, 0.f, 8.f, 0.f};
+  const float cz[] = {2.f, 90.f, 5.f, 0.f};
+  const float e[] = {0.5f, 0.5f, 0.5f, 0.5f};
+  const OglPlayground::BoxArrays boxes = {cx, cy, cz, e, e, e};
+  uint32_t casters[4];
+  uint8_t masks[4];
+  ASSERT_EQ(3u, cascades.cullCasters(boxes, 4, casters, masks));
+  EXPECT_EQ(0u, casters[0]);
+  EXPECT_EQ(1u, masks[0] & 1u);
+  EXPECT_EQ(1u, casters[1]);
+  EXPECT_NE(0u, masks[1] & 8u); // Cascade spheres overlap, it may be in the third as well
+  EXPECT_EQ(0u, masks[1] & 1u);
+  EXPECT_EQ(2u, casters[2]);
+  EXPECT_NE(0u, masks[2] & 1u);
+}
+
+TEST(ShadowCascadesTest, CullCastersSimdLevels) {
+  // Light space test must agree with the cascade frustums, at every level
+  Camera camera = camera_();
+  camera.transform().rotate(glm::vec3(0.f, 30.f, 0.f), Space::Local);
+  ShadowCascades cascades;
+  cascades.setShadowDistance(100.f);
+  cascades.update(camera, lightDirection_);
+
+  srand(42);
+  auto random = [](float range) { return (float(rand()) / float(RAND_MAX) - 0.5f) * range; };
+  std::vector<float> c[3], e[3];
+  for(int i = 0; i < 1001; ++i) {
+    for(int a = 0; a < 3; ++a) {
+      c[a].push_back(random(300.f));
+      e[a].push_back(0.5f + std::abs(random(4.f)));
+    }
+  }
+  const OglPlayground::BoxArrays boxes = {c[0].data(), c[1].data(), c[2].data(), e[0].data(), e[1].data(), e[2].data()};
+  const size_t count = c[0].size();
+
+  std::vector<uint32_t> expected(count, 0), visible(count);
+  for(uint32_t k = 0; k < cascades.count(); ++k) {
+    const size_t visibleCount = OglPlayground::cullBoxes(cascades.frustum(k), boxes, count, visible.data());
+    for(size_t i = 0; i < visibleCount; ++i) expected[visible[i]] |= 1u << k;
+  }
+  for(OglPlayground::SimdLevel level : {OglPlayground::SimdLevel::Scalar, OglPlayground::SimdLevel::SSE2, OglPlayground::SimdLevel::AVX2}) {
+    std::vector<uint8_t> masks(count);
+    const size_t casterCount = cascades.cullCasters(boxes, count, visible.data(), masks.data(), level);
+    std::vector<uint32_t> masksByBox(count, 0);
+    for(size_t i = 0; i < casterCount; ++i) masksByBox[visible[i]] = masks[i];
+    EXPECT_EQ(expected, masksByBox);
+  }
+}
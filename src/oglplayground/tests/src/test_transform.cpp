@@ -1,11 +1,17 @@
+#include <cstdlib>
+#include <vector>
+
 #include <glm/gtx/quaternion.hpp>
 #include <gtest/gtest.h>
 #include <oglplayground/transform.h>
 #include <oglplayground/debug.h>
 
+using OglPlayground::SimdLevel;
 using OglPlayground::Transform;
 using OglPlayground::Space;
 
+const SimdLevel simdLevels[] = {SimdLevel::Scalar, SimdLevel::SSE2, SimdLevel::AVX2};
+
 TEST(TransformTest, LeftHanded) {
   EXPECT_EQ(glm::vec3(1.f, 0.f, 0.f), Transform::worldRight);
   EXPECT_EQ(glm::vec3(0.f, 1.f, 0.f), Transform::worldUp);
@@ -58,6 +64,23 @@ void check(const Transform& tf, const ExpectedValues& expected) {
 
   EXPECT_PRED2(floatEqualMat4, expected.localToWorld, tf.localToWorldMatrix());
   EXPECT_PRED2(floatEqualMat4, expected.worldToLocal, tf.worldToLocalMatrix());
+
+  // Batched path, enough copies to go through the SIMD loops and their tails
+  const size_t count = 13;
+  const std::vector<glm::vec3> positions(count, tf.localPosition());
+  const std::vector<glm::quat> rotations(count, tf.localRotation());
+  const std::vector<glm::vec3> scales(count, tf.localScale());
+  for(SimdLevel level : simdLevels) {
+    std::vector<glm::mat4> matrices(count);
+    OglPlayground::composeMatrices(positions.data(), rotations.data(), scales.data(), matrices.data(), count, level);
+    for(const auto& m : matrices) {
+      EXPECT_PRED2(floatEqualMat4, expected.localToWorld, m);
+    }
+    OglPlayground::composeInverseMatrices(positions.data(), rotations.data(), scales.data(), matrices.data(), count, level);
+    for(const auto& m : matrices) {
+      EXPECT_PRED2(floatEqualMat4, expected.worldToLocal, m);
+    }
+  }
 }
 
 TEST(TransformTest, Default) {
@@ -336,5 +359,98 @@ TEST(TransformTest, LookAt) {
   check(tf, expected);
 }
 
+TEST(TransformTest, Versioning) {
+  Transform tf;
+  uint64_t version = tf.version();
+  const glm::mat4 identity = tf.localToWorldMatrix();
+  EXPECT_EQ(version, tf.version());
+
+  auto expectNewVersion = [&]() {
+    EXPECT_LT(version, tf.version());
+    version = tf.version();
+  };
+
+  tf.setLocalPosition(glm::vec3(1.f, 2.f, 3.f));
+  expectNewVersion();
+  EXPECT_NE(identity, tf.localToWorldMatrix());
+  EXPECT_PRED2(floatEqualMat4, glm::inverse(tf.localToWorldMatrix()), tf.worldToLocalMatrix());
+
+  tf.setLocalRotation(glm::quat(glm::radians(glm::vec3(0.f, 45.f, 0.f))));
+  expectNewVersion();
+  tf.setLocalScale(glm::vec3(2.f));
+  expectNewVersion();
+  tf.translate(glm::vec3(1.f, 0.f, 0.f), Space::Local);
+  expectNewVersion();
+  tf.rotate(glm::vec3(0.f, 45.f, 0.f), Space::World);
+  expectNewVersion();
+  tf.scale(glm::vec3(0.5f));
+  expectNewVersion();
+  tf.lookAt(glm::vec3(10.f, 0.f, 0.f), Transform::worldUp);
+  expectNewVersion();
+
+  // Cached matrices follow the latest state
+  Transform copy;
+  copy.setLocalPosition(tf.localPosition());
+  copy.setLocalRotation(tf.localRotation());
+  copy.setLocalScale(tf.localScale());
+  EXPECT_EQ(copy.localToWorldMatrix(), tf.localToWorldMatrix());
+  EXPECT_EQ(copy.worldToLocalMatrix(), tf.worldToLocalMatrix());
+}
+
+struct RandomTRS
+{
+  std::vector<glm::vec3> positions;
+  std::vector<glm::quat> rotations;
+  std::vector<glm::vec3> scales;
+};
+
+RandomTRS randomTRS(size_t count) {
+  srand(42);
+  auto random = [](float range) { return (float(rand()) / float(RAND_MAX) - 0.5f) * range; };
+  // Keep scales away from zero so matrices stay invertible
+  auto randomScale = [&]() { const float s = random(4.f); return s < 0.f ? s-0.25f : s+0.25f; };
+  RandomTRS trs;
+  for(size_t i = 0; i < count; ++i) {
+    trs.positions.push_back(glm::vec3(random(100.f), random(100.f), random(100.f)));
+    trs.rotations.push_back(glm::normalize(glm::quat(random(2.f), random(2.f), random(2.f), random(2.f))));
+    trs.scales.push_back(glm::vec3(randomScale(), randomScale(), randomScale()));
+  }
+  return trs;
+}
 
+TEST(TransformTest, ComposeMatrices) {
+  const size_t count = 67;
+  const RandomTRS trs = randomTRS(count);
 
+  // Every level gives the same values than matrixFromTRS, whatever the count
+  for(SimdLevel level : simdLevels) {
+    for(size_t n : {size_t(0), size_t(1), size_t(4), size_t(8), count}) {
+      std::vector<glm::mat4> matrices(n);
+      OglPlayground::composeMatrices(
+          trs.positions.data(), trs.rotations.data(), trs.scales.data(), matrices.data(), n, level);
+      for(size_t i = 0; i < n; ++i) {
+        EXPECT_EQ(OglPlayground::matrixFromTRS(trs.positions[i], trs.rotations[i], trs.scales[i]), matrices[i]);
+      }
+    }
+  }
+}
+
+TEST(TransformTest, ComposeInverseMatrices) {
+  const size_t count = 67;
+  const RandomTRS trs = randomTRS(count);
+
+  for(size_t i = 0; i < count; ++i) {
+    const glm::mat4 m = OglPlayground::matrixFromTRS(trs.positions[i], trs.rotations[i], trs.scales[i]);
+    const glm::mat4 inverse = OglPlayground::inverseMatrixFromTRS(trs.positions[i], trs.rotations[i], trs.scales[i]);
+    EXPECT_PRED2(floatEqualMat4, glm::mat4(1.f), m * inverse);
+  }
+
+  for(SimdLevel level : simdLevels) {
+    std::vector<glm::mat4> matrices(count);
+    OglPlayground::composeInverseMatrices(
+        trs.positions.data(), trs.rotations.data(), trs.scales.data(), matrices.data(), count, level);
+    for(size_t i = 0; i < count; ++i) {
+      EXPECT_EQ(OglPlayground::inverseMatrixFromTRS(trs.positions[i], trs.rotations[i], trs.scales[i]), matrices[i]);
+    }
+  }
+}
@@ -0,0 +1,118 @@
+#include <cstring>
+#include <vector>
+
+#include <gtest/gtest.h>
+#include <oglplayground/transformbuffer.h>
+
+#include "glcontext.h"
+
+using OglPlayground::BufferMapping;
+using OglPlayground::PackedTransform;
+using OglPlayground::PackedUniformTransform;
+using OglPlayground::TransformBuffer;
+using OglPlayground::TransformHierarchy;
+
+namespace
+{
+
+// Buffer content starting at 0, size bytes
+std::vector<uint8_t> readBack_(const TransformBuffer& buffer, size_t size)
+{
+  BufferMapping mapping(buffer.buffer(), 0, size, GL_MAP_READ_BIT);
+  if(!mapping.isValid()) return {};
+  const uint8_t* data = mapping.as<uint8_t>();
+  return std::vector<uint8_t>(data, data+size);
+}
+
+template<typename T>
+std::vector<uint8_t> bytes_(const std::vector<T>& values)
+{
+  const uint8_t* data = reinterpret_cast<const uint8_t*>(values.data());
+  return std::vector<uint8_t>(data, data + values.size()*sizeof(T));
+}
+
+// What a full upload of the hierarchy world matrices gives
+std::vector<uint8_t> packedHierarchy_(const TransformHierarchy& hierarchy)
+{
+  std::vector<PackedTransform> packed(hierarchy.size());
+  OglPlayground::packTransforms(hierarchy.worldMatrices(), packed.data(), packed.size());
+  return bytes_(packed);
+}
+
+} // anonymous namespace
+
+// Needs an opengl 4.4 context, Mesa llvmpipe is enough. Passes without
+// checking anything on machines without one.
+
+TEST(TransformBufferTest, Upload) {
+  if(!OglPlayground::makeHiddenGLContextCurrent()) return;
+  TransformBuffer buffer;
+
+  std::vector<PackedTransform> transforms(5);
+  for(size_t i = 0; i < transforms.size(); ++i) {
+    transforms[i].rotation = glm::vec4(0.f, 0.f, 0.f, 1.f);
+    transforms[i].position = glm::vec3(float(i), 2.f*float(i), -1.f);
+    transforms[i].scale = glm::vec3(1.f + float(i));
+  }
+  buffer.upload(transforms.data(), transforms.size());
+  EXPECT_LE(transforms.size()*sizeof(PackedTransform), buffer.capacity());
+  EXPECT_EQ(bytes_(transforms), readBack_(buffer, transforms.size()*sizeof(PackedTransform)));
+
+  // More bytes than the capacity, the buffer grows
+  std::vector<PackedUniformTransform> uniforms(9);
+  for(size_t i = 0; i < uniforms.size(); ++i) {
+    uniforms[i].rotation = glm::vec4(0.f, 1.f, 0.f, 0.f);
+    uniforms[i].positionScale = glm::vec4(float(i), 0.f, 3.f, 0.5f*float(i));
+  }
+  buffer.upload(uniforms.data(), uniforms.size());
+  EXPECT_LE(uniforms.size()*sizeof(PackedUniformTransform), buffer.capacity());
+  EXPECT_EQ(bytes_(uniforms), readBack_(buffer, uniforms.size()*sizeof(PackedUniformTransform)));
+  EXPECT_EQ(GLenum(GL_NO_ERROR), glGetError());
+}
+
+TEST(TransformBufferTest, UploadHierarchy) {
+  if(!OglPlayground::makeHiddenGLContextCurrent()) return;
+  TransformHierarchy hierarchy;
+  std::vector<TransformHierarchy::NodeId> nodes;
+  for(uint32_t i = 0; i < 64; ++i) {
+    nodes.push_back(hierarchy.create(i == 0 ? TransformHierarchy::invalidNode : nodes[(i-1)/2]));
+    hierarchy.setLocalPosition(nodes.back(), glm::vec3(float(i), 1.f, 0.f));
+  }
+  hierarchy.update();
+  TransformBuffer buffer;
+  buffer.upload(hierarchy);
+  const size_t firstSize = hierarchy.size()*sizeof(PackedTransform);
+  EXPECT_EQ(packedHierarchy_(hierarchy), readBack_(buffer, firstSize));
+
+  // Changed ranges coalesced, nodes moved by setParent and destroy, and new
+  // nodes past the capacity so the buffer grows and gets everything
+  hierarchy.setLocalPosition(nodes[3], glm::vec3(0.f, 5.f, 0.f));
+  hierarchy.setLocalPosition(nodes[5], glm::vec3(0.f, 6.f, 0.f));
+  hierarchy.setLocalRotation(nodes[40], glm::angleAxis(0.5f, glm::vec3(0.f, 1.f, 0.f)));
+  hierarchy.setParent(nodes[10], nodes[50]);
+  hierarchy.destroy(nodes[60]);
+  for(uint32_t i = 0; i < 32; ++i) {
+    hierarchy.setLocalScale(hierarchy.create(nodes[i]), glm::vec3(2.f));
+  }
+  hierarchy.update();
+  buffer.upload(hierarchy, 4);
+  const size_t secondSize = hierarchy.size()*sizeof(PackedTransform);
+  EXPECT_GT(secondSize, firstSize);
+  EXPECT_EQ(packedHierarchy_(hierarchy), readBack_(buffer, secondSize));
+
+  // Incremental again, in place without any gap merging
+  hierarchy.setLocalPosition(nodes[7], glm::vec3(-1.f, 0.f, 2.f));
+  hierarchy.setParent(nodes[20], TransformHierarchy::invalidNode);
+  hierarchy.update();
+  buffer.upload(hierarchy, 0);
+  EXPECT_EQ(packedHierarchy_(hierarchy), readBack_(buffer, hierarchy.size()*sizeof(PackedTransform)));
+
+  // Two updates before an upload, the first one's changes still arrive
+  hierarchy.setLocalPosition(nodes[9], glm::vec3(4.f, 0.f, 0.f));
+  hierarchy.update();
+  hierarchy.setLocalPosition(nodes[30], glm::vec3(0.f, 0.f, 4.f));
+  hierarchy.update();
+  buffer.upload(hierarchy);
+  EXPECT_EQ(packedHierarchy_(hierarchy), readBack_(buffer, hierarchy.size()*sizeof(PackedTransform)));
+  EXPECT_EQ(GLenum(GL_NO_ERROR), glGetError());
+}
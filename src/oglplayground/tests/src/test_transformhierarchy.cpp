@@ -0,0 +1,227 @@
+#include <cstdlib>
+#include <cstring>
+
+#include <glm/gtx/quaternion.hpp>
+#include <gtest/gtest.h>
+#include <oglplayground/threadpool.h>
+#include <oglplayground/transformhierarchy.h>
+#include <oglplayground/debug.h>
+
+using OglPlayground::Space;
+using OglPlayground::Transform;
+using OglPlayground::TransformHierarchy;
+
+namespace
+{
+
+const float fprecision = 1000.f;
+bool roundedEqualMat4(glm::mat4 a, glm::mat4 b) {
+  auto rf = [](glm::vec4 v) { return glm::round(v*fprecision) / fprecision; };
+  a = glm::mat4(rf(a[0]), rf(a[1]), rf(a[2]), rf(a[3]));
+  b = glm::mat4(rf(b[0]), rf(b[1]), rf(b[2]), rf(b[3]));
+  return a == b;
+}
+
+bool roundedEqualVec3(glm::vec3 a, glm::vec3 b) {
+  a = glm::round(a*fprecision) / fprecision;
+  b = glm::round(b*fprecision) / fprecision;
+  return a == b;
+}
+
+// Every parent must be stored before its children
+bool isSortedParentFirst(const TransformHierarchy& hierarchy) {
+  const uint32_t* parents = hierarchy.parentIndices();
+  for(uint32_t i = 0; i < hierarchy.size(); ++i) {
+    if(parents[i] != TransformHierarchy::noParent && parents[i] >= i) return false;
+  }
+  return true;
+}
+
+} // anonymous namespace
+
+TEST(TransformHierarchyTest, CreateDestroy) {
+  TransformHierarchy hierarchy;
+  const auto root = hierarchy.create();
+  const auto child = hierarchy.create(root);
+  const auto grandChild = hierarchy.create(child);
+  const auto other = hierarchy.create();
+  EXPECT_EQ(4u, hierarchy.size());
+  EXPECT_EQ(TransformHierarchy::invalidNode, hierarchy.parent(root));
+  EXPECT_EQ(root, hierarchy.parent(child));
+  EXPECT_EQ(child, hierarchy.parent(grandChild));
+
+  hierarchy.destroy(child);
+  EXPECT_EQ(2u, hierarchy.size());
+  EXPECT_TRUE(hierarchy.isValid(root));
+  EXPECT_FALSE(hierarchy.isValid(child));
+  EXPECT_FALSE(hierarchy.isValid(grandChild));
+  EXPECT_TRUE(hierarchy.isValid(other));
+  EXPECT_EQ(other, hierarchy.nodeAt(hierarchy.indexOf(other)));
+  EXPECT_TRUE(isSortedParentFirst(hierarchy));
+}
+
+TEST(TransformHierarchyTest, ReparentKeepsOrder) {
+  TransformHierarchy hierarchy;
+  const auto a = hierarchy.create();
+  const auto b = hierarchy.create(a);
+  const auto c = hierarchy.create();
+  const auto d = hierarchy.create(c);
+
+  // a is now below d which is stored after it
+  hierarchy.setParent(a, d);
+  EXPECT_TRUE(isSortedParentFirst(hierarchy));
+  EXPECT_EQ(d, hierarchy.parent(a));
+  EXPECT_EQ(a, hierarchy.parent(b));
+  EXPECT_EQ(c, hierarchy.parent(d));
+
+  // Cycles are refused
+#ifdef NDEBUG
+  hierarchy.setParent(c, b);
+  EXPECT_EQ(TransformHierarchy::invalidNode, hierarchy.parent(c));
+#endif
+}
+
+TEST(TransformHierarchyTest, WorldMatrices) {
+  TransformHierarchy hierarchy;
+  Transform root = hierarchy.transform(hierarchy.create());
+  Transform child = hierarchy.transform(hierarchy.create(root.node()));
+
+  root.translate(glm::vec3(5.f, 3.f, 1.f), Space::World);
+  root.rotate(glm::vec3(0.f, 90.f, 0.f), Space::Local);
+  child.translate(glm::vec3(1.f, 0.f, 0.f), Space::World);
+
+  // World translation of the child is expressed in the parent space
+  EXPECT_PRED2(roundedEqualVec3, glm::vec3(0.f, 0.f, 1.f), child.localPosition());
+  EXPECT_PRED2(roundedEqualVec3, glm::vec3(6.f, 3.f, 1.f), child.position());
+  EXPECT_PRED2(roundedEqualVec3, root.forward(), child.forward());
+
+  // Lazy path and update() agree
+  const glm::mat4 lazy = child.localToWorldMatrix();
+  hierarchy.update();
+  EXPECT_EQ(lazy, child.localToWorldMatrix());
+  EXPECT_EQ(lazy, hierarchy.worldMatrices()[hierarchy.indexOf(child.node())]);
+  EXPECT_PRED2(
+      roundedEqualMat4,
+      root.localToWorldMatrix() * OglPlayground::matrixFromTRS(
+          child.localPosition(), child.localRotation(), child.localScale()),
+      child.localToWorldMatrix());
+}
+
+TEST(TransformHierarchyTest, LookAtWithParent) {
+  TransformHierarchy hierarchy;
+  Transform root = hierarchy.transform(hierarchy.create());
+  Transform child = hierarchy.transform(hierarchy.create(root.node()));
+  root.rotate(glm::vec3(0.f, 45.f, 0.f), Space::Local);
+  child.translate(glm::vec3(5.f, 3.f, 1.f), Space::World);
+  child.lookAt(glm::vec3(10.f, 0.f, 0.f), Transform::worldUp);
+
+  // Same world result than a detached transform
+  Transform detached;
+  detached.translate(glm::vec3(5.f, 3.f, 1.f), Space::World);
+  detached.lookAt(glm::vec3(10.f, 0.f, 0.f), Transform::worldUp);
+  EXPECT_PRED2(roundedEqualMat4, detached.localToWorldMatrix(), child.localToWorldMatrix());
+}
+
+TEST(TransformHierarchyTest, Versioning) {
+  TransformHierarchy hierarchy;
+  Transform root = hierarchy.transform(hierarchy.create());
+  Transform child = hierarchy.transform(hierarchy.create(root.node()));
+  Transform other = hierarchy.transform(hierarchy.create());
+  hierarchy.update();
+
+  const uint64_t childVersion = child.version();
+  const uint64_t otherVersion = other.version();
+  const glm::mat4 childMatrix = child.localToWorldMatrix();
+
+  // Moving the parent changes the child version and matrix
+  root.translate(glm::vec3(1.f, 0.f, 0.f), Space::World);
+  EXPECT_LT(childVersion, child.version());
+  EXPECT_EQ(otherVersion, other.version());
+  EXPECT_NE(childMatrix, child.localToWorldMatrix());
+
+  hierarchy.update();
+  EXPECT_EQ(child.localToWorldMatrix(), hierarchy.worldMatrices()[hierarchy.indexOf(child.node())]);
+
+  // Reparenting under an older node still increases the version
+  const uint64_t beforeReparent = child.version();
+  hierarchy.setParent(child.node(), other.node());
+  EXPECT_LT(beforeReparent, child.version());
+  EXPECT_PRED2(roundedEqualVec3, glm::vec3(0.f), child.position());
+}
+
+TEST(TransformHierarchyTest, ParallelUpdate) {
+  // Wide and deep enough to give several tasks per level, created out of
+  // depth order so the parallel update has to sort first
+  TransformHierarchy hierarchy;
+  srand(42);
+  std::vector<TransformHierarchy::NodeId> nodes;
+  for(int i = 0; i < 20000; ++i) {
+    const auto parent = nodes.empty() || rand() % 8 == 0 ? TransformHierarchy::invalidNode : nodes[rand() % nodes.size()];
+    const auto node = hierarchy.create(parent);
+    hierarchy.setLocalPosition(node, glm::vec3(rand() % 7, rand() % 5, rand() % 3));
+    hierarchy.setLocalRotation(node, glm::angleAxis(float(rand() % 360), glm::vec3(0.f, 1.f, 0.f)));
+    nodes.push_back(node);
+  }
+
+  std::vector<glm::mat4> reference;
+  for(auto node : nodes) reference.push_back(hierarchy.localToWorldMatrix(node));
+
+  // Bit identical results whatever the thread count
+  std::vector<glm::mat4> first;
+  for(size_t threadCount : {1, 2, 4}) {
+    OglPlayground::ThreadPool pool(threadCount);
+    for(auto node : nodes) hierarchy.setLocalScale(node, hierarchy.localScale(node));
+    hierarchy.update(pool); // Everything flagged, full recompute
+    EXPECT_TRUE(isSortedParentFirst(hierarchy));
+
+    std::vector<glm::mat4> matrices;
+    for(auto node : nodes) matrices.push_back(hierarchy.worldMatrices()[hierarchy.indexOf(node)]);
+    if(first.empty()) first = matrices;
+    EXPECT_EQ(0, memcmp(first.data(), matrices.data(), matrices.size()*sizeof(glm::mat4)));
+  }
+  for(size_t i = 0; i < nodes.size(); ++i) {
+    EXPECT_PRED2(roundedEqualMat4, reference[i], first[i]);
+  }
+}
+
+TEST(TransformHierarchyTest, ChangedRanges) {
+  TransformHierarchy hierarchy;
+  std::vector<TransformHierarchy::NodeId> nodes;
+  for(int i = 0; i < 10; ++i) nodes.push_back(hierarchy.create());
+  std::vector<OglPlayground::IndexRange> ranges;
+
+  // New nodes are all changed, then nothing is
+  hierarchy.update();
+  hierarchy.changedRanges(ranges);
+  ASSERT_EQ(1u, ranges.size());
+  EXPECT_EQ(0u, ranges[0].first);
+  EXPECT_EQ(10u, ranges[0].count);
+  hierarchy.update();
+  hierarchy.changedRanges(ranges);
+  EXPECT_TRUE(ranges.empty());
+  EXPECT_EQ(2u, hierarchy.updateCount());
+
+  // Separate runs, merged when the gap is small enough
+  hierarchy.setLocalPosition(nodes[1], glm::vec3(1.f));
+  hierarchy.setLocalPosition(nodes[2], glm::vec3(1.f));
+  hierarchy.setLocalPosition(nodes[5], glm::vec3(1.f));
+  hierarchy.update();
+  hierarchy.changedRanges(ranges);
+  ASSERT_EQ(2u, ranges.size());
+  EXPECT_EQ(1u, ranges[0].first);
+  EXPECT_EQ(2u, ranges[0].count);
+  EXPECT_EQ(5u, ranges[1].first);
+  EXPECT_EQ(1u, ranges[1].count);
+  hierarchy.changedRanges(ranges, 2);
+  ASSERT_EQ(1u, ranges.size());
+  EXPECT_EQ(1u, ranges[0].first);
+  EXPECT_EQ(5u, ranges[0].count);
+
+  // Destroying shifts every following node
+  hierarchy.destroy(nodes[7]);
+  hierarchy.update();
+  hierarchy.changedRanges(ranges);
+  ASSERT_EQ(1u, ranges.size());
+  EXPECT_EQ(7u, ranges[0].first);
+  EXPECT_EQ(2u, ranges[0].count);
+}
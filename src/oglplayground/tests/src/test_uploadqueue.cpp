@@ -0,0 +1,107 @@
+#include <cstring>
+#include <vector>
+
+#include <gtest/gtest.h>
+#include <oglplayground/bufferobject.h>
+#include <oglplayground/uploadqueue.h>
+
+#include "glcontext.h"
+
+using OglPlayground::BufferMapping;
+using OglPlayground::BufferObject;
+using OglPlayground::UploadQueue;
+
+// Needs an opengl 4.4 context, Mesa llvmpipe is enough. Passes without
+// checking anything on machines without one.
+
+TEST(UploadQueueTest, Buffers) {
+  if(!OglPlayground::makeHiddenGLContextCurrent()) return;
+  UploadQueue queue(1024, 2);
+  std::vector<uint32_t> data(1024);
+  for(uint32_t i = 0; i < data.size(); ++i) data[i] = i;
+  BufferObject a(GL_ARRAY_BUFFER, 4096, nullptr, GL_STATIC_DRAW);
+  BufferObject b(GL_ARRAY_BUFFER, 64, nullptr, GL_STATIC_DRAW);
+
+  // Contiguous uploads to a merge in one copy, b needs its own
+  queue.uploadBuffer(a, 0, data.data(), 64);
+  queue.uploadBuffer(a, 64, data.data()+16, 64);
+  queue.uploadBuffer(b, 0, data.data(), 64);
+  EXPECT_EQ(192u, queue.pendingBytes());
+  EXPECT_EQ(192u, queue.flush());
+  EXPECT_EQ(2u, queue.lastCallCount());
+  EXPECT_EQ(0u, queue.pendingCount());
+
+  // Larger than the budget, split over frames
+  queue.uploadBuffer(a, 0, data.data(), 4096);
+  EXPECT_EQ(1024u, queue.flush());
+  EXPECT_EQ(3072u, queue.pendingBytes());
+  queue.finish();
+  EXPECT_EQ(0u, queue.pendingBytes());
+
+  BufferMapping mapping(a, GL_MAP_READ_BIT);
+  ASSERT_TRUE(mapping.isValid());
+  EXPECT_EQ(0, memcmp(data.data(), mapping.data(), 4096));
+}
+
+TEST(UploadQueueTest, Texture) {
+  if(!OglPlayground::makeHiddenGLContextCurrent()) return;
+  UploadQueue queue(1024, 2);
+  GLuint texture = 0;
+  glGenTextures(1, &texture);
+  glBindTexture(GL_TEXTURE_2D, texture);
+  glTexStorage2D(GL_TEXTURE_2D, 1, GL_RGBA8, 16, 32);
+  glBindTexture(GL_TEXTURE_2D, 0);
+
+  // Quarters of 512 bytes, two per frame
+  std::vector<uint32_t> pixels(16*32);
+  for(uint32_t i = 0; i < pixels.size(); ++i) pixels[i] = i * 2654435761u;
+  for(int i = 0; i < 4; ++i) {
+    queue.uploadTexture2D(texture, 0, 0, 8*i, 16, 8, GL_RGBA, GL_UNSIGNED_BYTE, &pixels[128*i], 512);
+  }
+  for(int i = 0; i < 2; ++i) {
+    EXPECT_EQ(1024u, queue.flush());
+    EXPECT_EQ(2u, queue.lastCallCount());
+  }
+  EXPECT_EQ(0u, queue.pendingCount());
+
+  std::vector<uint32_t> read(pixels.size());
+  glBindTexture(GL_TEXTURE_2D, texture);
+  glGetTexImage(GL_TEXTURE_2D, 0, GL_RGBA, GL_UNSIGNED_BYTE, read.data());
+  glBindTexture(GL_TEXTURE_2D, 0);
+  glDeleteTextures(1, &texture);
+  EXPECT_EQ(pixels, read);
+}
+
+TEST(UploadQueueTest, TextureOverBudget) {
+  if(!OglPlayground::makeHiddenGLContextCurrent()) return;
+  // Larger than a staging region, uploaded alone in its own flush
+  UploadQueue queue(1024, 2);
+  GLuint texture = 0;
+  glGenTextures(1, &texture);
+  glBindTexture(GL_TEXTURE_2D, texture);
+  glTexStorage2D(GL_TEXTURE_2D, 1, GL_RGBA8, 16, 32);
+  glBindTexture(GL_TEXTURE_2D, 0);
+  BufferObject buffer(GL_ARRAY_BUFFER, 64, nullptr, GL_STATIC_DRAW);
+
+  std::vector<uint32_t> pixels(16*32);
+  for(uint32_t i = 0; i < pixels.size(); ++i) pixels[i] = i * 2654435761u;
+  queue.uploadBuffer(buffer, 0, pixels.data(), 64);
+  queue.uploadTexture2D(texture, 0, 0, 0, 16, 32, GL_RGBA, GL_UNSIGNED_BYTE, pixels.data(), 2048);
+  queue.uploadBuffer(buffer, 0, pixels.data(), 64);
+  EXPECT_EQ(64u, queue.flush());
+  // Left bound by the caller, the upload still reads client memory
+  BufferObject unpack(GL_PIXEL_UNPACK_BUFFER, 4096, nullptr, GL_STATIC_DRAW);
+  unpack.bind();
+  EXPECT_EQ(2048u, queue.flush());
+  unpack.unbind();
+  EXPECT_EQ(1u, queue.lastCallCount());
+  queue.finish();
+  EXPECT_EQ(0u, queue.pendingCount());
+
+  std::vector<uint32_t> read(pixels.size());
+  glBindTexture(GL_TEXTURE_2D, texture);
+  glGetTexImage(GL_TEXTURE_2D, 0, GL_RGBA, GL_UNSIGNED_BYTE, read.data());
+  glBindTexture(GL_TEXTURE_2D, 0);
+  glDeleteTextures(1, &texture);
+  EXPECT_EQ(pixels, read);
+}
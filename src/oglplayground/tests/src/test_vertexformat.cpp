@@ -0,0 +1,147 @@
+#include <cmath>
+#include <cstdlib>
+#include <limits>
+#include <vector>
+
+#include <gtest/gtest.h>
+#include <oglplayground/geometry.h>
+#include <oglplayground/vertexformat.h>
+
+using OglPlayground::AttributeMode;
+using OglPlayground::AttributeType;
+using OglPlayground::AttributeUsage;
+using OglPlayground::SimdLevel;
+using OglPlayground::floatToHalf;
+using OglPlayground::halfToFloat;
+
+namespace
+{
+
+// Odd count so every level has a tail, with out of range values and
+// halfway cases
+std::vector<float> values_()
+{
+  srand(42);
+  std::vector<float> values = {
+      0.f, -0.f, 1.f, -1.f, 2.f, -2.f, 0.5f, 65504.f, 65520.f, 1e10f, -1e10f, 6e-8f, 1e-10f,
+      std::numeric_limits<float>::infinity(), 1.00048828125f, 1.00146484375f, 0.00390625f, 1.f/254.f};
+  for(int i = 0; i < 1000; ++i) {
+    values.push_back((float(rand()) / float(RAND_MAX) - 0.5f) * 3.f);
+  }
+  return values;
+}
+
+} // anonymous namespace
+
+TEST(VertexFormatTest, FloatToHalf) {
+  EXPECT_EQ(0x0000, floatToHalf(0.f));
+  EXPECT_EQ(0x8000, floatToHalf(-0.f));
+  EXPECT_EQ(0x3c00, floatToHalf(1.f));
+  EXPECT_EQ(0xc000, floatToHalf(-2.f));
+  EXPECT_EQ(0x7bff, floatToHalf(65504.f));
+  EXPECT_EQ(0x7c00, floatToHalf(65520.f));
+  EXPECT_EQ(0x7c00, floatToHalf(std::numeric_limits<float>::infinity()));
+  EXPECT_EQ(0xfc00, floatToHalf(-std::numeric_limits<float>::infinity()));
+  EXPECT_EQ(0x7e00, floatToHalf(std::numeric_limits<float>::quiet_NaN()) & 0x7e00);
+  // Smallest denormal, and half of it rounds to even zero
+  EXPECT_EQ(0x0001, floatToHalf(std::ldexp(1.f, -24)));
+  EXPECT_EQ(0x0000, floatToHalf(std::ldexp(1.f, -25)));
+  // Halfway between 1 and the next half rounds to even, then up from odd
+  EXPECT_EQ(0x3c00, floatToHalf(1.00048828125f));
+  EXPECT_EQ(0x3c02, floatToHalf(1.00146484375f));
+}
+
+TEST(VertexFormatTest, HalfRoundTrip) {
+  for(uint32_t h = 0; h < 0x10000; ++h) {
+    const uint16_t half = (uint16_t)h;
+    if((half & 0x7c00) == 0x7c00 && (half & 0x3ff)) continue; // NaN
+    EXPECT_EQ(half, floatToHalf(halfToFloat(half)));
+  }
+}
+
+TEST(VertexFormatTest, PackHalf) {
+  const std::vector<float> values = values_();
+  for(SimdLevel level : {SimdLevel::Scalar, SimdLevel::SSE2, SimdLevel::AVX2}) {
+    std::vector<uint16_t> packed(values.size());
+    OglPlayground::packHalf(values.data(), packed.data(), values.size(), level);
+    for(size_t i = 0; i < values.size(); ++i) {
+      EXPECT_EQ(floatToHalf(values[i]), packed[i]);
+    }
+  }
+}
+
+TEST(VertexFormatTest, PackNorm) {
+  const std::vector<float> values = values_();
+  const size_t n = values.size();
+  std::vector<int8_t> snorm8(n), expectedSnorm8(n);
+  std::vector<uint8_t> unorm8(n), expectedUnorm8(n);
+  std::vector<int16_t> snorm16(n), expectedSnorm16(n);
+  std::vector<uint16_t> unorm16(n), expectedUnorm16(n);
+  OglPlayground::packSnorm8(values.data(), expectedSnorm8.data(), n, SimdLevel::Scalar);
+  OglPlayground::packUnorm8(values.data(), expectedUnorm8.data(), n, SimdLevel::Scalar);
+  OglPlayground::packSnorm16(values.data(), expectedSnorm16.data(), n, SimdLevel::Scalar);
+  OglPlayground::packUnorm16(values.data(), expectedUnorm16.data(), n, SimdLevel::Scalar);
+
+  EXPECT_EQ(0, expectedSnorm8[0]);
+  EXPECT_EQ(127, expectedSnorm8[2]);
+  EXPECT_EQ(-127, expectedSnorm8[3]);
+  EXPECT_EQ(127, expectedSnorm8[4]);
+  EXPECT_EQ(-127, expectedSnorm8[5]);
+  EXPECT_EQ(255, expectedUnorm8[2]);
+  EXPECT_EQ(0, expectedUnorm8[3]);
+  EXPECT_EQ(128, expectedUnorm8[6]);
+  EXPECT_EQ(1, expectedUnorm8[17]);
+  EXPECT_EQ(32767, expectedSnorm16[9]);
+  EXPECT_EQ(-32767, expectedSnorm16[10]);
+  EXPECT_EQ(65535, expectedUnorm16[2]);
+  EXPECT_EQ(0, expectedUnorm16[3]);
+
+  for(SimdLevel level : {SimdLevel::SSE2, SimdLevel::AVX2}) {
+    OglPlayground::packSnorm8(values.data(), snorm8.data(), n, level);
+    OglPlayground::packUnorm8(values.data(), unorm8.data(), n, level);
+    OglPlayground::packSnorm16(values.data(), snorm16.data(), n, level);
+    OglPlayground::packUnorm16(values.data(), unorm16.data(), n, level);
+    EXPECT_EQ(expectedSnorm8, snorm8);
+    EXPECT_EQ(expectedUnorm8, unorm8);
+    EXPECT_EQ(expectedSnorm16, snorm16);
+    EXPECT_EQ(expectedUnorm16, unorm16);
+  }
+}
+
+TEST(VertexFormatTest, PackSnorm2101010) {
+  EXPECT_EQ(0x1ffu | (0x201u << 10) | (0u << 20) | (1u << 30),
+            OglPlayground::packSnorm2101010(glm::vec4(1.f, -1.f, 0.f, 1.f)));
+  EXPECT_EQ(0x3u << 30, OglPlayground::packSnorm2101010(glm::vec4(0.f, 0.f, 0.f, -1.f)));
+  // Clamped
+  EXPECT_EQ(0x1ffu << 20, OglPlayground::packSnorm2101010(glm::vec4(0.f, 0.f, 3.f, 0.f)));
+
+  const std::vector<glm::vec4> normals = {{0.f, 1.f, 0.f, 1.f}, {0.5f, -0.5f, 0.25f, -1.f}};
+  std::vector<uint32_t> packed(normals.size());
+  OglPlayground::packSnorm2101010(normals.data(), packed.data(), normals.size());
+  for(size_t i = 0; i < normals.size(); ++i) {
+    EXPECT_EQ(OglPlayground::packSnorm2101010(normals[i]), packed[i]);
+  }
+}
+
+TEST(VertexFormatTest, PackedVertexDesc) {
+  // 12 + 4 + 4 + 4 + 8 + 4 bytes instead of 3+2+3+4+4+4 floats
+  const OglPlayground::VertexDesc desc = {
+      {AttributeUsage::Position, 3},
+      {AttributeUsage::UV0, 2, AttributeType::Half},
+      {AttributeUsage::Normal, 4, AttributeType::Int2101010, AttributeMode::Normalized},
+      {AttributeUsage::Color, 3, AttributeType::UInt8, AttributeMode::Normalized},
+      {AttributeUsage::Joints, 4, AttributeType::UInt16, AttributeMode::Integer},
+      {AttributeUsage::Weights, 4, AttributeType::UInt8, AttributeMode::Normalized}};
+  EXPECT_EQ(36u, OglPlayground::strideFromVertexDesc(desc));
+  EXPECT_EQ(0u, OglPlayground::offsetFromVertexDesc(desc, AttributeUsage::Position));
+  EXPECT_EQ(12u, OglPlayground::offsetFromVertexDesc(desc, AttributeUsage::UV0));
+  EXPECT_EQ(16u, OglPlayground::offsetFromVertexDesc(desc, AttributeUsage::Normal));
+  EXPECT_EQ(20u, OglPlayground::offsetFromVertexDesc(desc, AttributeUsage::Color));
+  EXPECT_EQ(24u, OglPlayground::offsetFromVertexDesc(desc, AttributeUsage::Joints));
+  EXPECT_EQ(32u, OglPlayground::offsetFromVertexDesc(desc, AttributeUsage::Weights));
+  EXPECT_EQ(36u, OglPlayground::offsetFromVertexDesc(desc, AttributeUsage::Tangent));
+  EXPECT_EQ(nullptr, OglPlayground::findAttribute(desc, AttributeUsage::Tangent));
+  EXPECT_EQ(AttributeType::Int2101010, OglPlayground::findAttribute(desc, AttributeUsage::Normal)->type);
+  EXPECT_EQ(GLenum(GL_INT_2_10_10_10_REV), OglPlayground::attributeGLType(AttributeType::Int2101010));
+  EXPECT_EQ(GLenum(GL_HALF_FLOAT), OglPlayground::attributeGLType(AttributeType::Half));
+}
@@ -6,6 +6,9 @@
 
 #include <glad/glad.h>
 #include <GLFW/glfw3.h>
+#include <oglplayground/directstateaccess.h>
+#include <oglplayground/gpumemory.h>
+#include <oglplayground/resourceloader.h>
 
 namespace TestApp
 {
@@ -67,6 +70,8 @@ public:
   ~Impl_() {currentInst_ = nullptr;}
   
   GLFWwindow* window_;
+  GLFWwindow* loaderWindow_ = nullptr; // Hidden, shares objects with window_
+  std::unique_ptr<OglPlayground::ResourceLoader> loader_;
   std::set<InputListener*> listeners_;
 
   // Input management
@@ -138,6 +143,7 @@ Application::Application() : impl_(new Impl_)
     std::cout << "Failed to initialize OpenGL context" << std::endl;
     return;
   }
+  OglPlayground::loadDirectStateAccess((GLADloadproc) glfwGetProcAddress);
 
   GLint flags; glGetIntegerv(GL_CONTEXT_FLAGS, &flags);
   if (flags & GL_CONTEXT_FLAG_DEBUG_BIT)
@@ -148,6 +154,22 @@ Application::Application() : impl_(new Impl_)
      glDebugMessageControl(GL_DONT_CARE, GL_DONT_CARE, GL_DONT_CARE, 0, nullptr, GL_TRUE);
   }
 
+  // Loader thread context, windows can only be created here on the main thread
+  glfwWindowHint(GLFW_VISIBLE, GL_FALSE);
+  impl_->loaderWindow_ = glfwCreateWindow(1, 1, "OglPlayground loader", NULL, impl_->window_);
+  if (impl_->loaderWindow_ == NULL)
+  {
+    std::cout << "Failed to create the loader context, loads will be dropped" << std::endl;
+  }
+  GLFWwindow* loaderWindow = impl_->loaderWindow_;
+  impl_->loader_.reset(new OglPlayground::ResourceLoader(
+      [loaderWindow] {
+        if (loaderWindow == NULL) return false;
+        glfwMakeContextCurrent(loaderWindow);
+        return true;
+      },
+      [] { glfwMakeContextCurrent(NULL); }));
+
   // Input callbacks setup
   glfwSetKeyCallback(impl_->window_, &Impl_::key_callback);
   glfwSetMouseButtonCallback(impl_->window_, &Impl_::mouse_button_callback);
@@ -157,9 +179,16 @@ Application::Application() : impl_(new Impl_)
 
 Application::~Application()
 {
+  // Stop the loader thread while its context exists
+  impl_->loader_.reset();
   glfwTerminate();
 }
 
+OglPlayground::ResourceLoader& Application::loader()
+{
+  return *impl_->loader_;
+}
+
 void Application::run(Behavior* behavior)
 {
   assert(behavior);
@@ -168,12 +197,24 @@ void Application::run(Behavior* behavior)
   {
     // Check if any events have been activated (key pressed, mouse moved etc.) and call corresponding response functions
     glfwPollEvents();
+    impl_->loader_->poll();
     int width, height;
     glfwGetWindowSize(impl_->window_, &width, &height);
     behavior->update(width, height);
     glfwSwapBuffers(impl_->window_);
+    OglPlayground::endGpuMemoryFrame();
   }
   behavior->teardown(this);
+
+  // Live after teardown are leaks, unless the behavior frees on destruction
+  const OglPlayground::GpuMemorySnapshot memory = OglPlayground::gpuMemorySnapshot();
+  for(size_t i = 0; i < size_t(OglPlayground::GpuResource::Count); ++i) {
+    const auto& stats = memory.resources[i];
+    if(stats.peakBytes == 0 && stats.objects == 0) continue;
+    std::cout << "GPU " << OglPlayground::gpuResourceName(OglPlayground::GpuResource(i))
+              << ": " << stats.objects << " live, " << stats.bytes << " bytes, peak "
+              << stats.peakBytes << " bytes" << std::endl;
+  }
 }
 
 void Application::registerListener(InputListener* listener)
@@ -4,6 +4,11 @@
 
 struct GLFWwindow;
 
+namespace OglPlayground
+{
+class ResourceLoader;
+}
+
 namespace TestApp
 {
 
@@ -40,6 +45,10 @@ public:
 
   void run(Behavior* behavior);
 
+  // Loads on a thread with a context shared with the window's. Publish
+  // callbacks run on the render thread at the start of each frame.
+  OglPlayground::ResourceLoader& loader();
+
   void registerListener(InputListener* listener);
   void unregisterListener(InputListener* listener);
 
@@ -7,6 +7,8 @@
 #include <stb/stb_image.h>
 
 #include <oglplayground/geometry.h>
+#include <oglplayground/gpumemory.h>
+#include <oglplayground/ringbuffer.h>
 
 #include "resources_path.h"
 
@@ -35,45 +37,47 @@ std::unique_ptr<OglPlayground::Program> loadShader_(const std::string& filename)
       new OglPlayground::Program(vertSrc.c_str(), fragSrc.c_str(), [](const char* msg) { std::cerr << msg; }));
 }
 
+OglPlayground::Geometry makeFullscreenTriangle_()
+{
+  const GLfloat vertices[] = {
+    -1.f, 3.f, 0.f, 2.0f,
+    -1.f, -1.f, 0.f, 0.0f,
+    3.f, -1.f, 2.f, 0.0f,
+  };
+  const uint32_t indices[] = { 0, 1, 2 };
+
+  const OglPlayground::VertexDesc vertDesc = {
+    {OglPlayground::AttributeUsage::Position, 2},
+    {OglPlayground::AttributeUsage::UV0, 2}
+  };
+  const size_t stride = strideFromVertexDesc(vertDesc);
+  return OglPlayground::Geometry(
+      vertices,
+      sizeof(vertices)/stride,
+      indices,
+      sizeof(indices)/sizeof(uint32_t),
+      vertDesc);
+}
+
 class FullscreenQuad
 {
 public:
-  FullscreenQuad() {
-    const GLfloat vertices[] = {
-      -1.f, 3.f, 0.f, 2.0f,
-      -1.f, -1.f, 0.f, 0.0f,
-      3.f, -1.f, 2.f, 0.0f,
-    };
-    const uint32_t indices[] = { 0, 1, 2 };
-
-    const OglPlayground::VertexDesc vertDesc = {
-      {OglPlayground::AttributeUsage::Position, 2},
-      {OglPlayground::AttributeUsage::UV0, 2}
-    };
-    const size_t stride = strideFromVertexDesc(vertDesc);
-    geom_.reset(
-        new OglPlayground::Geometry(
-            vertices,
-            sizeof(vertices)/stride,
-            indices,
-            sizeof(indices)/sizeof(uint32_t),
-            vertDesc));
-
-    const OglPlayground::AttributeBindDesc attribDesc = {
-      {OglPlayground::AttributeUsage::Position, 0},
-      {OglPlayground::AttributeUsage::UV0, 1}
-    };
-    geomBinder_.reset(new OglPlayground::GeometryBinder(geom_.get(), attribDesc));
+  FullscreenQuad()
+      : geom_(makeFullscreenTriangle_())
+      , geomBinder_(geom_, {
+          {OglPlayground::AttributeUsage::Position, 0},
+          {OglPlayground::AttributeUsage::UV0, 1}})
+  {
   }
 
   void draw() {
-    geomBinder_->bind();
-    geomBinder_->draw();
-    geomBinder_->unbind();
+    geomBinder_.bind();
+    geomBinder_.draw(geom_);
+    geomBinder_.unbind();
   }
 private:
-  std::unique_ptr<OglPlayground::Geometry> geom_;
-  std::unique_ptr<OglPlayground::GeometryBinder> geomBinder_;
+  OglPlayground::Geometry geom_;
+  OglPlayground::GeometryBinder geomBinder_;
 };
 
 }
@@ -85,7 +89,7 @@ public:
   std::unique_ptr<OglPlayground::Program> program;
   std::unique_ptr<FullscreenQuad> fullscreenQuad;
   GLuint texture = 0;
-  std::unique_ptr<OglPlayground::BufferObject> pbo;
+  std::unique_ptr<OglPlayground::RingBuffer> pbo; // One region per frame in flight
 
   // Game of life data
   size_t width = 1024;
@@ -113,7 +117,9 @@ void GameOfLifeBehavior::setup(TestApp::Application* app)
   float color[] = { 1.0f, 0.0f, 0.0f, 1.0f };
   glTexParameterfv(GL_TEXTURE_2D, GL_TEXTURE_BORDER_COLOR, color);
   glTexStorage2D(GL_TEXTURE_2D, 1, GL_RGBA8, (GLsizei)impl_->width, (GLsizei)impl_->height);
-  impl_->pbo.reset(new OglPlayground::BufferObject(GL_PIXEL_UNPACK_BUFFER, impl_->width*impl_->height*4, nullptr, GL_STREAM_DRAW));
+  OglPlayground::trackGpuAllocation(
+      OglPlayground::GpuResource::Texture, OglPlayground::texture2DBytes(impl_->width, impl_->height, 4, false));
+  impl_->pbo.reset(new OglPlayground::RingBuffer(GL_PIXEL_UNPACK_BUFFER, impl_->width*impl_->height*4));
   glBindTexture(GL_TEXTURE_2D, 0);
 }
 
@@ -126,8 +132,9 @@ void GameOfLifeBehavior::update(int width, int height)
 
   impl_->program->use();
   glBindTexture(GL_TEXTURE_2D, impl_->texture);
-  impl_->pbo->bind();
-  uint8_t* ptr = static_cast<uint8_t*>(impl_->pbo->map(GL_WRITE_ONLY));
+  impl_->pbo->beginFrame();
+  size_t offset = 0;
+  uint8_t* ptr = static_cast<uint8_t*>(impl_->pbo->allocate(impl_->width*impl_->height*4, 4, offset));
   for(size_t i = 0; i < impl_->width; ++i) {
     for(size_t j = 0; j < impl_->width; ++j) {
       *ptr++ = rand() % 255;
@@ -136,9 +143,12 @@ void GameOfLifeBehavior::update(int width, int height)
       *ptr++ = 255;
     }
   }
-  impl_->pbo->unmap();
-  glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, (GLsizei)impl_->width, (GLsizei)impl_->height, GL_RGBA, GL_UNSIGNED_BYTE, 0);
+  impl_->pbo->bind();
+  glTexSubImage2D(
+      GL_TEXTURE_2D, 0, 0, 0, (GLsizei)impl_->width, (GLsizei)impl_->height, GL_RGBA, GL_UNSIGNED_BYTE,
+      reinterpret_cast<const void*>(offset));
   impl_->pbo->unbind();
+  impl_->pbo->endFrame();
 
   impl_->fullscreenQuad->draw();
 }
@@ -146,4 +156,10 @@ void GameOfLifeBehavior::update(int width, int height)
 void GameOfLifeBehavior::teardown(TestApp::Application* app)
 {
   impl_->program.reset(nullptr);
+  if(impl_->texture) {
+    OglPlayground::trackGpuFree(
+        OglPlayground::GpuResource::Texture, OglPlayground::texture2DBytes(impl_->width, impl_->height, 4, false));
+    glDeleteTextures(1, &impl_->texture);
+    impl_->texture = 0;
+  }
 }
@@ -6,6 +6,9 @@
 
 #include <stb/stb_image.h>
 
+#include <oglplayground/gpumemory.h>
+#include <oglplayground/resourceloader.h>
+
 #include "resources_path.h"
 
 namespace
@@ -111,7 +114,7 @@ void TestBehavior::setup(TestApp::Application* app)
     {OglPlayground::AttributeUsage::Position, 0},
     {OglPlayground::AttributeUsage::UV0, 1}
   };
-  geomBinder_.reset(new OglPlayground::GeometryBinder(geom_.get(), attribDesc));
+  geomBinder_.reset(new OglPlayground::GeometryBinder(*geom_, attribDesc));
 
   // Shader
   program_ = loadShader_("simple");
@@ -121,18 +124,34 @@ void TestBehavior::setup(TestApp::Application* app)
     std::cout << "Uniform " << desc.name << " located at " << desc.location << std::endl;
   }
 
-  // Load texture (TODO CLEANUP)
-  int width, height, nbChannel;
-  stbi_set_flip_vertically_on_load(1);
-  stbi_uc* image = stbi_load(OglPlayground::resource_path("container.jpg"), &width, &height, &nbChannel, STBI_rgb);
-  assert(nbChannel == 3);
-  
-  glGenTextures(1, &texture_);
-  glBindTexture(GL_TEXTURE_2D, texture_);
-  glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, width, height, 0, GL_RGB, GL_UNSIGNED_BYTE, image);
-  glGenerateMipmap(GL_TEXTURE_2D);
-  glBindTexture(GL_TEXTURE_2D, 0);
-  stbi_image_free(image);
+  // Decode and upload the texture on the loader thread, the cube draws
+  // untextured until it is published
+  struct LoadedTexture
+  {
+    GLuint name = 0;
+    size_t bytes = 0;
+  };
+  auto texture = std::make_shared<LoadedTexture>();
+  app->loader().enqueue(
+      [texture] {
+        int width, height, nbChannel;
+        stbi_set_flip_vertically_on_load(1);
+        stbi_uc* image = stbi_load(OglPlayground::resource_path("container.jpg"), &width, &height, &nbChannel, STBI_rgb);
+        assert(nbChannel == 3);
+
+        glGenTextures(1, &texture->name);
+        glBindTexture(GL_TEXTURE_2D, texture->name);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, width, height, 0, GL_RGB, GL_UNSIGNED_BYTE, image);
+        glGenerateMipmap(GL_TEXTURE_2D);
+        glBindTexture(GL_TEXTURE_2D, 0);
+        texture->bytes = OglPlayground::texture2DBytes(width, height, 3, true);
+        OglPlayground::trackGpuAllocation(OglPlayground::GpuResource::Texture, texture->bytes);
+        stbi_image_free(image);
+      },
+      [this, texture] {
+        texture_ = texture->name;
+        textureBytes_ = texture->bytes;
+      });
 
   // Camera setup
   camera_.setFov(45.f);
@@ -151,14 +170,13 @@ void TestBehavior::update(int width, int height)
 
   program_->use();
   
-  glm::mat4 view = camera_.transform().worldToLocalMatrix();
   glm::mat4 model(1.f);
-  glm::mat4 mvp = camera_.projection()*view*model;
+  glm::mat4 mvp = camera_.viewProjection()*model;
   program_->setUniform("transform", mvp);
   glBindTexture(GL_TEXTURE_2D, texture_);
   
   geomBinder_->bind();
-  geomBinder_->draw();
+  geomBinder_->draw(*geom_);
   geomBinder_->unbind();
 }
 
@@ -168,4 +186,9 @@ void TestBehavior::teardown(TestApp::Application* app)
   geomBinder_.reset(nullptr);
   geom_.reset(nullptr);
   program_.reset(nullptr);
+  if(texture_) {
+    OglPlayground::trackGpuFree(OglPlayground::GpuResource::Texture, textureBytes_);
+    glDeleteTextures(1, &texture_);
+    texture_ = 0;
+  }
 }
@@ -28,4 +28,5 @@ private:
   OglPlayground::Camera camera_;
   std::unique_ptr<TestApp::SphericalController> sphericalController_;
   GLuint texture_ = 0;
+  size_t textureBytes_ = 0;
 };